@@ -100,7 +100,6 @@ def simlib_sources():
             ],
             ['c', 'cc', 'h', 'hh'],
             [
-                'src/sim/default_checker_dump.c',
                 'test/conver_test_cases/.*',
                 'test/old_sandbox_test_cases/.*',
             ]
@@ -1,10 +1,26 @@
 #pragma once
 
+#include <optional>
+#include <sim/jobs/job.hh>
 #include <sim/mysql/mysql.hh>
 #include <simlib/string_view.hh>
+#include <string>
+#include <sys/types.h>
 
 namespace sim::jobs {
 
 void restart_job(mysql::Connection& mysql, StringView job_id, bool notify_job_server);
 
+// Logs of the jobs in progress are appended to files in this directory and moved to jobs.log once
+// the job is finished, so that updating a long log does not rewrite it as a whole
+constexpr CStringView in_progress_job_logs_dir = "job_logs/";
+
+std::string in_progress_job_log_path(decltype(Job::id) job_id);
+
+// Returns the part [@p beg, @p end) of the log of the job in progress or std::nullopt if the job
+// has no log in progress, e.g. it has already finished. Negative @p beg counts from the end of the
+// log (to tail it) and negative @p end means the end of the log.
+std::optional<std::string>
+read_in_progress_job_log(decltype(Job::id) job_id, off64_t beg = 0, off64_t end = -1);
+
 } // namespace sim::jobs
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <simlib/file_descriptor.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/string_view.hh>
+#include <stdexcept>
+#include <string>
+#include <variant>
+
+// Judge agents are processes (possibly on other machines) that judge submissions for the job
+// server. An agent connects to the job server, sends Hello and then handles judge tasks one by one:
+//   1. job server -> agent: JudgeTask
+//   2. agent -> job server: PackageRequest, if the agent does not have the package yet
+//   3. job server -> agent: Package, in response to the PackageRequest
+//   4. agent -> job server: CompilationResult
+//   5. agent -> job server: JudgeReport with every partial and complete report, the last one is the
+//      complete report of the final tests (none if compilation failed)
+// If the agent fails to do the task (e.g. the package is malformed), it sends TaskFailure instead
+// of the remaining messages. Only the job server accesses the database.
+namespace sim::judge_agents {
+
+// Path (relative to the Sim installation) of the Unix socket the job server listens on for judge
+// agents
+constexpr CStringView job_server_socket_path = ".judge-agents.sock";
+
+// Thrown if the connection breaks or the other side does not follow the protocol
+class ConnectionError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+struct JudgeTask {
+    // Package files are immutable, so the agent can cache them by the file id
+    uint64_t package_file_id;
+    SolutionLanguage language;
+    std::string solution_source;
+    std::chrono::nanoseconds solution_compilation_time_limit;
+    uint64_t solution_compilation_memory_limit;
+    std::chrono::nanoseconds checker_compilation_time_limit;
+    uint64_t checker_compilation_memory_limit;
+    uint64_t compilation_errors_max_length;
+};
+
+struct PackageRequest {};
+
+struct Package {
+    std::string contents; // of the zip file
+};
+
+struct CompilationResult {
+    enum class Status : uint8_t {
+        OK,
+        SOLUTION_COMPILATION_ERROR,
+        CHECKER_COMPILATION_ERROR,
+    };
+
+    Status status;
+    std::string compilation_errors;
+    std::string log; // of the task so far
+};
+
+struct JudgeReport {
+    bool final;
+    bool partial;
+    sim::JudgeReport report;
+    std::string log; // of the initial or final tests (depending on final) since the last report
+};
+
+struct TaskFailure {
+    std::string error;
+};
+
+// The job server accepts the agent only if the secret is job_server_judge_agents_secret from
+// sim.conf
+struct Hello {
+    std::string secret;
+};
+
+using Message = std::variant<
+    JudgeTask,
+    PackageRequest,
+    Package,
+    CompilationResult,
+    JudgeReport,
+    TaskFailure,
+    Hello>;
+
+// Takes the same time wherever the secrets differ, so that the secret cannot be guessed byte by
+// byte by timing the responses
+bool is_correct_secret(StringView secret, StringView expected_secret) noexcept;
+
+// Messages (e.g. the package zip) are limited in size, so that a malformed or malicious message
+// cannot make the receiver allocate arbitrary amounts of memory
+constexpr uint64_t max_message_payload_len = uint64_t{1} << 30; // 1 GiB
+
+void send_message(int sock_fd, const Message& msg);
+
+Message recv_message(int sock_fd);
+
+// Makes recv_message() on @p sock_fd throw ConnectionError if the other side sends nothing for
+// @p timeout, e.g. because it hung
+void set_recv_timeout(int sock_fd, std::chrono::nanoseconds timeout);
+
+// Addresses have one of the formats:
+//   unix:PATH -> Unix socket at PATH
+//   ADDR:PORT -> TCP on IPv4 address ADDR (* means all addresses, only for listening) and port PORT
+
+// Returns a socket listening on @p address for judge agents
+FileDescriptor listen_for_agents(StringView address);
+
+// Returns a socket connected to the job server listening on @p address
+FileDescriptor connect_to_job_server(StringView address);
+
+} // namespace sim::judge_agents
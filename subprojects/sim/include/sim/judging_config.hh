@@ -1,9 +1,11 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <simlib/concat.hh>
 #include <simlib/string_view.hh>
+#include <string_view>
 
 namespace sim {
 
@@ -20,5 +22,14 @@ constexpr double SOLUTION_RUNTIME_COEFFICIENT = 3;
 constexpr std::chrono::nanoseconds CHECKER_TIME_LIMIT = std::chrono::seconds(22);
 constexpr uint64_t CHECKER_MEMORY_LIMIT = 512 << 20; // 256 MiB
 constexpr double SCORE_CUT_LAMBDA = 2. / 3.; // See JudgeWorker::score_cut_lambda
+// Included by most of the C++ submissions, so they are compiled much faster when precompiled
+constexpr std::array<std::string_view, 1> CPP_PRECOMPILED_HEADERS = {"bits/stdc++.h"};
+// Job server
+constexpr uint64_t PACKAGE_FILES_CACHE_MAX_SIZE = uint64_t{8} << 30; // 8 GiB
+constexpr uint64_t COMPILATION_CACHE_MAX_SIZE = uint64_t{4} << 30; // 4 GiB
+constexpr uint64_t COMPILATION_CACHE_MAX_ENTRIES_NUM = 100'000;
+constexpr size_t SUPERVISOR_POOL_MAX_IDLE_SUPERVISORS = 32;
+// Recycling supervisors bounds the impact of e.g. memory leaks in a long-running supervisor
+constexpr uint64_t SUPERVISOR_POOL_MAX_REQUESTS_PER_SUPERVISOR = 1000;
 
 } // namespace sim
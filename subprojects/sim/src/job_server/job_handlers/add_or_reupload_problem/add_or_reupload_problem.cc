@@ -1,4 +1,7 @@
+#include "../compilation_cache.hh"
 #include "../judge_logger.hh"
+#include "../supervisor_pool.hh"
+#include "../tracee_cpus_pool.hh"
 #include "add_or_reupload_problem.hh"
 
 #include <chrono>
@@ -74,7 +77,12 @@ std::optional<sim::Simfile> construct_simfile(Logger& logger, ConstructSimfileOp
     case sim::Conver::Status::COMPLETE: break;
     case sim::Conver::Status::NEED_MODEL_SOLUTION_JUDGE_REPORT: {
         logger("Loading the problem package for judging the main solution...");
-        sim::JudgeWorker judge_worker;
+        auto tracee_cpus = tracee_cpus_pool().lease();
+        sim::JudgeWorker judge_worker{{
+            .supervisor_pool = &supervisor_pool(),
+            .tracee_cpus = tracee_cpus.cpus(),
+            .cpp_precompiled_headers = cpp_precompiled_headers(),
+        }};
         judge_worker.load_package(std::move(options).package_path, construction_res.simfile.dump());
         const auto& main_solution_path = construction_res.simfile.solutions[0];
         logger("Judging the model solution: ", main_solution_path);
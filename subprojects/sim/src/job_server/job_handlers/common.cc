@@ -1,8 +1,20 @@
 #include "common.hh"
+#include "judge_checkpoint.hh"
 
+#include <cerrno>
+#include <fcntl.h>
 #include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
 #include <sim/mysql/mysql.hh>
 #include <sim/sql/sql.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/file_perms.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/string_view.hh>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using sim::jobs::Job;
 using sim::mysql::Connection;
@@ -19,6 +31,10 @@ void set_job_status_and_log(
     mysql.execute(
         Update("jobs").set("status=?, log=?", status, logger.get_logs()).where("id=?", job_id)
     );
+    if (unlink(sim::jobs::in_progress_job_log_path(job_id).c_str()) && errno != ENOENT) {
+        THROW("unlink()", errmsg());
+    }
+    job_server::job_handlers::remove_judge_checkpoint(job_id);
 }
 
 } // namespace
@@ -37,8 +53,30 @@ void mark_job_as_failed(Connection& mysql, const Logger& logger, decltype(Job::i
     set_job_status_and_log(mysql, logger, job_id, Job::Status::FAILED);
 }
 
-void update_job_log(Connection& mysql, const Logger& logger, decltype(Job::id) job_id) {
-    mysql.execute(Update("jobs").set("log=?", logger.get_logs()).where("id=?", job_id));
+void update_job_log(const Logger& logger, decltype(Job::id) job_id) {
+    auto fd = FileDescriptor{
+        sim::jobs::in_progress_job_log_path(job_id),
+        O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC,
+        S_0600,
+    };
+    if (!fd.is_open()) {
+        THROW("open()", errmsg());
+    }
+    struct stat64 st = {};
+    if (fstat64(fd, &st)) {
+        THROW("fstat()", errmsg());
+    }
+    // Only the part of the logs that is not in the file yet is appended
+    auto logs = StringView{logger.get_logs()};
+    auto logged_len = static_cast<size_t>(st.st_size);
+    if (logged_len > logs.size()) {
+        // The file does not come from this logger
+        if (ftruncate(fd, 0)) {
+            THROW("ftruncate()", errmsg());
+        }
+        logged_len = 0;
+    }
+    write_all_throw(fd, logs.substr(logged_len));
 }
 
 } // namespace job_server::job_handlers
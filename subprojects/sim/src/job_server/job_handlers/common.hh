@@ -5,6 +5,7 @@
 #include <simlib/concat_common.hh>
 #include <simlib/concat_tostr.hh>
 #include <simlib/logger.hh>
+#include <simlib/string_view.hh>
 #include <simlib/syscalls.hh>
 #include <string>
 #include <type_traits>
@@ -30,6 +31,14 @@ public:
     }
 
     [[nodiscard]] const std::string& get_logs() const noexcept { return str; }
+
+    // Appends logs of @p other (they are not printed again)
+    void append(const Logger& other) { str += other.str; }
+
+    // Appends @p logs printed elsewhere, e.g. by a judge agent
+    void append(StringView logs) { str += logs; }
+
+    void clear() noexcept { str.clear(); }
 };
 
 void mark_job_as_done(
@@ -44,8 +53,7 @@ void mark_job_as_failed(
     sim::mysql::Connection& mysql, const Logger& logger, decltype(sim::jobs::Job::id) job_id
 );
 
-void update_job_log(
-    sim::mysql::Connection& mysql, const Logger& logger, decltype(sim::jobs::Job::id) job_id
-);
+// Appends the new logs to the log of the job in progress, see sim::jobs::in_progress_job_logs_dir
+void update_job_log(const Logger& logger, decltype(sim::jobs::Job::id) job_id);
 
 } // namespace job_server::job_handlers
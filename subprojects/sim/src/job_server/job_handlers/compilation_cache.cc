@@ -0,0 +1,41 @@
+#include "compilation_cache.hh"
+
+#include <chrono>
+#include <sim/judging_config.hh>
+#include <sim/problems/problem.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sim/judge/disk_compilation_cache.hh>
+#include <simlib/sim/judge/language_suite/cpp_gcc.hh>
+#include <simlib/sim/simfile.hh>
+
+using sim::problems::Problem;
+
+namespace job_server::job_handlers {
+
+sim::judge::DiskCompilationCache& compilation_cache() {
+    static sim::judge::DiskCompilationCache cache{
+        "compilation_cache/",
+        std::chrono::hours{30 * 24},
+        sim::COMPILATION_CACHE_MAX_SIZE,
+        sim::COMPILATION_CACHE_MAX_ENTRIES_NUM,
+    };
+    return cache;
+}
+
+sim::judge::language_suite::Cpp_GCC::PrecompiledHeaders cpp_precompiled_headers() {
+    return {
+        .dir = "cpp_precompiled_headers/",
+        .headers = {sim::CPP_PRECOMPILED_HEADERS.begin(), sim::CPP_PRECOMPILED_HEADERS.end()},
+    };
+}
+
+std::string
+checker_cached_name(decltype(Problem::file_id) problem_file_id, const sim::Simfile& simfile) {
+    if (!simfile.checker) {
+        THROW("the default checker is run in-process, it is not compiled");
+    }
+    return concat_tostr("checker:", problem_file_id, ':', *simfile.checker);
+}
+
+} // namespace job_server::job_handlers
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <sim/problems/problem.hh>
+#include <simlib/sim/judge/disk_compilation_cache.hh>
+#include <simlib/sim/judge/language_suite/cpp_gcc.hh>
+#include <simlib/sim/simfile.hh>
+#include <string>
+#include <string_view>
+
+namespace job_server::job_handlers {
+
+// Compilation cache shared by all the workers (and the other processes using the same directory)
+sim::judge::DiskCompilationCache& compilation_cache();
+
+// Precompiled headers shared by all the workers, see sim::CPP_PRECOMPILED_HEADERS
+sim::judge::language_suite::Cpp_GCC::PrecompiledHeaders cpp_precompiled_headers();
+
+// Package files are immutable (reuploading a problem creates a new one), so the checker is
+// identified by the package file and its path in the package. The default checker is not compiled,
+// so @p simfile has to specify a checker.
+std::string checker_cached_name(
+    decltype(sim::problems::Problem::file_id) problem_file_id, const sim::Simfile& simfile
+);
+
+// Solutions are cached under this prefix followed by the hash of their contents and the compiler,
+// so identical resubmissions and rejudged submissions are not compiled again
+constexpr std::string_view solution_cached_name_prefix = "solution:";
+
+} // namespace job_server::job_handlers
@@ -0,0 +1,63 @@
+#include "judge_agent_pool.hh"
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <poll.h>
+#include <simlib/file_descriptor.hh>
+#include <utility>
+
+namespace {
+
+// Idle agents do not send anything, so readability means that the agent has disconnected
+bool is_idle_agent_connected(int agent_fd) noexcept {
+    pollfd pfd = {
+        .fd = agent_fd,
+        .events = POLLIN,
+        .revents = 0,
+    };
+    return poll(&pfd, 1, 0) == 0;
+}
+
+} // namespace
+
+namespace job_server::job_handlers {
+
+JudgeAgentPool::Lease::~Lease() {
+    if (!pool || !agent_fd.is_open() ||
+        uncaught_exceptions_in_constructor != std::uncaught_exceptions())
+    {
+        return; // the agent is disconnected by the destructor of agent_fd
+    }
+    pool->add_idle_agent(std::move(agent_fd));
+}
+
+void JudgeAgentPool::add_idle_agent(FileDescriptor&& agent_fd) {
+    std::lock_guard lock{mutex};
+    idle_agents.emplace_back(std::move(agent_fd));
+}
+
+std::optional<JudgeAgentPool::Lease> JudgeAgentPool::try_lease() {
+    std::lock_guard lock{mutex};
+    while (!idle_agents.empty()) {
+        auto agent_fd = std::move(idle_agents.back());
+        idle_agents.pop_back();
+        if (is_idle_agent_connected(agent_fd)) {
+            return Lease{*this, std::move(agent_fd)};
+        }
+    }
+    return std::nullopt;
+}
+
+size_t JudgeAgentPool::idle_agents_num() {
+    std::lock_guard lock{mutex};
+    return idle_agents.size();
+}
+
+JudgeAgentPool& judge_agent_pool() {
+    static JudgeAgentPool pool;
+    return pool;
+}
+
+} // namespace job_server::job_handlers
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <simlib/file_descriptor.hh>
+#include <utility>
+#include <vector>
+
+namespace job_server::job_handlers {
+
+// Judge agents connected to the job server that are not judging anything at the moment, see
+// sim/judge_agents/protocol.hh. Safe to use from multiple threads.
+class JudgeAgentPool {
+    std::mutex mutex;
+    std::vector<FileDescriptor> idle_agents;
+
+public:
+    JudgeAgentPool() = default;
+
+    JudgeAgentPool(const JudgeAgentPool&) = delete;
+    JudgeAgentPool(JudgeAgentPool&&) = delete;
+    JudgeAgentPool& operator=(const JudgeAgentPool&) = delete;
+    JudgeAgentPool& operator=(JudgeAgentPool&&) = delete;
+    ~JudgeAgentPool() = default;
+
+    // Returns the agent to the pool upon destruction (unless it was disconnected or the lease is
+    // destroyed during stack unwinding, as the agent may be in the middle of a task then)
+    class [[nodiscard]] Lease {
+        JudgeAgentPool* pool;
+        FileDescriptor agent_fd;
+        int uncaught_exceptions_in_constructor = std::uncaught_exceptions();
+
+        Lease(JudgeAgentPool& pool, FileDescriptor&& agent_fd) noexcept
+        : pool{&pool}
+        , agent_fd{std::move(agent_fd)} {}
+
+        friend class JudgeAgentPool;
+
+    public:
+        Lease(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept
+        : pool{std::exchange(other.pool, nullptr)}
+        , agent_fd{std::move(other.agent_fd)}
+        , uncaught_exceptions_in_constructor{other.uncaught_exceptions_in_constructor} {}
+
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease();
+
+        [[nodiscard]] int fd() const noexcept { return agent_fd; }
+
+        void disconnect() noexcept { (void)agent_fd.close(); }
+    };
+
+    void add_idle_agent(FileDescriptor&& agent_fd);
+
+    // Returns std::nullopt if there is no idle agent
+    std::optional<Lease> try_lease();
+
+    // Includes the agents that have disconnected while idle
+    [[nodiscard]] size_t idle_agents_num();
+};
+
+JudgeAgentPool& judge_agent_pool();
+
+} // namespace job_server::job_handlers
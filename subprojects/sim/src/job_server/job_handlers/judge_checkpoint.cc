@@ -0,0 +1,245 @@
+#include "judge_checkpoint.hh"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <optional>
+#include <sim/jobs/job.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/file_perms.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sim/judge/test_report.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/string_traits.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+using sim::JudgeReport;
+using sim::JudgeWorker;
+using sim::judge::TestReport;
+using sim::jobs::Job;
+
+namespace {
+
+// Bumped on every change of the format, so that the checkpoints in the old format are discarded
+constexpr uint8_t checkpoint_format_version = 2;
+
+struct MalformedCheckpoint {};
+
+class Encoder {
+    std::string buff;
+
+public:
+    template <class T, std::enable_if_t<std::is_trivial_v<T>, int> = 0>
+    void write(const T& val) {
+        buff.append(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+
+    template <class Rep, class Period>
+    void write(std::chrono::duration<Rep, Period> val) {
+        write(int64_t{val.count()});
+    }
+
+    void write(StringView str) {
+        write(uint64_t{str.size()});
+        buff.append(str.data(), str.size());
+    }
+
+    void write(const JudgeWorker::TestResult& res) {
+        write(StringView{res.report.name});
+        write(res.report.status);
+        write(res.report.runtime);
+        write(res.report.time_limit);
+        write(res.report.memory_consumed);
+        write(res.report.memory_limit);
+        write(StringView{res.report.comment});
+
+        const auto& tr = res.judge_report;
+        write(tr.status);
+        write(StringView{tr.comment});
+        write(tr.score);
+        write(tr.program.runtime);
+        write(tr.program.cpu_time);
+        write(tr.program.peak_memory_in_bytes);
+        write(uint8_t{tr.checker.has_value()});
+        if (tr.checker) {
+            write(tr.checker->runtime);
+            write(tr.checker->cpu_time);
+            write(tr.checker->peak_memory_in_bytes);
+        }
+    }
+
+    [[nodiscard]] const std::string& encoded() const noexcept { return buff; }
+};
+
+class Decoder {
+    StringView data;
+
+public:
+    explicit Decoder(StringView data_) noexcept : data{data_} {}
+
+    template <class T, std::enable_if_t<std::is_trivial_v<T>, int> = 0>
+    T read() {
+        if (data.size() < sizeof(T)) {
+            throw MalformedCheckpoint{};
+        }
+        T val;
+        std::memcpy(&val, data.data(), sizeof(val));
+        data.remove_prefix(sizeof(val));
+        return val;
+    }
+
+    template <class Duration>
+    Duration read_duration() {
+        return Duration{read<int64_t>()};
+    }
+
+    std::string read_string() {
+        auto len = read<uint64_t>();
+        if (data.size() < len) {
+            throw MalformedCheckpoint{};
+        }
+        return data.extract_prefix(len).to_string();
+    }
+
+    JudgeWorker::TestResult read_test_result() {
+        auto name = read_string();
+        auto status = read<JudgeReport::Test::Status>();
+        if (status > JudgeReport::Test::SKIPPED) {
+            throw MalformedCheckpoint{};
+        }
+        auto runtime = read_duration<std::chrono::nanoseconds>();
+        auto time_limit = read_duration<std::chrono::nanoseconds>();
+        auto memory_consumed = read<uint64_t>();
+        auto memory_limit = read<uint64_t>();
+        auto comment = read_string();
+
+        TestReport tr;
+        tr.status = read<TestReport::Status>();
+        if (tr.status > TestReport::Status::OK) {
+            throw MalformedCheckpoint{};
+        }
+        tr.comment = read_string();
+        tr.score = read<double>();
+        tr.program.runtime = read_duration<std::chrono::nanoseconds>();
+        tr.program.cpu_time = read_duration<std::chrono::microseconds>();
+        tr.program.peak_memory_in_bytes = read<uint64_t>();
+        if (read<uint8_t>()) {
+            tr.checker = TestReport::Checker{
+                .runtime = read_duration<std::chrono::nanoseconds>(),
+                .cpu_time = read_duration<std::chrono::microseconds>(),
+                .peak_memory_in_bytes = read<uint64_t>(),
+            };
+        }
+        if (!data.empty()) {
+            throw MalformedCheckpoint{};
+        }
+        return {
+            .report =
+                {
+                    std::move(name),
+                    status,
+                    runtime,
+                    time_limit,
+                    memory_consumed,
+                    memory_limit,
+                    std::move(comment),
+                },
+            .judge_report = std::move(tr),
+        };
+    }
+};
+
+} // namespace
+
+namespace job_server::job_handlers {
+
+std::string judge_checkpoint_path(decltype(Job::id) job_id) {
+    return concat_tostr(judge_checkpoints_dir, job_id);
+}
+
+void remove_judge_checkpoint(decltype(Job::id) job_id) {
+    if (unlink(judge_checkpoint_path(job_id).c_str()) && errno != ENOENT) {
+        THROW("unlink()", errmsg());
+    }
+}
+
+// The checkpoint file consists of the header followed by the records of the judged tests, each
+// preceded by its length. A record torn by a crash in the middle of appending it is dropped.
+JudgeCheckpoint::JudgeCheckpoint(
+    decltype(Job::id) job_id, const JudgeCheckpointIdentity& identity
+) {
+    fd = FileDescriptor{
+        judge_checkpoint_path(job_id),
+        O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC,
+        S_0600,
+    };
+    if (!fd.is_open()) {
+        THROW("open()", errmsg());
+    }
+
+    Encoder header;
+    header.write(checkpoint_format_version);
+    header.write(identity.problem_file_id);
+    header.write(identity.solution_file_id);
+    header.write(identity.language);
+    header.write(StringView{identity.solution_compiler_identity});
+
+    auto contents = get_file_contents(fd);
+    auto valid_len = [&]() -> size_t {
+        if (!has_prefix(contents, header.encoded())) {
+            return 0;
+        }
+        auto data = StringView{contents}.substr(header.encoded().size());
+        try {
+            for (;;) {
+                uint64_t len = 0;
+                if (data.size() < sizeof(len)) {
+                    break;
+                }
+                std::memcpy(&len, data.data(), sizeof(len));
+                if (data.size() - sizeof(len) < len) {
+                    break;
+                }
+                data.remove_prefix(sizeof(len));
+                auto res = Decoder{data.extract_prefix(len)}.read_test_result();
+                auto name = res.report.name;
+                loaded_tests.insert_or_assign(std::move(name), std::move(res));
+            }
+        } catch (const MalformedCheckpoint&) {
+            loaded_tests.clear();
+            return 0;
+        }
+        return contents.size() - data.size();
+    }();
+
+    if (valid_len < contents.size()) {
+        if (ftruncate(fd, static_cast<off_t>(valid_len))) {
+            THROW("ftruncate()", errmsg());
+        }
+    }
+    if (valid_len == 0) {
+        write_all_throw(fd, header.encoded());
+    }
+}
+
+void JudgeCheckpoint::append(const JudgeWorker::TestResult& res) {
+    Encoder payload;
+    payload.write(res);
+    Encoder record;
+    record.write(uint64_t{payload.encoded().size()});
+    auto data = concat_tostr(StringView{record.encoded()}, payload.encoded());
+    std::lock_guard lock{mutex};
+    write_all_throw(fd, data);
+}
+
+} // namespace job_server::job_handlers
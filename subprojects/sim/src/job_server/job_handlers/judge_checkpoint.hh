@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sim/internal_files/internal_file.hh>
+#include <sim/jobs/job.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <utility>
+
+namespace job_server::job_handlers {
+
+// Results of the tests judged so far by the jobs judging submissions locally are appended to files
+// in this directory, so that a job restarted e.g. by a restart of the job server does not judge
+// these tests again
+constexpr CStringView judge_checkpoints_dir = "judge_checkpoints/";
+
+std::string judge_checkpoint_path(decltype(sim::jobs::Job::id) job_id);
+
+// Removes the checkpoint of the job if there is one
+void remove_judge_checkpoint(decltype(sim::jobs::Job::id) job_id);
+
+// Results of the tests are reusable only if they come from judging the same solution on the same
+// package. The compiled solution is identified by its source file, language and compiler (see
+// sim::JudgeWorker::solution_compiler_identity()), as e.g. an upgrade of the compiler between the
+// restarts may change the executable.
+struct JudgeCheckpointIdentity {
+    decltype(sim::internal_files::InternalFile::id) problem_file_id;
+    decltype(sim::internal_files::InternalFile::id) solution_file_id;
+    sim::SolutionLanguage language;
+    std::string solution_compiler_identity;
+};
+
+// Safe to use from multiple threads
+class JudgeCheckpoint {
+    std::mutex mutex;
+    FileDescriptor fd;
+    std::map<std::string, sim::JudgeWorker::TestResult, std::less<>> loaded_tests;
+
+public:
+    // Loads the checkpoint of the job if it has the same @p identity, otherwise starts a new one
+    JudgeCheckpoint(decltype(sim::jobs::Job::id) job_id, const JudgeCheckpointIdentity& identity);
+
+    JudgeCheckpoint(const JudgeCheckpoint&) = delete;
+    JudgeCheckpoint(JudgeCheckpoint&&) = delete;
+    JudgeCheckpoint& operator=(const JudgeCheckpoint&) = delete;
+    JudgeCheckpoint& operator=(JudgeCheckpoint&&) = delete;
+    ~JudgeCheckpoint() = default;
+
+    // Returns the results of the tests loaded from the checkpoint (test name => result)
+    std::map<std::string, sim::JudgeWorker::TestResult, std::less<>> take_loaded_tests() noexcept {
+        return std::move(loaded_tests);
+    }
+
+    void append(const sim::JudgeWorker::TestResult& res);
+};
+
+} // namespace job_server::job_handlers
@@ -1,12 +1,17 @@
 #include "common.hh"
-#include "judge_logger.hh"
+#include "judge_agent_pool.hh"
+#include "judge_checkpoint.hh"
 #include "judge_or_rejudge_submission.hh"
+#include "judge_submission.hh"
+#include "tracee_cpus_pool.hh"
 
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <sim/contest_problems/contest_problem.hh>
 #include <sim/internal_files/internal_file.hh>
 #include <sim/jobs/job.hh>
+#include <sim/judge_agents/protocol.hh>
 #include <sim/judging_config.hh>
 #include <sim/mysql/mysql.hh>
 #include <sim/mysql/repeat_if_deadlocked.hh>
@@ -16,11 +21,16 @@
 #include <sim/submissions/update_final.hh>
 #include <simlib/concat_tostr.hh>
 #include <simlib/escape_bytes_to_utf8_str.hh>
+#include <simlib/file_contents.hh>
 #include <simlib/macros/stack_unwinding.hh>
 #include <simlib/sim/judge_worker.hh>
 #include <simlib/string_transform.hh>
+#include <simlib/string_view.hh>
 #include <simlib/time.hh>
 #include <simlib/time_format_conversions.hh>
+#include <string>
+#include <utility>
+#include <variant>
 
 using sim::contest_problems::ContestProblem;
 using sim::jobs::Job;
@@ -29,6 +39,20 @@ using sim::sql::Select;
 using sim::sql::Update;
 using sim::submissions::Submission;
 
+namespace judge_agents = sim::judge_agents;
+
+namespace {
+
+// A judge agent sends nothing between its reports for as long as judging of all the initial or all
+// the final tests takes, longer silence means that it hung (a crashed machine is detected sooner by
+// the TCP keepalive)
+constexpr auto judge_agent_silence_timeout = std::chrono::hours{1};
+
+// After losing that many judge agents, the submission is judged locally
+constexpr int max_judge_agent_attempts = 3;
+
+} // namespace
+
 namespace job_server::job_handlers {
 
 void judge_or_rejudge_submission(
@@ -84,12 +108,11 @@ void judge_or_rejudge_submission(
         return;
     }
 
+    // Loading the package and compiling take long, so the snapshot is not kept open meanwhile
+    transaction.commit();
+
     auto current_judgment_began_at = utc_mysql_datetime();
     logger("Judging submission ", submission_id, " (problem: ", submission_problem_id, ')');
-    sim::JudgeWorker judge_worker;
-    logger("Loading problem package...");
-    judge_worker.load_package(sim::internal_files::path_of(problem_file_id), std::nullopt);
-    logger("... done.");
 
     auto update_submission = [&, submission_id](
                                  decltype(Submission::initial_status) initial_status,
@@ -139,8 +162,6 @@ void judge_or_rejudge_submission(
         );
     };
 
-    logger("Compiling solution...");
-    std::string compilation_errors;
     auto language = [submission_language] {
         // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
         switch (submission_language) {
@@ -157,55 +178,38 @@ void judge_or_rejudge_submission(
         }
         THROW("unexpected language");
     }();
-    if (judge_worker.compile_solution(
-            sim::internal_files::path_of(submission_file_id),
-            language,
-            sim::SOLUTION_COMPILATION_TIME_LIMIT,
-            sim::SOLUTION_COMPILATION_MEMORY_LIMIT,
-            &compilation_errors,
-            sim::COMPILATION_ERRORS_MAX_LENGTH
-        ))
-    {
-        logger("... failed:\n", compilation_errors);
-        update_submission(
-            Submission::Status::COMPILATION_ERROR,
-            Submission::Status::COMPILATION_ERROR,
-            std::nullopt,
-            concat_tostr(
-                "<pre class=\"compilation-errors\">", html_escape(compilation_errors), "</pre>"
-            ),
-            ""
-        );
-        mark_job_as_done(mysql, logger, job_id);
-        transaction.commit();
-        return;
-    }
-    logger("... done.");
 
-    logger("Compiling checker...");
-    compilation_errors = {};
-    if (judge_worker.compile_checker(
-            sim::CHECKER_COMPILATION_TIME_LIMIT,
-            sim::CHECKER_COMPILATION_MEMORY_LIMIT,
-            &compilation_errors,
-            sim::COMPILATION_ERRORS_MAX_LENGTH
-        ))
-    {
-        logger("... failed:\n", compilation_errors);
-        update_submission(
-            Submission::Status::CHECKER_COMPILATION_ERROR,
-            Submission::Status::CHECKER_COMPILATION_ERROR,
-            std::nullopt,
-            "",
-            ""
-        );
-        mark_job_as_done(mysql, logger, job_id);
-        transaction.commit();
-        return;
-    }
-    logger("... done.");
-    update_job_log(mysql, logger, job_id);
-    transaction.commit();
+    auto finish_with_compilation_error = [&](StringView compilation_errors) {
+        sim::mysql::repeat_if_deadlocked(128, [&] {
+            auto transaction = mysql.start_repeatable_read_transaction();
+            update_submission(
+                Submission::Status::COMPILATION_ERROR,
+                Submission::Status::COMPILATION_ERROR,
+                std::nullopt,
+                concat_tostr(
+                    "<pre class=\"compilation-errors\">", html_escape(compilation_errors), "</pre>"
+                ),
+                ""
+            );
+            mark_job_as_done(mysql, logger, job_id);
+            transaction.commit();
+        });
+    };
+
+    auto finish_with_checker_compilation_error = [&] {
+        sim::mysql::repeat_if_deadlocked(128, [&] {
+            auto transaction = mysql.start_repeatable_read_transaction();
+            update_submission(
+                Submission::Status::CHECKER_COMPILATION_ERROR,
+                Submission::Status::CHECKER_COMPILATION_ERROR,
+                std::nullopt,
+                "",
+                ""
+            );
+            mark_job_as_done(mysql, logger, job_id);
+            transaction.commit();
+        });
+    };
 
     auto construct_submission_judge_report = [](const sim::JudgeReport& judge_report) {
         std::string report;
@@ -340,6 +344,9 @@ void judge_or_rejudge_submission(
         return Submission::Status::OK;
     };
 
+    // The final tests are judged at the same time as the initial ones, so their logs are kept apart
+    // and appended to the job log once the final judging is done
+    Logger final_logger;
     std::optional<std::string> initial_report;
     auto process_judge_report = [&,
                                  initial_report = std::optional<std::string>{},
@@ -355,6 +362,9 @@ void judge_or_rejudge_submission(
             score += group.score;
         }
 
+        if (final && !partial) {
+            logger.append(final_logger);
+        }
         sim::mysql::repeat_if_deadlocked(128, [&] {
             auto transaction = mysql.start_repeatable_read_transaction();
             if (!final) {
@@ -369,7 +379,7 @@ void judge_or_rejudge_submission(
                     std::move(report),
                     ""
                 );
-                update_job_log(mysql, logger, job_id);
+                update_job_log(logger, job_id);
                 transaction.commit();
                 return;
             }
@@ -384,7 +394,7 @@ void judge_or_rejudge_submission(
                 initial_status, status, score, initial_report.value_or(""), std::move(report)
             );
             if (partial) {
-                update_job_log(mysql, logger, job_id);
+                update_job_log(logger, job_id);
             } else {
                 mark_job_as_done(mysql, logger, job_id);
             }
@@ -392,17 +402,145 @@ void judge_or_rejudge_submission(
         });
     };
 
-    JudgeLogger judge_logger(logger);
-    auto initial_judge_report =
-        judge_worker.judge(false, judge_logger, [&](const sim::JudgeReport& partial_judge_report) {
-            process_judge_report(partial_judge_report, false, true);
-        });
-    process_judge_report(initial_judge_report, false, false);
+    // Judging is delegated to an idle judge agent if there is one. If the agent is lost midway, the
+    // submission is judged from scratch (as the progress of the agent is lost) by another one or,
+    // eventually, locally.
+    for (int attempt = 1; attempt <= max_judge_agent_attempts; ++attempt) {
+        auto agent = judge_agent_pool().try_lease();
+        if (!agent) {
+            break;
+        }
+        logger("Judging on a judge agent...");
+        bool compiled = false;
+        try {
+            judge_agents::set_recv_timeout(agent->fd(), judge_agent_silence_timeout);
+            judge_agents::send_message(
+                agent->fd(),
+                judge_agents::JudgeTask{
+                    .package_file_id = problem_file_id,
+                    .language = language,
+                    .solution_source =
+                        get_file_contents(sim::internal_files::path_of(submission_file_id)),
+                    .solution_compilation_time_limit = sim::SOLUTION_COMPILATION_TIME_LIMIT,
+                    .solution_compilation_memory_limit = sim::SOLUTION_COMPILATION_MEMORY_LIMIT,
+                    .checker_compilation_time_limit = sim::CHECKER_COMPILATION_TIME_LIMIT,
+                    .checker_compilation_memory_limit = sim::CHECKER_COMPILATION_MEMORY_LIMIT,
+                    .compilation_errors_max_length = sim::COMPILATION_ERRORS_MAX_LENGTH,
+                }
+            );
+            for (;;) {
+                auto msg = judge_agents::recv_message(agent->fd());
+                if (std::holds_alternative<judge_agents::PackageRequest>(msg) && !compiled) {
+                    judge_agents::send_message(
+                        agent->fd(),
+                        judge_agents::Package{
+                            .contents =
+                                get_file_contents(sim::internal_files::path_of(problem_file_id)),
+                        }
+                    );
+                    continue;
+                }
+                if (auto* res = std::get_if<judge_agents::CompilationResult>(&msg);
+                    res && !compiled)
+                {
+                    logger.append(res->log);
+                    // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
+                    switch (res->status) {
+                    case judge_agents::CompilationResult::Status::OK: break;
+                    case judge_agents::CompilationResult::Status::SOLUTION_COMPILATION_ERROR:
+                        finish_with_compilation_error(res->compilation_errors);
+                        return;
+                    case judge_agents::CompilationResult::Status::CHECKER_COMPILATION_ERROR:
+                        finish_with_checker_compilation_error();
+                        return;
+                    }
+                    compiled = true;
+                    update_job_log(logger, job_id);
+                    continue;
+                }
+                if (auto* report = std::get_if<judge_agents::JudgeReport>(&msg);
+                    report && compiled)
+                {
+                    (report->final ? final_logger : logger).append(report->log);
+                    process_judge_report(report->report, report->final, report->partial);
+                    if (report->final && !report->partial) {
+                        return;
+                    }
+                    continue;
+                }
+                if (auto* failure = std::get_if<judge_agents::TaskFailure>(&msg)) {
+                    logger("Judge agent failed: ", failure->error);
+                    mark_job_as_failed(mysql, logger, job_id);
+                    return;
+                }
+                throw judge_agents::ConnectionError{"unexpected message from the judge agent"};
+            }
+        } catch (const judge_agents::ConnectionError& e) {
+            agent->disconnect();
+            logger(
+                "Lost the judge agent (attempt ",
+                attempt,
+                " of ",
+                max_judge_agent_attempts,
+                "): ",
+                e.what()
+            );
+            final_logger.clear(); // the final tests are judged from scratch as well
+        }
+    }
 
-    auto final_judge_report =
-        judge_worker.judge(true, judge_logger, [&](const sim::JudgeReport& partial_judge_report) {
-            process_judge_report(partial_judge_report, true, true);
-        });
-    process_judge_report(final_judge_report, true, false);
+    auto tracee_cpus = tracee_cpus_pool().lease();
+    // The job may have been interrupted midway, e.g. by a restart of the job server
+    std::optional<JudgeCheckpoint> checkpoint;
+    judge_submission(
+        {
+            .package_file_id = problem_file_id,
+            .package_path = [&] { return sim::internal_files::path_of(problem_file_id); },
+            .language = language,
+            .solution_path = sim::internal_files::path_of(submission_file_id),
+            .solution_compilation_time_limit = sim::SOLUTION_COMPILATION_TIME_LIMIT,
+            .solution_compilation_memory_limit = sim::SOLUTION_COMPILATION_MEMORY_LIMIT,
+            .checker_compilation_time_limit = sim::CHECKER_COMPILATION_TIME_LIMIT,
+            .checker_compilation_memory_limit = sim::CHECKER_COMPILATION_MEMORY_LIMIT,
+            .compilation_errors_max_length = sim::COMPILATION_ERRORS_MAX_LENGTH,
+            .tracee_cpus = tracee_cpus.cpus(),
+        },
+        logger,
+        final_logger,
+        [&](const JudgeSubmissionCompilationResult& res, sim::JudgeWorker& judge_worker) {
+            using Status = JudgeSubmissionCompilationResult::Status;
+            switch (res.status) {
+            case Status::SOLUTION_COMPILATION_ERROR:
+                finish_with_compilation_error(res.compilation_errors);
+                return;
+            case Status::CHECKER_COMPILATION_ERROR: finish_with_checker_compilation_error(); return;
+            case Status::OK: break;
+            }
+            update_job_log(logger, job_id);
+
+            checkpoint.emplace(
+                job_id,
+                JudgeCheckpointIdentity{
+                    .problem_file_id = problem_file_id,
+                    .solution_file_id = submission_file_id,
+                    .language = language,
+                    .solution_compiler_identity = judge_worker.solution_compiler_identity(),
+                }
+            );
+            auto judged_tests = checkpoint->take_loaded_tests();
+            if (!judged_tests.empty()) {
+                logger(
+                    "Reusing results of ", judged_tests.size(), " tests judged before the restart."
+                );
+            }
+            judge_worker.set_judged_tests(std::move(judged_tests));
+            judge_worker.set_test_judged_callback(
+                [&checkpoint](const sim::JudgeWorker::TestResult& res) { checkpoint->append(res); }
+            );
+        },
+        [&](const sim::JudgeReport& judge_report, bool final, bool partial) {
+            process_judge_report(judge_report, final, partial);
+        }
+    );
 }
 } // namespace job_server::job_handlers
@@ -0,0 +1,157 @@
+#include "common.hh"
+#include "compilation_cache.hh"
+#include "judge_logger.hh"
+#include "judge_submission.hh"
+#include "package_files_cache.hh"
+#include "supervisor_pool.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <optional>
+#include <simlib/macros/stack_unwinding.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <string>
+#include <utility>
+
+namespace {
+
+// The supervisors are released between the judgments, so that idle threads do not hold them
+struct LoadedProblem {
+    decltype(job_server::job_handlers::JudgeSubmissionOptions::package_file_id) package_file_id;
+    sim::JudgeWorker judge_worker;
+    bool checker_compiled = false;
+};
+
+thread_local std::optional<LoadedProblem> thread_loaded_problem;
+
+// Determine, together with the concurrent compilation of the solution and the checker, how many
+// tracees run at the same time
+constexpr size_t max_concurrently_judged_tests = 1;
+constexpr bool judge_initial_and_final_concurrently = true;
+
+} // namespace
+
+namespace job_server::job_handlers {
+
+size_t judge_submission_max_concurrent_tracees() noexcept {
+    constexpr size_t concurrently_compiled = 2; // the solution and the checker
+    return std::max(
+        max_concurrently_judged_tests * (judge_initial_and_final_concurrently ? 2 : 1),
+        concurrently_compiled
+    );
+}
+
+void judge_submission(
+    const JudgeSubmissionOptions& options,
+    Logger& logger,
+    Logger& final_logger,
+    const std::function<void(const JudgeSubmissionCompilationResult&, sim::JudgeWorker&)>&
+        compiled_callback,
+    const std::function<void(const sim::JudgeReport&, bool final, bool partial)>& report_callback
+) {
+    STACK_UNWINDING_MARK;
+
+    // Take the loaded problem, so that it is not reused if the judging fails midway
+    auto loaded_problem = std::exchange(thread_loaded_problem, std::nullopt);
+    if (loaded_problem && loaded_problem->package_file_id == options.package_file_id) {
+        logger("Reusing the loaded problem package.");
+    } else {
+        loaded_problem = std::nullopt; // release the previous problem before loading the new one
+        sim::JudgeWorker judge_worker{{
+            .max_concurrently_judged_tests = max_concurrently_judged_tests,
+            .supervisor_pool = &supervisor_pool(),
+            .abort_on_wrong_answer = true,
+            .judge_initial_and_final_concurrently = judge_initial_and_final_concurrently,
+            .cpp_precompiled_headers = cpp_precompiled_headers(),
+        }};
+        logger("Loading problem package...");
+        judge_worker.load_package(
+            options.package_path(),
+            std::nullopt,
+            &package_files_cache(),
+            package_cached_name(options.package_file_id)
+        );
+        logger("... done.");
+        loaded_problem = LoadedProblem{
+            .package_file_id = options.package_file_id,
+            .judge_worker = std::move(judge_worker),
+        };
+    }
+    auto& judge_worker = loaded_problem->judge_worker;
+    judge_worker.set_tracee_cpus(options.tracee_cpus);
+
+    // The checker is compiled at the same time as the solution (the default checker is run
+    // in-process, so it needs no compilation)
+    std::string checker_compilation_errors;
+    auto checker_compilation = [&]() -> std::optional<std::future<int>> {
+        if (loaded_problem->checker_compiled || !judge_worker.simfile().checker) {
+            return std::nullopt;
+        }
+        return judge_worker.async_compile_checker(
+            options.checker_compilation_time_limit,
+            options.checker_compilation_memory_limit,
+            &checker_compilation_errors,
+            options.compilation_errors_max_length,
+            &compilation_cache(),
+            checker_cached_name(options.package_file_id, judge_worker.simfile())
+        );
+    }();
+    logger(checker_compilation ? "Compiling solution and checker..." : "Compiling solution...");
+    std::string compilation_errors;
+    bool solution_compilation_failed = judge_worker.compile_solution(
+        options.solution_path,
+        options.language,
+        options.solution_compilation_time_limit,
+        options.solution_compilation_memory_limit,
+        &compilation_errors,
+        options.compilation_errors_max_length,
+        &compilation_cache(),
+        std::string{solution_cached_name_prefix},
+        true // content-addressed
+    );
+    bool checker_compilation_failed = checker_compilation && checker_compilation->get();
+    if (checker_compilation && !checker_compilation_failed) {
+        loaded_problem->checker_compiled = true;
+    }
+
+    using Status = JudgeSubmissionCompilationResult::Status;
+    if (solution_compilation_failed) {
+        logger("... solution compilation failed:\n", compilation_errors);
+        compiled_callback(
+            {
+                .status = Status::SOLUTION_COMPILATION_ERROR,
+                .compilation_errors = std::move(compilation_errors),
+            },
+            judge_worker
+        );
+        judge_worker.release_supervisors();
+        thread_loaded_problem = std::move(loaded_problem);
+        return;
+    }
+    if (checker_compilation_failed) {
+        logger("... checker compilation failed:\n", checker_compilation_errors);
+        compiled_callback(
+            {
+                .status = Status::CHECKER_COMPILATION_ERROR,
+                .compilation_errors = std::move(checker_compilation_errors),
+            },
+            judge_worker
+        );
+        return;
+    }
+    logger("... done.");
+    compiled_callback({.status = Status::OK, .compilation_errors = ""}, judge_worker);
+
+    JudgeLogger initial_judge_logger(logger);
+    JudgeLogger final_judge_logger(final_logger);
+    (void)judge_worker.judge_initial_and_final(
+        initial_judge_logger, final_judge_logger, report_callback
+    );
+    judge_worker.set_judged_tests({});
+    judge_worker.set_test_judged_callback(nullptr);
+    judge_worker.release_supervisors();
+    thread_loaded_problem = std::move(loaded_problem);
+}
+
+} // namespace job_server::job_handlers
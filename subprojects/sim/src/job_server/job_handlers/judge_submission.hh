@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <sim/problems/problem.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <string>
+
+namespace job_server::job_handlers {
+
+struct JudgeSubmissionOptions {
+    decltype(sim::problems::Problem::file_id) package_file_id;
+    // Called only if the package is not loaded yet, see judge_submission()
+    std::function<std::string()> package_path;
+    sim::SolutionLanguage language;
+    std::string solution_path;
+    std::chrono::nanoseconds solution_compilation_time_limit;
+    uint64_t solution_compilation_memory_limit;
+    std::chrono::nanoseconds checker_compilation_time_limit;
+    uint64_t checker_compilation_memory_limit;
+    uint64_t compilation_errors_max_length;
+    // See sim::JudgeWorkerOptions::tracee_cpus
+    std::optional<std::string> tracee_cpus;
+};
+
+struct JudgeSubmissionCompilationResult {
+    enum class Status : uint8_t {
+        OK,
+        SOLUTION_COMPILATION_ERROR,
+        CHECKER_COMPILATION_ERROR,
+    };
+
+    Status status;
+    std::string compilation_errors; // of the solution or of the checker, depending on status
+};
+
+// Maximum number of the sandboxed processes running at the same time during judge_submission(). To
+// not share a CPU between them, JudgeSubmissionOptions::tracee_cpus needs at least that many CPUs.
+size_t judge_submission_max_concurrent_tracees() noexcept;
+
+// Judges the solution the way both the job server (judging locally) and the judge agents do:
+// compiles the solution and the checker at the same time, calls @p compiled_callback with the
+// result and, if both compiled, judges the initial and the final tests at the same time (see
+// sim::JudgeWorker::judge_initial_and_final()), logging them to @p logger and @p final_logger
+// respectively. @p compiled_callback may prepare the JudgeWorker for judging, e.g. set the judged
+// tests. Consecutive judgings of the solutions to the same package in the same thread, e.g. when
+// rejudging all submissions to a problem, reuse the loaded package and the compiled checker.
+void judge_submission(
+    const JudgeSubmissionOptions& options,
+    Logger& logger,
+    Logger& final_logger,
+    const std::function<void(const JudgeSubmissionCompilationResult&, sim::JudgeWorker&)>&
+        compiled_callback,
+    const std::function<void(const sim::JudgeReport&, bool final, bool partial)>& report_callback
+);
+
+} // namespace job_server::job_handlers
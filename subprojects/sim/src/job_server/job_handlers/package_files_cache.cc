@@ -0,0 +1,23 @@
+#include "package_files_cache.hh"
+
+#include <sim/judging_config.hh>
+#include <sim/problems/problem.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/sim/judge/package_files_cache.hh>
+
+using sim::problems::Problem;
+
+namespace job_server::job_handlers {
+
+sim::judge::PackageFilesCache& package_files_cache() {
+    static sim::judge::PackageFilesCache cache{
+        "package_files_cache/", sim::PACKAGE_FILES_CACHE_MAX_SIZE
+    };
+    return cache;
+}
+
+std::string package_cached_name(decltype(Problem::file_id) problem_file_id) {
+    return concat_tostr("package:", problem_file_id);
+}
+
+} // namespace job_server::job_handlers
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <sim/problems/problem.hh>
+#include <simlib/sim/judge/package_files_cache.hh>
+#include <string>
+
+namespace job_server::job_handlers {
+
+// Cache of files extracted from problem packages shared by all the workers, so that tests are
+// decompressed once, not on every judgment
+sim::judge::PackageFilesCache& package_files_cache();
+
+// Package files are immutable (reuploading a problem creates a new one)
+std::string package_cached_name(decltype(sim::problems::Problem::file_id) problem_file_id);
+
+} // namespace job_server::job_handlers
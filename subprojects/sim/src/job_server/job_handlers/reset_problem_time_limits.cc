@@ -1,7 +1,10 @@
 #include "add_or_reupload_problem/add_or_reupload_problem.hh"
+#include "compilation_cache.hh"
 #include "common.hh"
 #include "judge_logger.hh"
 #include "reset_problem_time_limits.hh"
+#include "supervisor_pool.hh"
+#include "tracee_cpus_pool.hh"
 
 #include <sim/internal_files/internal_file.hh>
 #include <sim/jobs/job.hh>
@@ -44,7 +47,12 @@ void reset_problem_time_limits(
     }
 
     auto input_package_path = sim::internal_files::path_of(problem_file_id);
-    sim::JudgeWorker judge_worker;
+    auto tracee_cpus = tracee_cpus_pool().lease();
+    sim::JudgeWorker judge_worker{{
+        .supervisor_pool = &supervisor_pool(),
+        .tracee_cpus = tracee_cpus.cpus(),
+        .cpp_precompiled_headers = cpp_precompiled_headers(),
+    }};
     logger("Loading problem package...");
     judge_worker.load_package(input_package_path, std::nullopt);
     logger("... done.");
@@ -0,0 +1,16 @@
+#include "supervisor_pool.hh"
+
+#include <sim/judging_config.hh>
+#include <simlib/sandbox/supervisor_pool.hh>
+
+namespace job_server::job_handlers {
+
+sandbox::SupervisorPool& supervisor_pool() {
+    static sandbox::SupervisorPool pool{{
+        .max_idle_supervisors = sim::SUPERVISOR_POOL_MAX_IDLE_SUPERVISORS,
+        .max_requests_per_supervisor = sim::SUPERVISOR_POOL_MAX_REQUESTS_PER_SUPERVISOR,
+    }};
+    return pool;
+}
+
+} // namespace job_server::job_handlers
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <simlib/sandbox/supervisor_pool.hh>
+
+namespace job_server::job_handlers {
+
+// Sandbox supervisors shared by all the workers, so that judging does not pay for spawning them
+sandbox::SupervisorPool& supervisor_pool();
+
+} // namespace job_server::job_handlers
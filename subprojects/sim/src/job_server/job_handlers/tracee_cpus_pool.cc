@@ -0,0 +1,69 @@
+#include "tracee_cpus_pool.hh"
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <simlib/string_transform.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace job_server::job_handlers {
+
+TraceeCpusPool::Lease::~Lease() {
+    if (!pool || !leased_cpus) {
+        return;
+    }
+    {
+        std::lock_guard lock{pool->mutex};
+        pool->free_cpus.emplace_back(std::move(*leased_cpus));
+    }
+    pool->cpus_released.notify_one();
+}
+
+void TraceeCpusPool::add_cpus(std::string cpus) {
+    std::lock_guard lock{mutex};
+    free_cpus.emplace_back(std::move(cpus));
+    has_cpus = true;
+}
+
+TraceeCpusPool::Lease TraceeCpusPool::lease() {
+    std::unique_lock lock{mutex};
+    if (!has_cpus) {
+        return Lease{nullptr, std::nullopt};
+    }
+    cpus_released.wait(lock, [&] { return !free_cpus.empty(); });
+    auto cpus = std::move(free_cpus.back());
+    free_cpus.pop_back();
+    return Lease{this, std::move(cpus)};
+}
+
+TraceeCpusPool& tracee_cpus_pool() {
+    static TraceeCpusPool pool;
+    return pool;
+}
+
+std::optional<std::vector<size_t>> parse_cpus(StringView cpus) {
+    std::vector<size_t> res;
+    for (;;) {
+        auto comma_pos = cpus.find(',');
+        auto range = cpus.substring(0, comma_pos);
+        auto dash_pos = range.find('-');
+        auto first = str2num<size_t>(range.substring(0, dash_pos));
+        auto last = dash_pos == StringView::npos ? first
+                                                 : str2num<size_t>(range.substring(dash_pos + 1));
+        if (!first || !last || *first > *last) {
+            return std::nullopt;
+        }
+        for (auto cpu = *first; cpu <= *last; ++cpu) {
+            res.emplace_back(cpu);
+        }
+        if (comma_pos == StringView::npos) {
+            return res;
+        }
+        cpus.remove_prefix(comma_pos + 1);
+    }
+}
+
+} // namespace job_server::job_handlers
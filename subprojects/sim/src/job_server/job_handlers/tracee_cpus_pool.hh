@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <simlib/string_view.hh>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace job_server::job_handlers {
+
+// Sets of CPUs (in the cpuset.cpus format, e.g. "2-3") dedicated to the sandboxed processes of one
+// job at a time, see job_server_tracee_cpus in sim.conf. Safe to use from multiple threads.
+class TraceeCpusPool {
+    std::mutex mutex;
+    std::condition_variable cpus_released;
+    std::vector<std::string> free_cpus;
+    bool has_cpus = false;
+
+public:
+    TraceeCpusPool() = default;
+
+    TraceeCpusPool(const TraceeCpusPool&) = delete;
+    TraceeCpusPool(TraceeCpusPool&&) = delete;
+    TraceeCpusPool& operator=(const TraceeCpusPool&) = delete;
+    TraceeCpusPool& operator=(TraceeCpusPool&&) = delete;
+    ~TraceeCpusPool() = default;
+
+    // Returns the CPUs to the pool upon destruction
+    class [[nodiscard]] Lease {
+        TraceeCpusPool* pool;
+        std::optional<std::string> leased_cpus;
+
+        Lease(TraceeCpusPool* pool, std::optional<std::string>&& leased_cpus) noexcept
+        : pool{pool}
+        , leased_cpus{std::move(leased_cpus)} {}
+
+        friend class TraceeCpusPool;
+
+    public:
+        Lease(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept
+        : pool{std::exchange(other.pool, nullptr)}
+        , leased_cpus{std::move(other.leased_cpus)} {}
+
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease();
+
+        // std::nullopt means that the sandboxed processes are not to be pinned
+        [[nodiscard]] const std::optional<std::string>& cpus() const noexcept {
+            return leased_cpus;
+        }
+    };
+
+    // Has to be called before the first lease()
+    void add_cpus(std::string cpus);
+
+    // Waits for free CPUs if all of them are leased. If no CPUs were added, returns a lease of no
+    // CPUs at once.
+    Lease lease();
+};
+
+TraceeCpusPool& tracee_cpus_pool();
+
+// Returns the ids of the CPUs @p cpus given in the cpuset.cpus format, e.g. "0-2,5" ->
+// {0, 1, 2, 5}, or std::nullopt if @p cpus is malformed or has an empty range, e.g. "5-2"
+std::optional<std::vector<size_t>> parse_cpus(StringView cpus);
+
+} // namespace job_server::job_handlers
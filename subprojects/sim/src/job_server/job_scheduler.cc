@@ -0,0 +1,360 @@
+#include "job_scheduler.hh"
+
+#include <iterator>
+#include <map>
+#include <optional>
+#include <sim/jobs/job.hh>
+#include <simlib/macros/throw.hh>
+#include <utility>
+#include <vector>
+
+namespace job_server {
+
+std::vector<JobScheduler::ConflictKey> JobScheduler::conflict_keys_of(const Job& job) {
+    using JT = sim::jobs::Job::Type;
+    // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
+    switch (job.type) {
+    case JT::JUDGE_SUBMISSION:
+    case JT::REJUDGE_SUBMISSION: return {{ConflictKind::SUBMISSION, job.aux_id.value()}};
+
+    case JT::ADD_PROBLEM: return {}; // Does not collide with anything.
+
+    case JT::REUPLOAD_PROBLEM:
+    case JT::EDIT_PROBLEM:
+    case JT::DELETE_PROBLEM:
+    case JT::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION:
+    case JT::CHANGE_PROBLEM_STATEMENT: return {{ConflictKind::PROBLEM, job.aux_id.value()}};
+
+    case JT::MERGE_PROBLEMS:
+        if (job.aux_id.value() == job.aux_id_2.value()) {
+            return {{ConflictKind::PROBLEM, job.aux_id.value()}};
+        }
+        return {
+            {ConflictKind::PROBLEM, job.aux_id.value()},
+            {ConflictKind::PROBLEM, job.aux_id_2.value()},
+        };
+
+    case JT::RESELECT_FINAL_SUBMISSIONS_IN_CONTEST_PROBLEM:
+    case JT::DELETE_CONTEST_PROBLEM: return {{ConflictKind::CONTEST_PROBLEM, job.aux_id.value()}};
+
+    case JT::DELETE_USER: return {{ConflictKind::USER, job.aux_id.value()}};
+
+    case JT::MERGE_USERS:
+        if (job.aux_id.value() == job.aux_id_2.value()) {
+            return {{ConflictKind::USER, job.aux_id.value()}};
+        }
+        return {
+            {ConflictKind::USER, job.aux_id.value()},
+            {ConflictKind::USER, job.aux_id_2.value()},
+        };
+
+    case JT::DELETE_CONTEST: return {{ConflictKind::CONTEST, job.aux_id.value()}};
+
+    case JT::DELETE_CONTEST_ROUND: return {{ConflictKind::CONTEST_ROUND, job.aux_id.value()}};
+
+    case JT::DELETE_INTERNAL_FILE: return {{ConflictKind::INTERNAL_FILE, job.aux_id.value()}};
+    }
+    THROW("invalid job type");
+}
+
+JobScheduler::ResourceClass JobScheduler::resource_class_of(decltype(Job::type) job_type) {
+    using JT = sim::jobs::Job::Type;
+    // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
+    switch (job_type) {
+    case JT::JUDGE_SUBMISSION:
+    case JT::REJUDGE_SUBMISSION: return ResourceClass::JUDGE;
+
+    case JT::ADD_PROBLEM:
+    case JT::REUPLOAD_PROBLEM:
+    case JT::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION: return ResourceClass::PROBLEM_PACKAGE;
+
+    case JT::EDIT_PROBLEM:
+    case JT::DELETE_PROBLEM:
+    case JT::CHANGE_PROBLEM_STATEMENT:
+    case JT::MERGE_PROBLEMS:
+    case JT::RESELECT_FINAL_SUBMISSIONS_IN_CONTEST_PROBLEM:
+    case JT::DELETE_CONTEST_PROBLEM:
+    case JT::DELETE_USER:
+    case JT::MERGE_USERS:
+    case JT::DELETE_CONTEST:
+    case JT::DELETE_CONTEST_ROUND:
+    case JT::DELETE_INTERNAL_FILE: return ResourceClass::LIGHT;
+    }
+    THROW("invalid job type");
+}
+
+namespace {
+
+// Running many jobs of the same coalescing group with the same aux_id in a row has the same effect
+// as running just the last of them
+std::optional<int> coalescing_group_of(sim::jobs::Job::Type job_type) noexcept {
+    using JT = sim::jobs::Job::Type;
+    if (job_type == JT::JUDGE_SUBMISSION || job_type == JT::REJUDGE_SUBMISSION) {
+        return 0;
+    }
+    if (job_type == JT::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION) {
+        return 1;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+void JobScheduler::add_startable_job(const Job& job) {
+    auto& priority_class = startable_jobs[job.priority];
+    auto [it, inserted] = priority_class.creators.try_emplace(job.creator);
+    if (inserted) {
+        // A new creator goes to the end of the round-robin, a known one keeps their turn
+        auto& turns = priority_turns[job.priority];
+        auto [turn_it, turn_inserted] =
+            turns.creator_turns.try_emplace(job.creator, turns.next_turn);
+        if (turn_inserted) {
+            ++turns.next_turn;
+        }
+        priority_class.round_robin.emplace(turn_it->second, job.creator);
+    }
+    it->second.emplace(job.id);
+}
+
+void JobScheduler::remove_startable_job(const Job& job) {
+    auto priority_class_it = startable_jobs.find(job.priority);
+    auto& priority_class = priority_class_it->second;
+    auto creator_it = priority_class.creators.find(job.creator);
+    auto& creator_job_ids = creator_it->second;
+    creator_job_ids.erase(job.id);
+    if (creator_job_ids.empty()) {
+        priority_class.round_robin.erase(
+            {priority_turns.at(job.priority).creator_turns.at(job.creator), job.creator}
+        );
+        priority_class.creators.erase(creator_it);
+        if (priority_class.creators.empty()) {
+            startable_jobs.erase(priority_class_it);
+        }
+    }
+}
+
+JobScheduler::PriorityClass& JobScheduler::choose_priority_class() {
+    auto highest = startable_jobs.begin();
+    auto chosen = highest;
+    for (auto it = std::next(highest); it != startable_jobs.end(); ++it) {
+        // The aged class with the highest priority goes first
+        if (++priority_turns[it->first].passed_over_num >= aging_threshold && chosen == highest) {
+            chosen = it;
+        }
+    }
+    priority_turns[chosen->first].passed_over_num = 0;
+    return chosen->second;
+}
+
+void JobScheduler::add_blocker(PendingJob& pj) {
+    if (pj.blockers_num++ == 0) {
+        remove_startable_job(pj.job);
+    }
+}
+
+void JobScheduler::remove_blocker(PendingJob& pj) {
+    if (--pj.blockers_num == 0) {
+        add_startable_job(pj.job);
+    }
+}
+
+void JobScheduler::update_pending_jobs_of(ResourceClassState& resource_class_state, bool was_full) {
+    if (resource_class_state.is_full() == was_full) {
+        return;
+    }
+    for (auto pending_job_id : resource_class_state.pending_job_ids) {
+        auto& pj = pending_jobs.at(pending_job_id);
+        if (was_full) {
+            remove_blocker(pj);
+        } else {
+            add_blocker(pj);
+        }
+    }
+}
+
+void JobScheduler::set_max_jobs_in_progress(
+    ResourceClass resource_class, std::optional<size_t> max_jobs_in_progress
+) {
+    if (max_jobs_in_progress == 0) {
+        THROW("max_jobs_in_progress has to be greater than 0");
+    }
+    auto& rcs = resource_classes[resource_class];
+    bool was_full = rcs.is_full();
+    rcs.max_jobs_in_progress = max_jobs_in_progress;
+    update_pending_jobs_of(rcs, was_full);
+}
+
+void JobScheduler::add_pending_job(const Job& job) {
+    if (pending_jobs.count(job.id) || in_progress_jobs.count(job.id)) {
+        return;
+    }
+    auto conflict_keys = conflict_keys_of(job);
+    size_t blockers_num = 0;
+    for (const auto& conflict_key : conflict_keys) {
+        auto& job_ids = pending_jobs_by_conflict_key[conflict_key];
+        bool held = held_conflict_keys.count(conflict_key);
+        if (job_ids.empty() || job.id < *job_ids.begin()) {
+            // The job becomes the first pending job with this conflict key
+            if (!job_ids.empty() && !held) {
+                add_blocker(pending_jobs.at(*job_ids.begin()));
+            }
+            blockers_num += held;
+        } else {
+            ++blockers_num; // the earlier job goes first
+        }
+        job_ids.emplace(job.id);
+    }
+    auto resource_class = resource_class_of(job.type);
+    auto& rcs = resource_classes[resource_class];
+    rcs.pending_job_ids.emplace(job.id);
+    blockers_num += rcs.is_full();
+    if (blockers_num == 0) {
+        add_startable_job(job);
+    }
+    pending_jobs.emplace(
+        job.id,
+        PendingJob{
+            .job = job,
+            .conflict_keys = std::move(conflict_keys),
+            .resource_class = resource_class,
+            .blockers_num = blockers_num,
+        }
+    );
+}
+
+void JobScheduler::remove_pending_job(JobId job_id) {
+    auto it = pending_jobs.find(job_id);
+    if (it == pending_jobs.end()) {
+        return;
+    }
+    auto& pj = it->second;
+    for (const auto& conflict_key : pj.conflict_keys) {
+        auto jobs_it = pending_jobs_by_conflict_key.find(conflict_key);
+        auto& job_ids = jobs_it->second;
+        bool was_first = *job_ids.begin() == job_id;
+        job_ids.erase(job_id);
+        if (job_ids.empty()) {
+            pending_jobs_by_conflict_key.erase(jobs_it);
+        } else if (was_first && !held_conflict_keys.count(conflict_key)) {
+            remove_blocker(pending_jobs.at(*job_ids.begin()));
+        }
+    }
+    resource_classes[pj.resource_class].pending_job_ids.erase(job_id);
+    if (pj.blockers_num == 0) {
+        remove_startable_job(pj.job);
+    }
+    pending_jobs.erase(it);
+}
+
+void JobScheduler::remove_all_pending_jobs() {
+    pending_jobs.clear();
+    startable_jobs.clear();
+    pending_jobs_by_conflict_key.clear();
+    for (auto& [resource_class, rcs] : resource_classes) {
+        rcs.pending_job_ids.clear();
+    }
+}
+
+std::map<std::pair<decltype(JobScheduler::Job::type), JobScheduler::Priority>, size_t>
+JobScheduler::pending_jobs_num_by_type_and_priority() const {
+    std::map<std::pair<decltype(Job::type), Priority>, size_t> res;
+    for (const auto& [job_id, pending_job] : pending_jobs) {
+        ++res[{pending_job.job.type, pending_job.job.priority}];
+    }
+    return res;
+}
+
+std::optional<JobScheduler::Job> JobScheduler::start_next_job() {
+    if (startable_jobs.empty()) {
+        return std::nullopt;
+    }
+    auto job_id = [&] {
+        auto& priority_class = choose_priority_class();
+        auto creator = priority_class.round_robin.begin()->second;
+        return *priority_class.creators.at(creator).begin();
+    }();
+    auto job = pending_jobs.at(job_id).job;
+    auto conflict_keys = pending_jobs.at(job_id).conflict_keys;
+    auto resource_class = pending_jobs.at(job_id).resource_class;
+    // The next pending jobs with the started job's conflict keys are blocked by it from now on
+    held_conflict_keys.insert(conflict_keys.begin(), conflict_keys.end());
+    remove_pending_job(job_id);
+    // The creator goes to the end of the round-robin
+    auto& turns = priority_turns.at(job.priority);
+    auto& turn = turns.creator_turns.at(job.creator);
+    if (auto it = startable_jobs.find(job.priority); it != startable_jobs.end()) {
+        auto& priority_class = it->second;
+        if (priority_class.creators.count(job.creator)) {
+            priority_class.round_robin.erase({turn, job.creator});
+            priority_class.round_robin.emplace(turns.next_turn, job.creator);
+        }
+    }
+    turn = turns.next_turn++;
+
+    // Pending jobs of the started job's resource class cannot be started now if it became full
+    auto& rcs = resource_classes[resource_class];
+    bool was_full = rcs.is_full();
+    ++rcs.jobs_in_progress_num;
+    update_pending_jobs_of(rcs, was_full);
+    in_progress_jobs.emplace(
+        job_id,
+        InProgressJob{
+            .conflict_keys = std::move(conflict_keys),
+            .resource_class = resource_class,
+        }
+    );
+    return job;
+}
+
+std::vector<JobScheduler::JobId>
+JobScheduler::remove_pending_jobs_superseded_by(const Job& started_job) {
+    auto coalescing_group = coalescing_group_of(started_job.type);
+    if (!coalescing_group) {
+        return {};
+    }
+    std::vector<JobId> superseded_job_ids;
+    for (const auto& conflict_key : conflict_keys_of(started_job)) {
+        auto jobs_it = pending_jobs_by_conflict_key.find(conflict_key);
+        if (jobs_it == pending_jobs_by_conflict_key.end()) {
+            continue;
+        }
+        for (auto pending_job_id : jobs_it->second) {
+            const auto& job = pending_jobs.at(pending_job_id).job;
+            // Other conflicting jobs might need to run in between, e.g. resetting time limits after
+            // reuploading the problem
+            if (coalescing_group_of(job.type) != coalescing_group ||
+                job.aux_id != started_job.aux_id)
+            {
+                return {};
+            }
+            superseded_job_ids.emplace_back(pending_job_id);
+        }
+    }
+    for (auto job_id : superseded_job_ids) {
+        remove_pending_job(job_id);
+    }
+    return superseded_job_ids;
+}
+
+void JobScheduler::finish_job(JobId job_id) {
+    auto it = in_progress_jobs.find(job_id);
+    if (it == in_progress_jobs.end()) {
+        THROW("job ", job_id, " is not in progress");
+    }
+    auto& ipj = it->second;
+    for (const auto& conflict_key : ipj.conflict_keys) {
+        held_conflict_keys.erase(conflict_key);
+        // Only the first pending job with the conflict key was waiting just for the finished job
+        auto jobs_it = pending_jobs_by_conflict_key.find(conflict_key);
+        if (jobs_it != pending_jobs_by_conflict_key.end()) {
+            remove_blocker(pending_jobs.at(*jobs_it->second.begin()));
+        }
+    }
+    auto& rcs = resource_classes[ipj.resource_class];
+    bool was_full = rcs.is_full();
+    --rcs.jobs_in_progress_num;
+    update_pending_jobs_of(rcs, was_full);
+    in_progress_jobs.erase(it);
+}
+
+} // namespace job_server
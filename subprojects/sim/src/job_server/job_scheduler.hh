@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <sim/jobs/job.hh>
+#include <utility>
+#include <vector>
+
+namespace job_server {
+
+// Keeps pending jobs in memory and chooses the next job to process among the ones that do not
+// conflict with any job in progress or any earlier pending job, e.g. two jobs modifying the same
+// problem never run at the same time and run in the order of their ids, and whose resource class
+// has not reached its limit of jobs in progress. Jobs with higher
+// priority go first, but within the same priority the job creators take
+// turns, so that one creator with many jobs does not delay the jobs of the others. To make progress
+// with lower priority jobs, a priority class passed over aging_threshold times since its last turn
+// gets the next turn.
+class JobScheduler {
+public:
+    struct Job {
+        decltype(sim::jobs::Job::id) id;
+        decltype(sim::jobs::Job::creator) creator;
+        decltype(sim::jobs::Job::type) type;
+        decltype(sim::jobs::Job::priority) priority;
+        decltype(sim::jobs::Job::aux_id) aux_id;
+        decltype(sim::jobs::Job::aux_id_2) aux_id_2;
+        std::chrono::system_clock::time_point created_at; // only for the metrics
+    };
+
+    static constexpr size_t aging_threshold = 16;
+
+    // Jobs of the same resource class need similar resources, so limiting the number of jobs in
+    // progress per class keeps them from oversubscribing the CPUs or the memory
+    enum class ResourceClass : uint8_t {
+        JUDGE, // compiles and runs the solution and the checker
+        PROBLEM_PACKAGE, // compiles and runs the model solution on the whole package
+        LIGHT, // only database and file operations
+    };
+
+    static ResourceClass resource_class_of(decltype(Job::type) job_type);
+
+private:
+    enum class ConflictKind : uint8_t {
+        SUBMISSION,
+        PROBLEM,
+        USER,
+        CONTEST_PROBLEM,
+        CONTEST,
+        CONTEST_ROUND,
+        INTERNAL_FILE,
+    };
+
+    // Jobs conflict iff they share a conflict key
+    using ConflictKey = std::pair<ConflictKind, uint64_t>;
+
+    static std::vector<ConflictKey> conflict_keys_of(const Job& job);
+
+    struct PendingJob {
+        Job job;
+        std::vector<ConflictKey> conflict_keys;
+        ResourceClass resource_class;
+        // Conflict keys held by jobs in progress or by earlier pending jobs + 1 if the resource
+        // class reached its limit
+        size_t blockers_num;
+    };
+
+    struct InProgressJob {
+        std::vector<ConflictKey> conflict_keys;
+        ResourceClass resource_class;
+    };
+
+    using JobId = decltype(Job::id);
+    using Priority = decltype(Job::priority);
+    using Creator = decltype(Job::creator);
+
+    // Startable jobs of the same priority
+    struct PriorityClass {
+        std::map<Creator, std::set<JobId>> creators;
+        std::set<std::pair<uint64_t, Creator>> round_robin; // (turn, creator)
+    };
+
+    // Fairness state of the jobs of the same priority. It is kept separately from the pending jobs,
+    // so that it survives the priority having no startable jobs for a while and reloading all the
+    // pending jobs.
+    struct PriorityTurns {
+        std::map<Creator, uint64_t> creator_turns; // position in the round-robin
+        uint64_t next_turn = 0;
+        size_t passed_over_num = 0;
+    };
+
+    struct ResourceClassState {
+        std::optional<size_t> max_jobs_in_progress; // std::nullopt means no limit
+        size_t jobs_in_progress_num = 0;
+        std::set<JobId> pending_job_ids;
+
+        [[nodiscard]] bool is_full() const noexcept {
+            return max_jobs_in_progress && jobs_in_progress_num >= *max_jobs_in_progress;
+        }
+    };
+
+    std::map<JobId, PendingJob> pending_jobs;
+    // Pending jobs with no blockers, highest priority first
+    std::map<Priority, PriorityClass, std::greater<>> startable_jobs;
+    std::map<Priority, PriorityTurns> priority_turns;
+    std::map<ConflictKey, std::set<JobId>> pending_jobs_by_conflict_key;
+    std::map<JobId, InProgressJob> in_progress_jobs;
+    std::set<ConflictKey> held_conflict_keys; // conflict keys of jobs in progress
+    std::map<ResourceClass, ResourceClassState> resource_classes;
+
+    void add_startable_job(const Job& job);
+
+    void remove_startable_job(const Job& job);
+
+    // Keep startable_jobs in sync with blockers_num
+    void add_blocker(PendingJob& pj);
+
+    void remove_blocker(PendingJob& pj);
+
+    // Returns priority class to start the next job from and updates the aging state
+    PriorityClass& choose_priority_class();
+
+    // Blocks or unblocks the pending jobs of the resource class if it became full or stopped being
+    // full
+    void update_pending_jobs_of(ResourceClassState& resource_class_state, bool was_full);
+
+public:
+    // @p max_jobs_in_progress has to be greater than 0, std::nullopt means no limit (default)
+    void set_max_jobs_in_progress(
+        ResourceClass resource_class, std::optional<size_t> max_jobs_in_progress
+    );
+
+    // Adding a job that is already pending or in progress is a no-op
+    void add_pending_job(const Job& job);
+
+    // Removing a job that is not pending is a no-op
+    void remove_pending_job(JobId job_id);
+
+    // The turns of the priorities and the job creators are kept, so reloading the pending jobs
+    // does not reset them
+    void remove_all_pending_jobs();
+
+    [[nodiscard]] size_t pending_jobs_num() const noexcept { return pending_jobs.size(); }
+
+    [[nodiscard]] std::map<std::pair<decltype(Job::type), Priority>, size_t>
+    pending_jobs_num_by_type_and_priority() const;
+
+    // Returns std::nullopt if every pending job conflicts with a job in progress or its resource
+    // class is full. Otherwise, the returned job becomes in progress until finish_job() is called.
+    std::optional<Job> start_next_job();
+
+    // Removes the pending jobs that would have the same effect as the started job, e.g. the other
+    // judge jobs of the same submission, and returns their ids. It should be called once the
+    // started job is certain to run.
+    std::vector<JobId> remove_pending_jobs_superseded_by(const Job& started_job);
+
+    void finish_job(JobId job_id);
+};
+
+} // namespace job_server
@@ -6,5 +6,7 @@ namespace job_server {
 
 static constexpr CStringView stdlog_file = "logs/job-server.log";
 static constexpr CStringView errlog_file = "logs/job-server-error.log";
+// Metrics in the Prometheus text format, rewritten every few seconds
+static constexpr CStringView metrics_file = "logs/job-server-metrics.prom";
 
 } // namespace job_server
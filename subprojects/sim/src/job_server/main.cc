@@ -7,14 +7,23 @@
 #include "job_handlers/delete_internal_file.hh"
 #include "job_handlers/delete_problem.hh"
 #include "job_handlers/delete_user.hh"
+#include "job_handlers/judge_agent_pool.hh"
+#include "job_handlers/judge_checkpoint.hh"
 #include "job_handlers/judge_or_rejudge_submission.hh"
+#include "job_handlers/judge_submission.hh"
 #include "job_handlers/merge_problems.hh"
 #include "job_handlers/merge_users.hh"
 #include "job_handlers/reselect_final_submissions_in_contest_problem.hh"
 #include "job_handlers/reset_problem_time_limits.hh"
 #include "job_handlers/reupload_problem.hh"
+#include "job_handlers/supervisor_pool.hh"
+#include "job_handlers/tracee_cpus_pool.hh"
+#include "job_scheduler.hh"
 #include "logs.hh"
+#include "metrics.hh"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <csignal>
 #include <cstdint>
@@ -23,30 +32,44 @@
 #include <fcntl.h>
 #include <memory>
 #include <pthread.h>
+#include <sched.h>
+#include <set>
 #include <sim/job_server/notify.hh>
 #include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
+#include <sim/judge_agents/protocol.hh>
 #include <sim/mysql/mysql.hh>
 #include <sim/mysql/repeat_if_deadlocked.hh>
+#include <sim/sql/fields/datetime.hh>
 #include <sim/sql/sql.hh>
 #include <simlib/am_i_root.hh>
 #include <simlib/concat_tostr.hh>
 #include <simlib/concurrent/bounded_queue.hh>
 #include <simlib/concurrent/mutexed_value.hh>
 #include <simlib/config_file.hh>
+#include <simlib/directory.hh>
 #include <simlib/errmsg.hh>
 #include <simlib/event_queue.hh>
+#include <simlib/file_contents.hh>
 #include <simlib/file_descriptor.hh>
+#include <simlib/file_manip.hh>
 #include <simlib/inotify.hh>
 #include <simlib/logger.hh>
 #include <simlib/macros/stack_unwinding.hh>
 #include <simlib/process.hh>
 #include <simlib/repeating.hh>
 #include <simlib/syscalls.hh>
+#include <simlib/time_format_conversions.hh>
 #include <simlib/working_directory.hh>
+#include <string>
 #include <sys/eventfd.h>
 #include <sys/signalfd.h>
+#include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
+#include <utility>
+#include <variant>
+#include <vector>
 
 using sim::jobs::Job;
 using sim::sql::Select;
@@ -54,277 +77,185 @@ using sim::sql::Update;
 
 namespace {
 
-class NewJobFilterBuilder {
-private:
-    std::map<decltype(Job::id), std::string> job_sql_conditions;
-
-public:
-    void add_in_progress_job(
-        decltype(Job::id) job_id,
-        decltype(Job::type) job_type,
-        decltype(Job::aux_id) job_aux_id,
-        decltype(Job::aux_id_2) job_aux_id_2
-    ) {
-        static constexpr auto to_int = [](decltype(Job::type) job_type) {
-            return static_cast<decltype(Job::type)::UnderlyingType>(job_type);
-        };
-
-        // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
-        switch (job_type) {
-        case Job::Type::JUDGE_SUBMISSION:
-        case Job::Type::REJUDGE_SUBMISSION:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT (type IN (",
-                    to_int(Job::Type::JUDGE_SUBMISSION),
-                    ", ",
-                    to_int(Job::Type::REJUDGE_SUBMISSION),
-                    ") AND aux_id=",
-                    job_aux_id.value(),
-                    ")"
-                )
-            );
-            return;
-
-        case Job::Type::ADD_PROBLEM: return; // Does not collide with anything.
-
-        case Job::Type::REUPLOAD_PROBLEM:
-        case Job::Type::EDIT_PROBLEM:
-        case Job::Type::DELETE_PROBLEM:
-        case Job::Type::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION:
-        case Job::Type::CHANGE_PROBLEM_STATEMENT:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT ((type IN (",
-                    to_int(Job::Type::REUPLOAD_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::EDIT_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::DELETE_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION),
-                    ", ",
-                    to_int(Job::Type::CHANGE_PROBLEM_STATEMENT),
-                    ") AND aux_id=",
-                    job_aux_id.value(),
-                    ") OR (type=",
-                    to_int(Job::Type::MERGE_PROBLEMS),
-                    " AND (aux_id=",
-                    job_aux_id.value(),
-                    " OR aux_id_2=",
-                    job_aux_id.value(),
-                    ")))"
-                )
-            );
-            return;
-
-        case Job::Type::MERGE_PROBLEMS:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT ((type IN (",
-                    to_int(Job::Type::REUPLOAD_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::EDIT_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::DELETE_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION),
-                    ", ",
-                    to_int(Job::Type::CHANGE_PROBLEM_STATEMENT),
-                    ") AND aux_id IN (",
-                    job_aux_id.value(),
-                    ", ",
-                    job_aux_id_2.value(),
-                    ")) OR (type=",
-                    to_int(Job::Type::MERGE_PROBLEMS),
-                    " AND (aux_id IN (",
-                    job_aux_id.value(),
-                    ", ",
-                    job_aux_id_2.value(),
-                    ") OR aux_id_2 IN (",
-                    job_aux_id.value(),
-                    ", ",
-                    job_aux_id_2.value(),
-                    "))))"
-                )
-            );
-            return;
-
-        case Job::Type::RESELECT_FINAL_SUBMISSIONS_IN_CONTEST_PROBLEM:
-        case Job::Type::DELETE_CONTEST_PROBLEM:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT (type IN (",
-                    to_int(Job::Type::RESELECT_FINAL_SUBMISSIONS_IN_CONTEST_PROBLEM),
-                    ", ",
-                    to_int(Job::Type::DELETE_CONTEST_PROBLEM),
-                    ") AND aux_id=",
-                    job_aux_id.value(),
-                    ")"
-                )
-            );
-            return;
-
-        case Job::Type::DELETE_USER:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT ((type=",
-                    to_int(Job::Type::DELETE_USER),
-                    " AND aux_id=",
-                    job_aux_id.value(),
-                    ") OR (type=",
-                    to_int(Job::Type::MERGE_USERS),
-                    " AND (aux_id=",
-                    job_aux_id.value(),
-                    " OR aux_id_2=",
-                    job_aux_id.value(),
-                    ")))"
-                )
-            );
-            return;
-
-        case Job::Type::MERGE_USERS:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT ((type=",
-                    to_int(Job::Type::DELETE_USER),
-                    " AND aux_id IN (",
-                    job_aux_id.value(),
-                    ", ",
-                    job_aux_id_2.value(),
-                    ")) OR (type=",
-                    to_int(Job::Type::MERGE_USERS),
-                    " AND (aux_id IN (",
-                    job_aux_id.value(),
-                    ", ",
-                    job_aux_id_2.value(),
-                    ") OR aux_id_2 IN (",
-                    job_aux_id.value(),
-                    ", ",
-                    job_aux_id_2.value(),
-                    "))))"
-                )
-            );
-            return;
-
-        case Job::Type::DELETE_CONTEST:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT (type=",
-                    to_int(Job::Type::DELETE_CONTEST),
-                    " AND aux_id=",
-                    job_aux_id.value(),
-                    ")"
-                )
-            );
-            return;
-
-        case Job::Type::DELETE_CONTEST_ROUND:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT (type=",
-                    to_int(Job::Type::DELETE_CONTEST_ROUND),
-                    " AND aux_id=",
-                    job_aux_id.value(),
-                    ")"
-                )
-            );
-            return;
-
-        case Job::Type::DELETE_INTERNAL_FILE:
-            job_sql_conditions.emplace(
-                job_id,
-                concat_tostr(
-                    "NOT (type=",
-                    to_int(Job::Type::DELETE_INTERNAL_FILE),
-                    " AND aux_id=",
-                    job_aux_id.value(),
-                    ")"
-                )
-            );
-            return;
-        }
-        THROW("invalid job_type");
-    }
-
-    void remove_in_progress_job(decltype(Job::id) job_id) { job_sql_conditions.erase(job_id); }
-
-    sim::sql::Condition<> build_condition() {
-        std::optional<sim::sql::Condition<>> res;
-        for (const auto& [job_id, job_sql_condition] : job_sql_conditions) {
-            res = std::move(res) &&
-                std::optional{sim::sql::Condition(std::string{job_sql_condition})};
-        }
-        return res.value_or(sim::sql::Condition<>("TRUE"));
-    }
-};
-
 struct Task {
     decltype(Job::id) job_id;
     decltype(Job::type) job_type;
     decltype(Job::aux_id) job_aux_id;
     decltype(Job::aux_id_2) job_aux_id_2;
+    decltype(job_server::JobScheduler::Job::created_at) job_created_at;
 };
 
 struct Worker {
     std::thread thread;
     concurrent::BoundedQueue<Task> task_channel{1};
     sim::mysql::Connection mysql = sim::mysql::Connection::from_credential_file(".db.config");
-    concurrent::MutexedValue<NewJobFilterBuilder>* new_job_filter_builder = nullptr;
+    concurrent::MutexedValue<job_server::JobScheduler>* job_scheduler = nullptr;
+    job_server::Metrics* metrics = nullptr;
 };
 
+std::vector<job_server::JobScheduler::Job>
+select_pending_jobs(sim::mysql::Connection& mysql, decltype(Job::id) min_id) {
+    std::vector<job_server::JobScheduler::Job> jobs;
+    job_server::JobScheduler::Job job;
+    decltype(Job::created_at) created_at;
+    auto stmt = mysql.execute(Select("id, created_at, creator, type, priority, aux_id, aux_id_2")
+                                  .from("jobs")
+                                  .where("status=? AND id>=?", Job::Status::PENDING, min_id));
+    stmt.res_bind(
+        job.id, created_at, job.creator, job.type, job.priority, job.aux_id, job.aux_id_2
+    );
+    while (stmt.next()) {
+        job.created_at = str_to_time_point(created_at);
+        jobs.emplace_back(job);
+    }
+    return jobs;
+}
+
+// Loads pending jobs with ids greater than last_loaded_job_id, i.e. the newly created ones
+void load_new_pending_jobs(
+    sim::mysql::Connection& mysql,
+    concurrent::MutexedValue<job_server::JobScheduler>& job_scheduler,
+    decltype(Job::id)& last_loaded_job_id
+) {
+    auto jobs = select_pending_jobs(mysql, last_loaded_job_id + 1);
+    auto [guard, job_scheduler_value] = job_scheduler.get();
+    for (const auto& job : jobs) {
+        job_scheduler_value.add_pending_job(job);
+        last_loaded_job_id = std::max(last_loaded_job_id, job.id);
+    }
+    stdlog("Loaded ", jobs.size(), " new pending jobs");
+}
+
+// Loading only new jobs misses restarted jobs (they keep their ids) and jobs whose creating
+// transactions committed out of the id order, so all pending jobs need to be reloaded once in a
+// while.
+void reload_all_pending_jobs(
+    sim::mysql::Connection& mysql,
+    concurrent::MutexedValue<job_server::JobScheduler>& job_scheduler,
+    decltype(Job::id)& last_loaded_job_id
+) {
+    auto jobs = select_pending_jobs(mysql, 0);
+    auto [guard, job_scheduler_value] = job_scheduler.get();
+    job_scheduler_value.remove_all_pending_jobs();
+    for (const auto& job : jobs) {
+        job_scheduler_value.add_pending_job(job);
+        last_loaded_job_id = std::max(last_loaded_job_id, job.id);
+    }
+    stdlog("Reloaded all pending jobs: ", job_scheduler_value.pending_jobs_num());
+}
+
+// Returns ids in the form "1, 2, 3" for use in the SQL IN (...)
+std::string sql_list_of(const std::vector<decltype(Job::id)>& job_ids) {
+    std::string res;
+    for (auto job_id : job_ids) {
+        if (!res.empty()) {
+            res += ", ";
+        }
+        res += std::to_string(job_id);
+    }
+    return res;
+}
+
 enum class CheckStatus { NO_MORE_JOBS_FOR_NOW, MAY_BE_MORE_JOBS };
 
-CheckStatus check_for_and_process_a_new_job(
+CheckStatus check_for_and_process_new_jobs(
     sim::mysql::Connection& mysql,
-    concurrent::MutexedValue<NewJobFilterBuilder>& new_job_filter_builder,
-    concurrent::BoundedQueue<Worker*>& idle_workers
+    concurrent::MutexedValue<job_server::JobScheduler>& job_scheduler,
+    concurrent::BoundedQueue<Worker*>& idle_workers,
+    job_server::Metrics& metrics
 ) {
-    stdlog("Checking for a new job...");
-    decltype(Job::id) id;
-    decltype(Job::type) type;
-    decltype(Job::aux_id) aux_id;
-    decltype(Job::aux_id_2) aux_id_2;
+    // The guard has to be destructed before waiting for an idle worker to avoid deadlock i.e.
+    // waiting for the worker to finish but the worker waits for the guard to be dropped to finish
+    // the job in the job_scheduler.
+    auto first_job = job_scheduler.get().second.start_next_job();
+    if (!first_job) {
+        stdlog("No new job to process for now.");
+        return CheckStatus::NO_MORE_JOBS_FOR_NOW;
+    }
+    auto dispatch_start = std::chrono::steady_clock::now();
+    // Start at most as many jobs as there are idle workers, so that number of in-progress jobs is
+    // not greater than the number of workers.
+    std::vector<std::pair<job_server::JobScheduler::Job, Worker*>> jobs_and_workers;
+    jobs_and_workers.emplace_back(*first_job, idle_workers.pop());
     {
-        auto [guard, new_job_filter_builder_value] = new_job_filter_builder.get();
-
-        auto stmt = mysql.execute(Select("id, type, aux_id, aux_id_2")
-                                      .from("jobs")
-                                      .where(
-                                          sim::sql::Condition("status=?", Job::Status::PENDING) &&
-                                          new_job_filter_builder_value.build_condition()
-                                      )
-                                      .order_by("priority DESC, id")
-                                      .limit("1"));
-        stmt.res_bind(id, type, aux_id, aux_id_2);
-        if (!stmt.next()) {
-            stdlog("... No new job found.");
-            return CheckStatus::NO_MORE_JOBS_FOR_NOW;
+        auto [guard, job_scheduler_value] = job_scheduler.get();
+        while (auto worker = idle_workers.try_pop()) {
+            auto job = job_scheduler_value.start_next_job();
+            if (!job) {
+                idle_workers.push(*worker);
+                break;
+            }
+            jobs_and_workers.emplace_back(*job, *worker);
+        }
+    }
+
+    std::vector<decltype(Job::id)> job_ids;
+    for (const auto& [job, worker] : jobs_and_workers) {
+        job_ids.emplace_back(job.id);
+    }
+    // Claim all the jobs at once. Some of them might have been canceled or deleted since they were
+    // loaded.
+    auto job_ids_and_status_cond = concat_tostr("id IN (", sql_list_of(job_ids), ") AND status=?");
+    auto update_stmt = mysql.execute(Update("jobs")
+                                         .set("status=?", Job::Status::IN_PROGRESS)
+                                         .where(job_ids_and_status_cond, Job::Status::PENDING));
+    std::set<decltype(Job::id)> claimed_job_ids;
+    if (update_stmt.affected_rows() == jobs_and_workers.size()) {
+        for (const auto& [job, worker] : jobs_and_workers) {
+            claimed_job_ids.emplace(job.id);
+        }
+    } else {
+        // Only the job server sets the IN_PROGRESS status
+        auto stmt = mysql.execute(
+            Select("id").from("jobs").where(job_ids_and_status_cond, Job::Status::IN_PROGRESS)
+        );
+        decltype(Job::id) job_id;
+        stmt.res_bind(job_id);
+        while (stmt.next()) {
+            claimed_job_ids.emplace(job_id);
         }
+    }
 
-        stdlog("... Found job with id: ", id);
-        new_job_filter_builder_value.add_in_progress_job(id, type, aux_id, aux_id_2);
-    } // Need to destruct the guard to avoid deadlock i.e. waiting for the worker to finish but the
-      // worker waits for the guard to be dropped to modify the new_job_filter_builder.
-    auto worker = idle_workers.pop();
-    // Set job status after we acquire a worker so that number of in-progress jobs is not greater
-    // than the number of workers.
-    mysql.execute(Update("jobs").set("status=?", Job::Status::IN_PROGRESS).where("id=?", id));
-    // Pass the job to the worker.
-    worker->task_channel.push(Task{
-        .job_id = id,
-        .job_type = type,
-        .job_aux_id = aux_id,
-        .job_aux_id_2 = aux_id_2,
-    });
+    std::vector<decltype(Job::id)> superseded_job_ids;
+    for (const auto& [job, worker] : jobs_and_workers) {
+        if (claimed_job_ids.count(job.id) == 0) {
+            stdlog("Job with id: ", job.id, " is no longer pending.");
+            idle_workers.push(worker);
+            job_scheduler.get().second.finish_job(job.id);
+            continue;
+        }
+        stdlog("Found job with id: ", job.id);
+        for (auto superseded_job_id :
+             job_scheduler.get().second.remove_pending_jobs_superseded_by(job))
+        {
+            stdlog("Job with id: ", superseded_job_id, " is superseded by job with id: ", job.id);
+            superseded_job_ids.emplace_back(superseded_job_id);
+        }
+        // Pass the job to the worker.
+        worker->task_channel.push(Task{
+            .job_id = job.id,
+            .job_type = job.type,
+            .job_aux_id = job.aux_id,
+            .job_aux_id_2 = job.aux_id_2,
+            .job_created_at = job.created_at,
+        });
+    }
+    metrics.observe_dispatch(std::chrono::steady_clock::now() - dispatch_start);
+    // Cancel the superseded jobs at once instead of processing them one by one
+    if (!superseded_job_ids.empty()) {
+        mysql.execute(
+            Update("jobs")
+                .set(
+                    "status=?, log=?",
+                    Job::Status::CANCELLED,
+                    "Cancelled because a job with the same effect was started later.\n"
+                )
+                .where(
+                    concat_tostr("id IN (", sql_list_of(superseded_job_ids), ") AND status=?"),
+                    Job::Status::PENDING
+                )
+        );
+    }
     return CheckStatus::MAY_BE_MORE_JOBS;
 }
 
@@ -429,6 +360,29 @@ void process_task(sim::mysql::Connection& mysql, const Task& task) {
     }
 }
 
+// A connected client has that much time to send Hello
+constexpr auto judge_agent_hello_timeout = std::chrono::seconds{10};
+
+// Adds the agent to the pool if it sends Hello with @p expected_secret
+void handshake_with_judge_agent(FileDescriptor agent_fd, const std::string& expected_secret) {
+    try {
+        sim::judge_agents::set_recv_timeout(agent_fd, judge_agent_hello_timeout);
+        auto msg = sim::judge_agents::recv_message(agent_fd);
+        auto* hello = std::get_if<sim::judge_agents::Hello>(&msg);
+        if (!hello) {
+            throw sim::judge_agents::ConnectionError{"expected Hello"};
+        }
+        if (!sim::judge_agents::is_correct_secret(hello->secret, expected_secret)) {
+            throw sim::judge_agents::ConnectionError{"invalid secret"};
+        }
+    } catch (const std::exception& e) {
+        errlog("Rejected a judge agent: ", e.what());
+        return;
+    }
+    stdlog("Judge agent connected");
+    job_server::job_handlers::judge_agent_pool().add_idle_agent(std::move(agent_fd));
+}
+
 } // namespace
 
 int main() {
@@ -469,7 +423,14 @@ int main() {
     // Get the number of worker threads
     ConfigFile config;
     try {
-        config.add_vars("job_server_workers");
+        config.add_vars(
+            "job_server_workers",
+            "job_server_max_judge_jobs",
+            "job_server_max_problem_package_jobs",
+            "job_server_tracee_cpus",
+            "job_server_judge_agents_address",
+            "job_server_judge_agents_secret"
+        );
         config.load_config_from_file("sim.conf");
     } catch (const std::exception& e) {
         errlog("Failed to load sim.conf: ", e.what());
@@ -481,6 +442,76 @@ int main() {
         return 1;
     }
 
+    using ResourceClass = job_server::JobScheduler::ResourceClass;
+    std::vector<std::pair<ResourceClass, size_t>> max_jobs_in_progress;
+    for (auto [var_name, resource_class] : {
+             std::pair{"job_server_max_judge_jobs", ResourceClass::JUDGE},
+             std::pair{"job_server_max_problem_package_jobs", ResourceClass::PROBLEM_PACKAGE},
+         })
+    {
+        const auto& var = config[var_name];
+        if (var.as_string().empty()) {
+            continue; // no limit
+        }
+        auto max = var.as<size_t>().value_or(0);
+        if (max < 1) {
+            errlog("sim.conf: ", var_name, " has to be empty or an integer greater than 0");
+            return 1;
+        }
+        max_jobs_in_progress.emplace_back(resource_class, max);
+    }
+
+    cpu_set_t available_cpus;
+    if (sched_getaffinity(0, sizeof(available_cpus), &available_cpus)) {
+        errlog("sched_getaffinity()", errmsg());
+        return 1;
+    }
+    for (const auto& cpus : config["job_server_tracee_cpus"].as_array()) {
+        auto cpu_ids = job_server::job_handlers::parse_cpus(cpus);
+        if (!cpu_ids) {
+            errlog("sim.conf: invalid job_server_tracee_cpus entry: ", cpus);
+            return 1;
+        }
+        // The cpuset cgroup of the job server restricts its affinity as well, so the CPUs out of
+        // it are reported here rather than as failures of every judging
+        for (auto cpu : *cpu_ids) {
+            if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &available_cpus)) {
+                errlog(
+                    "sim.conf: job_server_tracee_cpus entry ",
+                    cpus,
+                    " contains CPU ",
+                    cpu,
+                    " that is not available to the job server"
+                );
+                return 1;
+            }
+        }
+        // The tracees running at the same time within a job share the entry, so they would
+        // distort each other's runtimes if it had too few CPUs
+        auto min_cpus_num = job_server::job_handlers::judge_submission_max_concurrent_tracees();
+        if (cpu_ids->size() < min_cpus_num) {
+            errlog(
+                "sim.conf: job_server_tracee_cpus entry ",
+                cpus,
+                " has to contain at least ",
+                min_cpus_num,
+                " CPUs"
+            );
+            return 1;
+        }
+        job_server::job_handlers::tracee_cpus_pool().add_cpus(cpus);
+    }
+
+    const auto& judge_agents_address = config["job_server_judge_agents_address"].as_string();
+    const auto& judge_agents_secret = config["job_server_judge_agents_secret"].as_string();
+    if (!judge_agents_address.empty() && judge_agents_secret.empty()) {
+        errlog(
+            "sim.conf: job_server_judge_agents_secret has to be set if "
+            "job_server_judge_agents_address is set"
+        );
+        return 1;
+    }
+
     stdlog(
         "=================== Job server launched ==================="
         "\nPID: ",
@@ -500,6 +531,14 @@ int main() {
         return 1;
     }
 
+    // Spawn sandbox supervisors up front, so that the first judgments do not wait for them
+    try {
+        job_server::job_handlers::supervisor_pool().warm_up(workers_num);
+    } catch (const std::exception& e) {
+        errlog("Failed to spawn sandbox supervisors: ", e.what());
+        return 1;
+    }
+
     // Prepare workers
     auto workers = std::vector<Worker>(workers_num);
     auto idle_workers = concurrent::BoundedQueue<Worker*>(workers_num);
@@ -507,7 +546,11 @@ int main() {
         idle_workers.push(&worker);
     }
 
-    concurrent::MutexedValue<NewJobFilterBuilder> new_job_filter_builder;
+    concurrent::MutexedValue<job_server::JobScheduler> job_scheduler;
+    for (auto [resource_class, max] : max_jobs_in_progress) {
+        job_scheduler.get().second.set_max_jobs_in_progress(resource_class, max);
+    }
+    job_server::Metrics metrics{workers_num};
 
     auto worker_finished_eventfd = FileDescriptor{eventfd(0, EFD_CLOEXEC)};
     if (!worker_finished_eventfd.is_open()) {
@@ -527,8 +570,15 @@ int main() {
                     if (!task) {
                         break; // No more tasks.
                     }
+                    self->metrics->job_started(
+                        task->job_type, std::chrono::system_clock::now() - task->job_created_at
+                    );
+                    auto processing_start = std::chrono::steady_clock::now();
                     process_task(self->mysql, *task);
-                    self->new_job_filter_builder->get().second.remove_in_progress_job(task->job_id);
+                    self->metrics->job_finished(
+                        task->job_type, std::chrono::steady_clock::now() - processing_start
+                    );
+                    self->job_scheduler->get().second.finish_job(task->job_id);
                     // Signal the main thread that we became idle
                     idle_workers.push(self);
                     uint64_t val = 1;
@@ -537,10 +587,48 @@ int main() {
                     }
                 }
             }};
-        worker.new_job_filter_builder = &new_job_filter_builder;
+        worker.job_scheduler = &job_scheduler;
+        worker.metrics = &metrics;
+    }
+
+    // Remove logs of the jobs that were left in-progress by the previous invocation of the
+    // job-server, they are restarted below.
+    if (remove_r(sim::jobs::in_progress_job_logs_dir) && errno != ENOENT) {
+        errlog("remove_r()", errmsg());
+        return 1;
+    }
+    if (mkdir(sim::jobs::in_progress_job_logs_dir)) {
+        errlog("mkdir()", errmsg());
+        return 1;
+    }
+
+    const auto& judge_checkpoints_dir = job_server::job_handlers::judge_checkpoints_dir;
+    if (mkdir(judge_checkpoints_dir) && errno != EEXIST) {
+        errlog("mkdir()", errmsg());
+        return 1;
     }
 
     auto mysql = sim::mysql::Connection::from_credential_file(".db.config");
+    // Checkpoints of the jobs that were left in-progress are kept to resume judging, the rest are
+    // left by jobs that have been e.g. deleted or cancelled in the meantime.
+    {
+        std::set<std::string, std::less<>> in_progress_job_ids;
+        decltype(Job::id) job_id;
+        auto stmt = mysql.execute(
+            Select("id").from("jobs").where("status=?", Job::Status::IN_PROGRESS)
+        );
+        stmt.res_bind(job_id);
+        while (stmt.next()) {
+            in_progress_job_ids.emplace(concat_tostr(job_id));
+        }
+        for_each_dir_component(judge_checkpoints_dir, [&](dirent* entry) {
+            if (in_progress_job_ids.find(StringView{entry->d_name}) == in_progress_job_ids.end()) {
+                if (unlink(concat_tostr(judge_checkpoints_dir, entry->d_name).c_str())) {
+                    THROW("unlink()", errmsg());
+                }
+            }
+        });
+    }
     // Restart jobs that were left in-progress by the previous invocation of the job-server.
     mysql.execute(Update("jobs")
                       .set("status=?", Job::Status::PENDING)
@@ -554,16 +642,17 @@ int main() {
                                          &idle_workers,
                                          &event_queue = file_modification_monitor.event_queue(),
                                          &processing_new_jobs,
-                                         &new_job_filter_builder] {
+                                         &job_scheduler,
+                                         &metrics] {
         if (processing_new_jobs) {
             return;
         }
         processing_new_jobs = true;
         event_queue.add_repeating_handler(
             std::chrono::nanoseconds{0},
-            [&mysql, &new_job_filter_builder, &idle_workers, &processing_new_jobs] {
+            [&mysql, &job_scheduler, &idle_workers, &processing_new_jobs, &metrics] {
                 auto check_status =
-                    check_for_and_process_a_new_job(mysql, new_job_filter_builder, idle_workers);
+                    check_for_and_process_new_jobs(mysql, job_scheduler, idle_workers, metrics);
                 switch (check_status) {
                 case CheckStatus::NO_MORE_JOBS_FOR_NOW: {
                     processing_new_jobs = false;
@@ -581,14 +670,22 @@ int main() {
         sim::job_server::notify_file.to_string(), O_WRONLY | O_TRUNC | O_CREAT | O_CLOEXEC
     };
     file_modification_monitor.add_path(sim::job_server::notify_file.to_string(), true);
+    decltype(Job::id) last_loaded_job_id = 0;
     file_modification_monitor.set_event_handler([&](const std::string&) {
+        load_new_pending_jobs(mysql, job_scheduler, last_loaded_job_id);
         scheudle_processing_new_jobs();
     });
-    // Schedule processing new jobs after the notification file starts being watched in case there
-    // already are some.
+    // Load pending jobs after the notification file starts being watched in case there already
+    // are some.
+    reload_all_pending_jobs(mysql, job_scheduler, last_loaded_job_id);
     scheudle_processing_new_jobs();
-    // Schedule processing new jobs after the worker finished a job since the job filtering
-    // restriction might have relaxed and a new job may become available.
+    file_modification_monitor.event_queue().add_repeating_handler(std::chrono::seconds{10}, [&] {
+        reload_all_pending_jobs(mysql, job_scheduler, last_loaded_job_id);
+        scheudle_processing_new_jobs();
+        return repeating::CONTINUE;
+    });
+    // Schedule processing new jobs after the worker finished a job since the jobs conflicting with
+    // it may be started now.
     file_modification_monitor.event_queue()
         .add_file_handler(worker_finished_eventfd, FileEvent::READABLE, [&] {
             // First, consume the readability of the worker_finished_eventfd
@@ -599,6 +696,58 @@ int main() {
             scheudle_processing_new_jobs();
         });
 
+    // Export the metrics for the web UI and for monitoring, e.g. by the textfile collector of the
+    // Prometheus node exporter
+    auto metrics_tmp_file = concat_tostr(job_server::metrics_file, ".tmp");
+    file_modification_monitor.event_queue().add_repeating_handler(std::chrono::seconds{5}, [&] {
+        try {
+            auto pending_jobs_nums =
+                job_scheduler.get().second.pending_jobs_num_by_type_and_priority();
+            auto metrics_text = metrics.to_prometheus_text(pending_jobs_nums);
+            put_file_contents(metrics_tmp_file, metrics_text);
+            if (rename(metrics_tmp_file, job_server::metrics_file)) {
+                THROW("rename()", errmsg());
+            }
+        } catch (const std::exception& e) {
+            errlog("Failed to export the metrics: ", e.what());
+        }
+        return repeating::CONTINUE;
+    });
+
+    // Judge agents connect through the Unix socket and, if configured, through TCP
+    std::vector<FileDescriptor> judge_agents_listening_fds;
+    try {
+        auto unix_socket_address = concat_tostr("unix:", sim::judge_agents::job_server_socket_path);
+        judge_agents_listening_fds.emplace_back(
+            sim::judge_agents::listen_for_agents(unix_socket_address)
+        );
+        if (!judge_agents_address.empty()) {
+            judge_agents_listening_fds.emplace_back(
+                sim::judge_agents::listen_for_agents(judge_agents_address)
+            );
+        }
+    } catch (const std::exception& e) {
+        errlog("Failed to listen for judge agents: ", e.what());
+        return 1;
+    }
+    for (int listening_fd : judge_agents_listening_fds) {
+        file_modification_monitor.event_queue().add_file_handler(
+            listening_fd,
+            FileEvent::READABLE,
+            [listening_fd, &judge_agents_secret] {
+                auto agent_fd =
+                    FileDescriptor{accept4(listening_fd, nullptr, nullptr, SOCK_CLOEXEC)};
+                if (!agent_fd.is_open()) {
+                    errlog("accept4()", errmsg());
+                    return;
+                }
+                // In a separate thread, as a client that sends nothing would block the event loop
+                std::thread{handshake_with_judge_agent, std::move(agent_fd), judge_agents_secret}
+                    .detach();
+            }
+        );
+    }
+
     // Stop the event queue if a signal arrives
     auto sigfd = FileDescriptor{signalfd(-1, &sigset, SFD_CLOEXEC)};
     if (!sigfd.is_open()) {
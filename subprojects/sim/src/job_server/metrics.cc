@@ -0,0 +1,193 @@
+#include "job_handlers/compilation_cache.hh"
+#include "job_handlers/judge_agent_pool.hh"
+#include "job_handlers/supervisor_pool.hh"
+#include "metrics.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <sim/jobs/job.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/string_view.hh>
+#include <simlib/time_format_conversions.hh>
+#include <string>
+
+using sim::jobs::Job;
+
+namespace {
+
+void append_header(std::string& res, StringView name, StringView type, StringView help) {
+    back_insert(res, "# HELP ", name, ' ', help, "\n# TYPE ", name, ' ', type, '\n');
+}
+
+template <class T>
+void append_sample(std::string& res, StringView name, const std::string& labels, const T& value) {
+    back_insert(res, name);
+    if (!labels.empty()) {
+        back_insert(res, '{', labels, '}');
+    }
+    back_insert(res, ' ', value, '\n');
+}
+
+} // namespace
+
+namespace job_server {
+
+void Metrics::Histogram::observe(std::chrono::nanoseconds value) noexcept {
+    for (size_t i = 0; i < bucket_bounds.size(); ++i) {
+        if (value <= bucket_bounds[i]) {
+            ++bucket_counts[i];
+            break;
+        }
+    }
+    ++count;
+    sum += value;
+}
+
+void Metrics::Histogram::append_samples_to(
+    std::string& res, StringView name, std::string labels
+) const {
+    auto bucket_name = concat_tostr(name, "_bucket");
+    uint64_t cumulative_count = 0;
+    for (size_t i = 0; i < bucket_bounds.size(); ++i) {
+        cumulative_count += bucket_counts[i];
+        append_sample(
+            res,
+            bucket_name,
+            concat_tostr(labels, "le=\"", to_string(bucket_bounds[i]), '"'),
+            cumulative_count
+        );
+    }
+    append_sample(res, bucket_name, concat_tostr(labels, "le=\"+Inf\""), count);
+    // Drop the trailing comma
+    if (!labels.empty()) {
+        labels.pop_back();
+    }
+    auto sum_name = concat_tostr(name, "_sum");
+    append_sample(res, sum_name, labels, to_string(sum));
+    auto count_name = concat_tostr(name, "_count");
+    append_sample(res, count_name, labels, count);
+}
+
+void Metrics::observe_dispatch(std::chrono::nanoseconds duration) {
+    std::lock_guard lock{mutex};
+    dispatch_durations.observe(duration);
+}
+
+void Metrics::job_started(Job::Type job_type, std::chrono::nanoseconds queue_duration) {
+    std::lock_guard lock{mutex};
+    ++busy_workers_num;
+    queue_durations[job_type].observe(queue_duration);
+}
+
+void Metrics::job_finished(Job::Type job_type, std::chrono::nanoseconds processing_duration) {
+    std::lock_guard lock{mutex};
+    --busy_workers_num;
+    workers_busy_time += processing_duration;
+    processing_durations[job_type].observe(processing_duration);
+}
+
+std::string Metrics::to_prometheus_text(const PendingJobsNums& pending_jobs_nums) {
+    std::string res;
+    append_header(res, "job_server_pending_jobs", "gauge", "Jobs waiting to be processed.");
+    for (const auto& [type_and_priority, jobs_num] : pending_jobs_nums) {
+        const auto& [type, priority] = type_and_priority;
+        append_sample(
+            res,
+            "job_server_pending_jobs",
+            concat_tostr("type=", type.to_quoted_str(), ",priority=\"", int{priority}, '"'),
+            jobs_num
+        );
+    }
+
+    std::lock_guard lock{mutex};
+    append_header(res, "job_server_workers", "gauge", "Worker threads processing jobs.");
+    append_sample(res, "job_server_workers", "", workers_num);
+    append_header(res, "job_server_busy_workers", "gauge", "Workers processing a job now.");
+    append_sample(res, "job_server_busy_workers", "", busy_workers_num);
+    append_header(
+        res,
+        "job_server_workers_busy_seconds_total",
+        "counter",
+        "Time spent by the workers on the finished jobs."
+    );
+    append_sample(res, "job_server_workers_busy_seconds_total", "", to_string(workers_busy_time));
+
+    append_header(
+        res,
+        "job_server_dispatch_duration_seconds",
+        "histogram",
+        "Time from choosing jobs to start until passing them to the workers."
+    );
+    dispatch_durations.append_samples_to(res, "job_server_dispatch_duration_seconds", "");
+    append_header(
+        res,
+        "job_server_job_queue_duration_seconds",
+        "histogram",
+        "Time from the creation of the job until it started."
+    );
+    for (const auto& [type, histogram] : queue_durations) {
+        histogram.append_samples_to(
+            res,
+            "job_server_job_queue_duration_seconds",
+            concat_tostr("type=", type.to_quoted_str(), ',')
+        );
+    }
+    append_header(
+        res,
+        "job_server_job_processing_duration_seconds",
+        "histogram",
+        "Time of processing the job."
+    );
+    for (const auto& [type, histogram] : processing_durations) {
+        histogram.append_samples_to(
+            res,
+            "job_server_job_processing_duration_seconds",
+            concat_tostr("type=", type.to_quoted_str(), ',')
+        );
+    }
+
+    auto& supervisor_pool = job_handlers::supervisor_pool();
+    append_header(
+        res,
+        "job_server_sandbox_leases_total",
+        "counter",
+        "Sandbox supervisors leased from the pool."
+    );
+    append_sample(res, "job_server_sandbox_leases_total", "", supervisor_pool.leases_num());
+    append_header(
+        res, "job_server_sandbox_spawns_total", "counter", "Sandbox supervisors spawned."
+    );
+    append_sample(
+        res, "job_server_sandbox_spawns_total", "", supervisor_pool.spawned_supervisors_num()
+    );
+
+    auto& compilation_cache = job_handlers::compilation_cache();
+    append_header(
+        res,
+        "job_server_compilation_cache_hits_total",
+        "counter",
+        "Compilations avoided thanks to the compilation cache."
+    );
+    append_sample(res, "job_server_compilation_cache_hits_total", "", compilation_cache.hits_num());
+    append_header(
+        res,
+        "job_server_compilation_cache_misses_total",
+        "counter",
+        "Lookups in the compilation cache that found nothing usable."
+    );
+    append_sample(
+        res, "job_server_compilation_cache_misses_total", "", compilation_cache.misses_num()
+    );
+
+    append_header(
+        res, "job_server_idle_judge_agents", "gauge", "Connected judge agents judging nothing now."
+    );
+    append_sample(
+        res, "job_server_idle_judge_agents", "", job_handlers::judge_agent_pool().idle_agents_num()
+    );
+    return res;
+}
+
+} // namespace job_server
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <sim/jobs/job.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <utility>
+
+namespace job_server {
+
+// Instrumentation of the job server, exported in the Prometheus text format. Safe to use from
+// multiple threads.
+class Metrics {
+public:
+    class Histogram {
+    public:
+        // Jobs take from milliseconds to hours
+        static constexpr std::array<std::chrono::milliseconds, 13> bucket_bounds = {
+            std::chrono::milliseconds{10},
+            std::chrono::milliseconds{50},
+            std::chrono::milliseconds{100},
+            std::chrono::milliseconds{500},
+            std::chrono::seconds{1},
+            std::chrono::seconds{5},
+            std::chrono::seconds{10},
+            std::chrono::seconds{30},
+            std::chrono::minutes{1},
+            std::chrono::minutes{5},
+            std::chrono::minutes{15},
+            std::chrono::hours{1},
+            std::chrono::hours{6},
+        };
+
+    private:
+        std::array<uint64_t, bucket_bounds.size()> bucket_counts{}; // not cumulative
+        uint64_t count = 0;
+        std::chrono::nanoseconds sum{0};
+
+    public:
+        void observe(std::chrono::nanoseconds value) noexcept;
+
+        // @p labels are either empty or end with a comma, e.g. `type="add_problem",`
+        void append_samples_to(std::string& res, StringView name, std::string labels) const;
+    };
+
+    using PendingJobsNums =
+        std::map<std::pair<sim::jobs::Job::Type, decltype(sim::jobs::Job::priority)>, size_t>;
+
+private:
+    std::mutex mutex;
+    size_t workers_num;
+    size_t busy_workers_num = 0;
+    std::chrono::nanoseconds workers_busy_time{0}; // of the finished jobs
+    Histogram dispatch_durations;
+    std::map<sim::jobs::Job::Type, Histogram> queue_durations;
+    std::map<sim::jobs::Job::Type, Histogram> processing_durations;
+
+public:
+    explicit Metrics(size_t workers_num) noexcept : workers_num{workers_num} {}
+
+    Metrics(const Metrics&) = delete;
+    Metrics(Metrics&&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+    Metrics& operator=(Metrics&&) = delete;
+    ~Metrics() = default;
+
+    // @p duration is the time from choosing jobs to start until passing them to the workers, i.e.
+    // waiting for an idle worker and claiming the jobs in the database
+    void observe_dispatch(std::chrono::nanoseconds duration);
+
+    // @p queue_duration is the time from the creation of the job
+    void job_started(sim::jobs::Job::Type job_type, std::chrono::nanoseconds queue_duration);
+
+    void job_finished(sim::jobs::Job::Type job_type, std::chrono::nanoseconds processing_duration);
+
+    // Also exports the metrics of the sandbox supervisor pool, the compilation cache and the
+    // judge agents
+    std::string to_prometheus_text(const PendingJobsNums& pending_jobs_nums);
+};
+
+} // namespace job_server
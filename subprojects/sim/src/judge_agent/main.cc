@@ -0,0 +1,207 @@
+#include "../job_server/job_handlers/common.hh"
+#include "../job_server/job_handlers/judge_submission.hh"
+#include "../job_server/job_handlers/supervisor_pool.hh"
+
+#include <cerrno>
+#include <cstdlib>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <optional>
+#include <sim/judge_agents/protocol.hh>
+#include <simlib/am_i_root.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_info.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/logger.hh>
+#include <simlib/macros/stack_unwinding.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/string_view.hh>
+#include <simlib/temporary_file.hh>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <variant>
+
+namespace job_handlers = job_server::job_handlers;
+namespace judge_agents = sim::judge_agents;
+
+namespace {
+
+// Packages received from the job server, they are immutable, so they are kept as long as the
+// working directory
+constexpr CStringView packages_dir = "packages/";
+
+// Returns the path of the package, receiving it from the job server if it is not here yet
+std::string package_path(int sock_fd, decltype(judge_agents::JudgeTask::package_file_id) file_id) {
+    auto path = concat_tostr(packages_dir, file_id, ".zip");
+    if (path_exists(path)) {
+        return path;
+    }
+    judge_agents::send_message(sock_fd, judge_agents::PackageRequest{});
+    auto msg = judge_agents::recv_message(sock_fd);
+    auto* package = std::get_if<judge_agents::Package>(&msg);
+    if (!package) {
+        throw judge_agents::ConnectionError{"expected the package from the job server"};
+    }
+    // Save the package atomically, so that an interrupted save is not mistaken for the package
+    auto tmp_path = concat_tostr(path, ".tmp");
+    put_file_contents(tmp_path, package->contents);
+    if (rename(tmp_path.c_str(), path.c_str())) {
+        THROW("rename()", errmsg());
+    }
+    return path;
+}
+
+// Judges the solution the same way as the job server does when judging locally, see
+// job_server/job_handlers/judge_submission.hh
+void judge(int sock_fd, const judge_agents::JudgeTask& task) {
+    STACK_UNWINDING_MARK;
+
+    auto source_file = TemporaryFile{"/tmp/judge-agent-solution.XXXXXX"};
+    put_file_contents(source_file.path(), task.solution_source);
+
+    // Every message carries the logs that have not been sent yet
+    job_handlers::Logger logger;
+    job_handlers::Logger final_logger;
+    size_t sent_logs_len = 0;
+    size_t sent_final_logs_len = 0;
+    job_handlers::judge_submission(
+        {
+            .package_file_id = task.package_file_id,
+            .package_path = [&] { return package_path(sock_fd, task.package_file_id); },
+            .language = task.language,
+            .solution_path = source_file.path(),
+            .solution_compilation_time_limit = task.solution_compilation_time_limit,
+            .solution_compilation_memory_limit = task.solution_compilation_memory_limit,
+            .checker_compilation_time_limit = task.checker_compilation_time_limit,
+            .checker_compilation_memory_limit = task.checker_compilation_memory_limit,
+            .compilation_errors_max_length = task.compilation_errors_max_length,
+            .tracee_cpus = std::nullopt,
+        },
+        logger,
+        final_logger,
+        [&](const job_handlers::JudgeSubmissionCompilationResult& res, sim::JudgeWorker&) {
+            using Status = job_handlers::JudgeSubmissionCompilationResult::Status;
+            using MsgStatus = judge_agents::CompilationResult::Status;
+            auto status = [&] {
+                switch (res.status) {
+                case Status::OK: return MsgStatus::OK;
+                case Status::SOLUTION_COMPILATION_ERROR:
+                    return MsgStatus::SOLUTION_COMPILATION_ERROR;
+                case Status::CHECKER_COMPILATION_ERROR: return MsgStatus::CHECKER_COMPILATION_ERROR;
+                }
+                THROW("invalid status");
+            }();
+            judge_agents::send_message(
+                sock_fd,
+                judge_agents::CompilationResult{
+                    .status = status,
+                    .compilation_errors = res.compilation_errors,
+                    .log = logger.get_logs(),
+                }
+            );
+            sent_logs_len = logger.get_logs().size();
+        },
+        [&](const sim::JudgeReport& judge_report, bool final, bool partial) {
+            const auto& logs = (final ? final_logger : logger).get_logs();
+            auto& sent_len = final ? sent_final_logs_len : sent_logs_len;
+            judge_agents::send_message(
+                sock_fd,
+                judge_agents::JudgeReport{
+                    .final = final,
+                    .partial = partial,
+                    .report = judge_report,
+                    .log = logs.substr(sent_len),
+                }
+            );
+            sent_len = logs.size();
+        }
+    );
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        errlog(
+            "Usage: ",
+            argc > 0 ? argv[0] : "judge-agent",
+            " <working directory> <job server address>\n"
+            "Job server address formats:\n"
+            "   unix:PATH -> Unix socket at PATH, e.g. unix:/path/to/sim/.judge-agents.sock\n"
+            "   ADDR:PORT -> job_server_judge_agents_address from sim.conf\n"
+            "The working directory holds only caches, so it can be removed when the agent is not "
+            "running.\n"
+            "The environment variable SIM_JUDGE_AGENT_SECRET has to hold "
+            "job_server_judge_agents_secret from sim.conf, if it is set."
+        );
+        return 1;
+    }
+    StringView address = argv[2];
+    // Passed in the environment rather than as an argument, as the arguments are visible to all
+    // users, e.g. in ps(1)
+    const char* secret = getenv("SIM_JUDGE_AGENT_SECRET");
+
+    if (am_i_root() != AmIRoot::NO) {
+        errlog("This program should not be run as root.");
+        return 1;
+    }
+
+    if (mkdir_r(argv[1]) && errno != EEXIST) {
+        errlog("Failed to create the working directory", errmsg());
+        return 1;
+    }
+    if (chdir(argv[1])) {
+        errlog("Failed to change the working directory", errmsg());
+        return 1;
+    }
+    if (mkdir(packages_dir) && errno != EEXIST) {
+        errlog("mkdir()", errmsg());
+        return 1;
+    }
+
+    // Spawn sandbox supervisors up front, so that the first judgment does not wait for them
+    try {
+        job_handlers::supervisor_pool().warm_up(1);
+    } catch (const std::exception& e) {
+        errlog("Failed to spawn sandbox supervisors: ", e.what());
+        return 1;
+    }
+
+    for (;;) {
+        try {
+            auto sock_fd = judge_agents::connect_to_job_server(address);
+            judge_agents::send_message(
+                sock_fd, judge_agents::Hello{.secret = secret ? secret : ""}
+            );
+            stdlog("Connected to the job server");
+            for (;;) {
+                auto msg = judge_agents::recv_message(sock_fd);
+                auto* task = std::get_if<judge_agents::JudgeTask>(&msg);
+                if (!task) {
+                    throw judge_agents::ConnectionError{"expected a judge task"};
+                }
+                stdlog("Judging a solution to package ", task->package_file_id);
+                try {
+                    judge(sock_fd, *task);
+                } catch (const judge_agents::ConnectionError&) {
+                    throw;
+                } catch (const std::exception& e) {
+                    // The job server fails the job, and the agent proceeds to the next task
+                    ERRLOG_CATCH(e);
+                    judge_agents::send_message(
+                        sock_fd, judge_agents::TaskFailure{.error = e.what()}
+                    );
+                }
+            }
+        } catch (const std::exception& e) {
+            errlog("Disconnected from the job server: ", e.what());
+        }
+        // Reconnect after a while, e.g. when the job server restarts
+        std::this_thread::sleep_for(std::chrono::seconds{1});
+    }
+}
@@ -1,7 +1,16 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <optional>
 #include <sim/job_server/notify.hh>
 #include <sim/jobs/job.hh>
 #include <sim/jobs/utils.hh>
 #include <sim/sql/sql.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/macros/throw.hh>
+#include <string>
 #include <utime.h>
 
 namespace sim::jobs {
@@ -18,4 +27,20 @@ void restart_job(mysql::Connection& mysql, StringView job_id, bool notify_job_se
     }
 }
 
+std::string in_progress_job_log_path(decltype(Job::id) job_id) {
+    return concat_tostr(in_progress_job_logs_dir, job_id);
+}
+
+std::optional<std::string>
+read_in_progress_job_log(decltype(Job::id) job_id, off64_t beg, off64_t end) {
+    auto fd = FileDescriptor{in_progress_job_log_path(job_id), O_RDONLY | O_CLOEXEC};
+    if (!fd.is_open()) {
+        if (errno == ENOENT) {
+            return std::nullopt;
+        }
+        THROW("open()", errmsg());
+    }
+    return get_file_contents(fd, beg, end);
+}
+
 } // namespace sim::jobs
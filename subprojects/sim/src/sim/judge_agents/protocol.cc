@@ -0,0 +1,421 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sim/judge_agents/protocol.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/overloaded.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/socket_stream_ext.hh>
+#include <simlib/string_traits.hh>
+#include <simlib/string_transform.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <variant>
+
+namespace {
+
+class Encoder {
+    std::string buff;
+
+public:
+    template <class T, std::enable_if_t<std::is_trivial_v<T>, int> = 0>
+    void write(const T& val) {
+        buff.append(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+
+    void write(std::chrono::nanoseconds val) { write(int64_t{val.count()}); }
+
+    void write(StringView str) {
+        write(uint64_t{str.size()});
+        buff.append(str.data(), str.size());
+    }
+
+    void write(const sim::JudgeReport& report) {
+        write(uint64_t{report.groups.size()});
+        for (const auto& group : report.groups) {
+            write(uint64_t{group.tests.size()});
+            for (const auto& test : group.tests) {
+                write(StringView{test.name});
+                write(test.status);
+                write(test.runtime);
+                write(test.time_limit);
+                write(test.memory_consumed);
+                write(test.memory_limit);
+                write(StringView{test.comment});
+            }
+            write(group.score);
+            write(group.max_score);
+        }
+        write(StringView{report.judge_log});
+    }
+
+    [[nodiscard]] const std::string& encoded() const noexcept { return buff; }
+};
+
+class Decoder {
+    StringView data;
+
+public:
+    explicit Decoder(StringView data_) noexcept : data{data_} {}
+
+    template <class T, std::enable_if_t<std::is_trivial_v<T>, int> = 0>
+    T read() {
+        if (data.size() < sizeof(T)) {
+            throw sim::judge_agents::ConnectionError{"message is truncated"};
+        }
+        T val;
+        std::memcpy(&val, data.data(), sizeof(val));
+        data.remove_prefix(sizeof(val));
+        return val;
+    }
+
+    std::chrono::nanoseconds read_nanoseconds() {
+        return std::chrono::nanoseconds{read<int64_t>()};
+    }
+
+    std::string read_string() {
+        auto len = read<uint64_t>();
+        if (data.size() < len) {
+            throw sim::judge_agents::ConnectionError{"message is truncated"};
+        }
+        return data.extract_prefix(len).to_string();
+    }
+
+    // Reads the number of elements that follow, each taking at least @p min_element_size bytes, so
+    // that a malformed count cannot make the receiver allocate memory for that many elements
+    uint64_t read_count(size_t min_element_size) {
+        auto count = read<uint64_t>();
+        if (count > data.size() / min_element_size) {
+            throw sim::judge_agents::ConnectionError{"message is truncated"};
+        }
+        return count;
+    }
+
+    sim::JudgeReport read_judge_report() {
+        // name, status, runtime, time_limit, memory_consumed, memory_limit, comment
+        constexpr size_t min_test_size = sizeof(uint64_t) + sizeof(sim::JudgeReport::Test::Status) +
+            sizeof(int64_t) * 2 + sizeof(uint64_t) * 2 + sizeof(uint64_t);
+        // tests_num, score, max_score
+        constexpr size_t min_group_size = sizeof(uint64_t) + sizeof(int64_t) * 2;
+        sim::JudgeReport report;
+        report.groups.resize(read_count(min_group_size));
+        for (auto& group : report.groups) {
+            auto tests_num = read_count(min_test_size);
+            group.tests.reserve(tests_num);
+            for (uint64_t i = 0; i < tests_num; ++i) {
+                auto name = read_string();
+                auto status = read<sim::JudgeReport::Test::Status>();
+                if (status > sim::JudgeReport::Test::SKIPPED) {
+                    throw sim::judge_agents::ConnectionError{"invalid test status"};
+                }
+                auto runtime = read_nanoseconds();
+                auto time_limit = read_nanoseconds();
+                auto memory_consumed = read<uint64_t>();
+                auto memory_limit = read<uint64_t>();
+                group.tests.emplace_back(
+                    std::move(name),
+                    status,
+                    runtime,
+                    time_limit,
+                    memory_consumed,
+                    memory_limit,
+                    read_string()
+                );
+            }
+            group.score = read<int64_t>();
+            group.max_score = read<int64_t>();
+        }
+        report.judge_log = read_string();
+        return report;
+    }
+
+    void finish() const {
+        if (!data.empty()) {
+            throw sim::judge_agents::ConnectionError{"unexpected data at the end of the message"};
+        }
+    }
+};
+
+// The switch makes the compiler warn about (-Wswitch) a language added but not handled here
+bool is_valid_solution_language(sim::SolutionLanguage lang) noexcept {
+    // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
+    switch (lang) {
+    case sim::SolutionLanguage::UNKNOWN: return false;
+    case sim::SolutionLanguage::C11:
+    case sim::SolutionLanguage::C23:
+    case sim::SolutionLanguage::CPP11:
+    case sim::SolutionLanguage::CPP14:
+    case sim::SolutionLanguage::CPP17:
+    case sim::SolutionLanguage::CPP20:
+    case sim::SolutionLanguage::CPP23:
+    case sim::SolutionLanguage::PASCAL:
+    case sim::SolutionLanguage::PYTHON:
+    case sim::SolutionLanguage::RUST: return true;
+    }
+    return false;
+}
+
+} // namespace
+
+namespace sim::judge_agents {
+
+// Every message is sent as: the index of its type in Message (uint8_t), the payload length
+// (uint64_t), the payload
+void send_message(int sock_fd, const Message& msg) {
+    Encoder enc;
+    std::visit(
+        overloaded{
+            [&](const JudgeTask& task) {
+                enc.write(task.package_file_id);
+                enc.write(task.language);
+                enc.write(StringView{task.solution_source});
+                enc.write(task.solution_compilation_time_limit);
+                enc.write(task.solution_compilation_memory_limit);
+                enc.write(task.checker_compilation_time_limit);
+                enc.write(task.checker_compilation_memory_limit);
+                enc.write(task.compilation_errors_max_length);
+            },
+            [&](const PackageRequest& /**/) {},
+            [&](const Package& package) { enc.write(StringView{package.contents}); },
+            [&](const CompilationResult& res) {
+                enc.write(res.status);
+                enc.write(StringView{res.compilation_errors});
+                enc.write(StringView{res.log});
+            },
+            [&](const JudgeReport& report) {
+                enc.write(uint8_t{report.final});
+                enc.write(uint8_t{report.partial});
+                enc.write(report.report);
+                enc.write(StringView{report.log});
+            },
+            [&](const TaskFailure& failure) { enc.write(StringView{failure.error}); },
+            [&](const Hello& hello) { enc.write(StringView{hello.secret}); },
+        },
+        msg
+    );
+    const auto& payload = enc.encoded();
+    if (payload.size() > max_message_payload_len) {
+        throw ConnectionError{concat_tostr("message is too big: ", payload.size(), " bytes")};
+    }
+    // MSG_MORE makes the header and the payload go in the same TCP segment if possible
+    if (send_as_bytes(
+            sock_fd,
+            MSG_NOSIGNAL | MSG_MORE,
+            static_cast<uint8_t>(msg.index()),
+            uint64_t{payload.size()}
+        ) ||
+        send_exact(sock_fd, payload.data(), payload.size(), MSG_NOSIGNAL))
+    {
+        throw ConnectionError{concat_tostr("send()", errmsg())};
+    }
+}
+
+Message recv_message(int sock_fd) {
+    uint8_t type = 0;
+    uint64_t payload_len = 0;
+    auto throw_recv_error = [] {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            throw ConnectionError{"timed out waiting for a message"};
+        }
+        throw ConnectionError{concat_tostr("recv()", errmsg())};
+    };
+    if (recv_bytes_as(sock_fd, 0, type, payload_len)) {
+        throw_recv_error();
+    }
+    if (payload_len > max_message_payload_len) {
+        throw ConnectionError{concat_tostr("message is too big: ", payload_len, " bytes")};
+    }
+    std::string payload(payload_len, '\0');
+    if (recv_exact(sock_fd, payload.data(), payload.size(), 0)) {
+        throw_recv_error();
+    }
+
+    Decoder dec{payload};
+    auto msg = [&]() -> Message {
+        switch (type) {
+        case 0: {
+            JudgeTask task;
+            task.package_file_id = dec.read<uint64_t>();
+            task.language = dec.read<SolutionLanguage>();
+            if (!is_valid_solution_language(task.language)) {
+                throw ConnectionError{"invalid solution language"};
+            }
+            task.solution_source = dec.read_string();
+            task.solution_compilation_time_limit = dec.read_nanoseconds();
+            task.solution_compilation_memory_limit = dec.read<uint64_t>();
+            task.checker_compilation_time_limit = dec.read_nanoseconds();
+            task.checker_compilation_memory_limit = dec.read<uint64_t>();
+            task.compilation_errors_max_length = dec.read<uint64_t>();
+            return task;
+        }
+        case 1: return PackageRequest{};
+        case 2: return Package{.contents = dec.read_string()};
+        case 3: {
+            CompilationResult res;
+            res.status = dec.read<CompilationResult::Status>();
+            if (res.status > CompilationResult::Status::CHECKER_COMPILATION_ERROR) {
+                throw ConnectionError{"invalid compilation status"};
+            }
+            res.compilation_errors = dec.read_string();
+            res.log = dec.read_string();
+            return res;
+        }
+        case 4: {
+            JudgeReport report;
+            report.final = dec.read<uint8_t>() != 0;
+            report.partial = dec.read<uint8_t>() != 0;
+            report.report = dec.read_judge_report();
+            report.log = dec.read_string();
+            return report;
+        }
+        case 5: return TaskFailure{.error = dec.read_string()};
+        case 6: return Hello{.secret = dec.read_string()};
+        }
+        throw ConnectionError{concat_tostr("invalid message type: ", int{type})};
+    }();
+    dec.finish();
+    return msg;
+}
+
+bool is_correct_secret(StringView secret, StringView expected_secret) noexcept {
+    // Only the length of the expected secret leaks
+    unsigned char diff = secret.size() != expected_secret.size();
+    for (size_t i = 0; i < expected_secret.size(); ++i) {
+        diff |= static_cast<unsigned char>(
+            (i < secret.size() ? secret[i] : ~expected_secret[i]) ^ expected_secret[i]
+        );
+    }
+    return diff == 0;
+}
+
+void set_recv_timeout(int sock_fd, std::chrono::nanoseconds timeout) {
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timeval tv = {
+        .tv_sec = secs.count(),
+        .tv_usec = std::chrono::duration_cast<std::chrono::microseconds>(timeout - secs).count(),
+    };
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv))) {
+        THROW("setsockopt()", errmsg());
+    }
+}
+
+namespace {
+
+struct SocketAddress {
+    union {
+        sockaddr addr;
+        sockaddr_un unix_addr;
+        sockaddr_in inet_addr;
+    };
+    socklen_t len;
+};
+
+SocketAddress parse_address(StringView address, bool listening) {
+    SocketAddress res{};
+    constexpr StringView unix_prefix = "unix:";
+    if (has_prefix(address, unix_prefix)) {
+        auto path = address.substring(unix_prefix.size());
+        if (path.empty() || path.size() >= sizeof(res.unix_addr.sun_path)) {
+            THROW("invalid Unix socket path: ", path);
+        }
+        res.unix_addr.sun_family = AF_UNIX;
+        std::memcpy(res.unix_addr.sun_path, path.data(), path.size());
+        res.len = sizeof(res.unix_addr);
+        return res;
+    }
+
+    auto colon_pos = address.rfind(':');
+    if (colon_pos == StringView::npos) {
+        THROW("missing port in address: ", address);
+    }
+    auto port = str2num<in_port_t>(address.substring(colon_pos + 1));
+    if (!port) {
+        THROW("invalid port in address: ", address);
+    }
+    res.inet_addr.sin_family = AF_INET;
+    res.inet_addr.sin_port = htons(*port);
+    auto addr = address.substring(0, colon_pos).to_string();
+    if (listening && addr == "*") {
+        res.inet_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    } else if (inet_aton(addr.c_str(), &res.inet_addr.sin_addr) == 0) {
+        THROW("invalid IPv4 address in address: ", address);
+    }
+    res.len = sizeof(res.inet_addr);
+    return res;
+}
+
+// Detects the other side on a crashed or unreachable machine within two minutes
+void enable_keepalive(int sock_fd) {
+    int true_ = 1;
+    int keepalive_idle_secs = 60;
+    int keepalive_intvl_secs = 10;
+    int keepalive_probes_num = 6;
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_KEEPALIVE, &true_, sizeof(true_)) ||
+        setsockopt(sock_fd, IPPROTO_TCP, TCP_KEEPIDLE, &keepalive_idle_secs, sizeof(int)) ||
+        setsockopt(sock_fd, IPPROTO_TCP, TCP_KEEPINTVL, &keepalive_intvl_secs, sizeof(int)) ||
+        setsockopt(sock_fd, IPPROTO_TCP, TCP_KEEPCNT, &keepalive_probes_num, sizeof(int)))
+    {
+        THROW("setsockopt()", errmsg());
+    }
+}
+
+} // namespace
+
+FileDescriptor listen_for_agents(StringView address) {
+    auto sock_addr = parse_address(address, true);
+    auto sock_fd = FileDescriptor{socket(sock_addr.addr.sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (!sock_fd.is_open()) {
+        THROW("socket()", errmsg());
+    }
+    if (sock_addr.addr.sa_family == AF_UNIX) {
+        // Remove the socket left by the previous instance
+        if (unlink(sock_addr.unix_addr.sun_path) && errno != ENOENT) {
+            THROW("unlink()", errmsg());
+        }
+    } else {
+        int true_ = 1;
+        if (setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, &true_, sizeof(true_))) {
+            THROW("setsockopt()", errmsg());
+        }
+        // Accepted sockets inherit the keepalive options
+        enable_keepalive(sock_fd);
+    }
+    if (bind(sock_fd, &sock_addr.addr, sock_addr.len)) {
+        THROW("bind()", errmsg());
+    }
+    if (listen(sock_fd, 64)) {
+        THROW("listen()", errmsg());
+    }
+    return sock_fd;
+}
+
+FileDescriptor connect_to_job_server(StringView address) {
+    auto sock_addr = parse_address(address, false);
+    auto sock_fd = FileDescriptor{socket(sock_addr.addr.sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (!sock_fd.is_open()) {
+        THROW("socket()", errmsg());
+    }
+    if (sock_addr.addr.sa_family == AF_INET) {
+        enable_keepalive(sock_fd);
+    }
+    if (connect(sock_fd, &sock_addr.addr, sock_addr.len)) {
+        THROW("connect()", errmsg());
+    }
+    return sock_fd;
+}
+
+} // namespace sim::judge_agents
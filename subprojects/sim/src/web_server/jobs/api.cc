@@ -7,6 +7,7 @@
 #include <optional>
 #include <sim/contest_users/contest_user.hh>
 #include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
 #include <sim/problems/problem.hh>
 #include <sim/sql/sql.hh>
 #include <sim/submissions/submission.hh>
@@ -16,6 +17,7 @@
 #include <simlib/json_str/json_str.hh>
 #include <simlib/macros/stack_unwinding.hh>
 #include <simlib/throw_assert.hh>
+#include <utility>
 
 using sim::contest_users::ContestUser;
 using sim::jobs::Job;
@@ -646,6 +648,11 @@ Response view_job(Context& ctx, decltype(Job::id) job_id) {
     json_str::Object obj;
     j.append_to(obj, caps);
     if (caps.view_log) {
+        if (j.status == Job::Status::IN_PROGRESS) {
+            if (auto in_progress_job_log = sim::jobs::read_in_progress_job_log(job_id)) {
+                job_log = std::move(*in_progress_job_log);
+            }
+        }
         obj.prop("log", job_log);
     }
     return ctx.response_json(std::move(obj).into_str());
@@ -4,6 +4,7 @@
 
 #include <simlib/file_contents.hh>
 #include <simlib/file_descriptor.hh>
+#include <simlib/file_info.hh>
 
 using sim::users::User;
 
@@ -77,6 +78,9 @@ void Sim::api_handle() {
     if (next_arg == "jobs") {
         return api_jobs();
     }
+    if (next_arg == "job_server_metrics") {
+        return api_job_server_metrics();
+    }
     if (next_arg == "logs") {
         return api_logs();
     }
@@ -95,6 +99,19 @@ void Sim::api_handle() {
     return api_error404();
 }
 
+void Sim::api_job_server_metrics() {
+    STACK_UNWINDING_MARK;
+
+    if (not session.has_value() || session->user_type != User::Type::ADMIN) {
+        return api_error403();
+    }
+    // The job server exports the metrics after it starts
+    if (!path_exists(job_server::metrics_file)) {
+        return api_error404();
+    }
+    append(get_file_contents(job_server::metrics_file));
+}
+
 void Sim::api_logs() {
     STACK_UNWINDING_MARK;
 
@@ -1,5 +1,6 @@
 #include "sim.hh"
 
+#include <optional>
 #include <sim/change_problem_statement_jobs/change_problem_statement_job.hh>
 #include <sim/internal_files/internal_file.hh>
 #include <sim/jobs/job.hh>
@@ -8,7 +9,9 @@
 #include <simlib/path.hh>
 #include <simlib/time.hh>
 #include <simlib/time_format_conversions.hh>
+#include <string>
 #include <type_traits>
+#include <utility>
 
 using sim::jobs::OldJob;
 using sim::problems::OldProblem;
@@ -419,11 +422,21 @@ void Sim::api_jobs() {
 
         // Append log view (whether there is more to load, log)
         if (select_specified_job and uint(perms & PERM::DOWNLOAD_LOG)) {
+            std::optional<std::string> in_progress_job_log;
+            if (job_status == OldJob::Status::IN_PROGRESS) {
+                in_progress_job_log = sim::jobs::read_in_progress_job_log(
+                    WONT_THROW(str2num<decltype(OldJob::id)>(res[JID]).value()),
+                    0,
+                    sim::jobs::job_log_view_max_size + 1
+                );
+            }
+            auto log_view =
+                in_progress_job_log ? StringView{*in_progress_job_log} : res[JOB_LOG_VIEW];
             append(
                 ",[",
-                res[JOB_LOG_VIEW].size() > sim::jobs::job_log_view_max_size,
+                log_view.size() > sim::jobs::job_log_view_max_size,
                 ',',
-                json_stringify(res[JOB_LOG_VIEW]),
+                json_stringify(log_view),
                 ']'
             );
         }
@@ -551,6 +564,11 @@ void Sim::api_job_download_log() {
         concat_tostr("attachment; filename=job-", jobs_jid, "-log");
 
     // Fetch the log
+    auto job_id = WONT_THROW(str2num<decltype(OldJob::id)>(jobs_jid).value());
+    if (auto in_progress_job_log = sim::jobs::read_in_progress_job_log(job_id)) {
+        resp.content = std::move(*in_progress_job_log);
+        return;
+    }
     auto old_mysql = old_mysql::ConnectionView{mysql};
     auto stmt = old_mysql.prepare("SELECT log FROM jobs WHERE id=?");
     stmt.bind_and_execute(jobs_jid);
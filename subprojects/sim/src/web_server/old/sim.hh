@@ -88,6 +88,8 @@ class Sim final {
     // api.cc
     void api_handle();
 
+    void api_job_server_metrics();
+
     void api_logs();
 
     // jobs_api.cc
@@ -3790,6 +3790,48 @@ function Logs(type, elem, auto_refresh_checkbox) {
 
 	this.fetch_more();
 }
+function JobServerMetrics(elem, auto_refresh_checkbox) {
+	elem = $(elem);
+	var lock = false; // allow only manual unlocking
+
+	var fetch = function() {
+		if (lock)
+			return;
+		lock = true;
+
+		append_oldloader(elem[0]);
+		$.ajax({
+			url: '/api/job_server_metrics',
+			type: 'POST',
+			processData: false,
+			contentType: false,
+			data: new FormData(add_csrf_token_to($('<form>')).get(0)),
+			success: function(data) {
+				remove_oldloader(elem[0]);
+				elem.text(String(data));
+				lock = false;
+			},
+			error: function(resp, status) {
+				show_error_via_oldloader(elem, resp, status, function() {
+					lock = false; // allow only manual unlocking
+					fetch();
+				});
+			}
+		});
+	};
+
+	// The job server exports the metrics every 5 seconds
+	var refreshing_interval_id = setInterval(function() {
+		if (!$.contains(document.documentElement, elem[0])) {
+			clearInterval(refreshing_interval_id);
+			return;
+		}
+		if (auto_refresh_checkbox.prop('checked'))
+			fetch();
+	}, 5000);
+
+	fetch();
+}
 function tab_logs_view(parent_elem) {
 	// Select job server log by default
 	if (old_url_hash_parser.next_arg() === '')
@@ -3817,12 +3859,34 @@ function tab_logs_view(parent_elem) {
 		parent_elem.addClass('logs-parent');
 		new Logs(log_type, $('<pre>', {class: 'logs'}).appendTo(parent_elem), checkbox).monitor_scroll();
 	}
+	function metrics_tab() {
+		var checkbox = $('<input>', {
+			type: 'checkbox',
+			checked: true
+		});
+
+		$('<div>', {
+			class: 'logs-header',
+			html: [
+				$('<h2>', {text: "Job server's metrics:"}),
+				$('<div>', {html:
+					$('<label>', {html: [
+						checkbox, 'auto-refresh'
+					]})
+				})
+			]
+		}).appendTo(parent_elem);
+
+		parent_elem.addClass('logs-parent');
+		new JobServerMetrics($('<pre>', {class: 'logs'}).appendTo(parent_elem), checkbox);
+	}
 
 	var tabs = [
 		'Server (web)', retab.bind(null, 'web', "Server's"),
 		'Server error (web)', retab.bind(null, 'web_err', "Server's error"),
 		'Job server', retab.bind(null, 'jobs', "Job server's"),
-		'Job server error', retab.bind(null, 'jobs_err', "Job server's error")
+		'Job server error', retab.bind(null, 'jobs_err', "Job server's error"),
+		'Job server metrics', metrics_tab
 	];
 
 	old_tabmenu(default_tabmenu_attacher.bind(parent_elem), tabs);
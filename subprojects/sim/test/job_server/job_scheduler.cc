@@ -0,0 +1,376 @@
+#include "../../src/job_server/job_scheduler.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <optional>
+#include <sim/jobs/job.hh>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using job_server::JobScheduler;
+using JT = sim::jobs::Job::Type;
+
+namespace {
+
+JobScheduler::Job
+judge_job(uint64_t id, uint64_t submission_id, uint8_t priority = 5, uint64_t creator = 1) {
+    return {
+        .id = id,
+        .creator = creator,
+        .type = JT::JUDGE_SUBMISSION,
+        .priority = priority,
+        .aux_id = submission_id,
+        .aux_id_2 = std::nullopt,
+        .created_at = {},
+    };
+}
+
+JobScheduler::Job problem_job(
+    uint64_t id, JT type, uint64_t problem_id, std::optional<uint64_t> problem_id_2 = std::nullopt
+) {
+    return {
+        .id = id,
+        .creator = 1,
+        .type = type,
+        .priority = 5,
+        .aux_id = problem_id,
+        .aux_id_2 = problem_id_2,
+        .created_at = {},
+    };
+}
+
+std::optional<uint64_t> start_next_job_id(JobScheduler& scheduler) {
+    auto job = scheduler.start_next_job();
+    if (!job) {
+        return std::nullopt;
+    }
+    return job->id;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, conflicting_jobs_are_not_in_progress_at_the_same_time) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 7));
+    scheduler.add_pending_job(judge_job(2, 7));
+    scheduler.add_pending_job(problem_job(3, JT::EDIT_PROBLEM, 9));
+    scheduler.add_pending_job(problem_job(4, JT::MERGE_PROBLEMS, 9, 10));
+    scheduler.add_pending_job(problem_job(5, JT::DELETE_PROBLEM, 10));
+    EXPECT_EQ(scheduler.pending_jobs_num(), 5);
+
+    EXPECT_EQ(start_next_job_id(scheduler), 1);
+    EXPECT_EQ(start_next_job_id(scheduler), 3);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt); // 2 waits for 1, 4 for 3, 5 for 4
+    EXPECT_EQ(scheduler.pending_jobs_num(), 3);
+
+    scheduler.finish_job(3);
+    EXPECT_EQ(start_next_job_id(scheduler), 4);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt); // 5 still waits for 4
+    scheduler.finish_job(4);
+    EXPECT_EQ(start_next_job_id(scheduler), 5);
+    scheduler.finish_job(1);
+    EXPECT_EQ(start_next_job_id(scheduler), 2);
+    EXPECT_EQ(scheduler.pending_jobs_num(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, job_added_during_conflicting_job_waits_for_it) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 7));
+    EXPECT_EQ(start_next_job_id(scheduler), 1);
+    scheduler.add_pending_job(judge_job(2, 7));
+    scheduler.add_pending_job(judge_job(1, 7)); // already in progress
+    EXPECT_EQ(scheduler.pending_jobs_num(), 1);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt);
+    scheduler.finish_job(1);
+    EXPECT_EQ(start_next_job_id(scheduler), 2);
+    EXPECT_THROW(scheduler.finish_job(1), std::runtime_error);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, removed_jobs_are_not_started) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 7));
+    scheduler.add_pending_job(judge_job(2, 7));
+    scheduler.add_pending_job(judge_job(3, 8));
+    scheduler.remove_pending_job(3);
+    scheduler.remove_pending_job(42); // not pending
+    EXPECT_EQ(start_next_job_id(scheduler), 1);
+    scheduler.remove_pending_job(2); // blocked by 1
+    scheduler.finish_job(1);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt);
+    EXPECT_EQ(scheduler.pending_jobs_num(), 0);
+
+    scheduler.add_pending_job(judge_job(4, 7));
+    scheduler.add_pending_job(judge_job(5, 8));
+    scheduler.remove_all_pending_jobs();
+    EXPECT_EQ(scheduler.pending_jobs_num(), 0);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, removes_superseded_jobs) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 7));
+    scheduler.add_pending_job(judge_job(2, 7));
+    scheduler.add_pending_job({
+        .id = 3,
+        .creator = 1,
+        .type = JT::REJUDGE_SUBMISSION,
+        .priority = 5,
+        .aux_id = 7,
+        .aux_id_2 = std::nullopt,
+        .created_at = {},
+    });
+    scheduler.add_pending_job(judge_job(4, 8));
+    auto job = scheduler.start_next_job();
+    ASSERT_TRUE(job);
+    EXPECT_EQ(job->id, 1);
+    EXPECT_EQ(scheduler.remove_pending_jobs_superseded_by(*job), (std::vector<uint64_t>{2, 3}));
+    EXPECT_EQ(scheduler.pending_jobs_num(), 1);
+    EXPECT_EQ(start_next_job_id(scheduler), 4);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, does_not_remove_jobs_that_have_to_run_in_between) {
+    JobScheduler scheduler;
+    constexpr auto reset_time_limits = JT::RESET_PROBLEM_TIME_LIMITS_USING_MODEL_SOLUTION;
+    scheduler.add_pending_job(problem_job(1, reset_time_limits, 9));
+    scheduler.add_pending_job(problem_job(2, JT::REUPLOAD_PROBLEM, 9));
+    scheduler.add_pending_job(problem_job(3, reset_time_limits, 9));
+    auto job = scheduler.start_next_job();
+    ASSERT_TRUE(job);
+    EXPECT_EQ(job->id, 1);
+    EXPECT_EQ(scheduler.remove_pending_jobs_superseded_by(*job), std::vector<uint64_t>{});
+    EXPECT_EQ(scheduler.pending_jobs_num(), 2);
+
+    // Jobs that are not coalesced supersede nothing
+    scheduler.finish_job(1);
+    job = scheduler.start_next_job();
+    ASSERT_TRUE(job);
+    EXPECT_EQ(job->id, 2);
+    EXPECT_EQ(scheduler.remove_pending_jobs_superseded_by(*job), std::vector<uint64_t>{});
+    EXPECT_EQ(scheduler.pending_jobs_num(), 1);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, higher_priority_jobs_go_first) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 1, 1));
+    scheduler.add_pending_job(judge_job(2, 2, 9));
+    scheduler.add_pending_job(judge_job(3, 3, 5));
+    scheduler.add_pending_job(judge_job(4, 4, 9));
+    EXPECT_EQ(start_next_job_id(scheduler), 2);
+    EXPECT_EQ(start_next_job_id(scheduler), 4);
+    EXPECT_EQ(start_next_job_id(scheduler), 3);
+    EXPECT_EQ(start_next_job_id(scheduler), 1);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, blocked_higher_priority_job_does_not_block_lower_priority_ones) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 7, 9));
+    EXPECT_EQ(start_next_job_id(scheduler), 1);
+    scheduler.add_pending_job(judge_job(2, 7, 9));
+    scheduler.add_pending_job(judge_job(3, 8, 1));
+    EXPECT_EQ(start_next_job_id(scheduler), 3);
+    scheduler.finish_job(1);
+    EXPECT_EQ(start_next_job_id(scheduler), 2);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, counts_pending_jobs_by_type_and_priority) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(judge_job(1, 7, 5));
+    scheduler.add_pending_job(judge_job(2, 8, 5));
+    scheduler.add_pending_job(judge_job(3, 9, 6));
+    scheduler.add_pending_job(problem_job(4, JT::EDIT_PROBLEM, 9));
+    EXPECT_EQ(
+        scheduler.pending_jobs_num_by_type_and_priority(),
+        (std::map<std::pair<JT, uint8_t>, size_t>{
+            {{JT::JUDGE_SUBMISSION, 5}, 2},
+            {{JT::JUDGE_SUBMISSION, 6}, 1},
+            {{JT::EDIT_PROBLEM, 5}, 1},
+        })
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, creators_take_turns) {
+    JobScheduler scheduler;
+    for (uint64_t id = 1; id <= 4; ++id) {
+        scheduler.add_pending_job(judge_job(id, id, 5, 1));
+    }
+    scheduler.add_pending_job(judge_job(5, 5, 5, 2));
+    scheduler.add_pending_job(judge_job(6, 6, 5, 2));
+    scheduler.add_pending_job({
+        .id = 7,
+        .creator = std::nullopt,
+        .type = JT::JUDGE_SUBMISSION,
+        .priority = 5,
+        .aux_id = 7,
+        .aux_id_2 = std::nullopt,
+        .created_at = {},
+    });
+    std::vector<uint64_t> started_ids;
+    while (auto job_id = start_next_job_id(scheduler)) {
+        started_ids.emplace_back(*job_id);
+    }
+    EXPECT_EQ(started_ids, (std::vector<uint64_t>{1, 5, 7, 2, 6, 3, 4}));
+}
+
+namespace {
+
+// Starts and finishes @p jobs_num jobs, reloading the pending jobs before each one if
+// @p reload_pending_jobs is true (like the job server does periodically)
+std::vector<uint64_t> process_jobs(
+    JobScheduler& scheduler,
+    std::vector<JobScheduler::Job> pending_jobs,
+    size_t jobs_num,
+    bool reload_pending_jobs
+) {
+    for (const auto& job : pending_jobs) {
+        scheduler.add_pending_job(job);
+    }
+    std::vector<uint64_t> started_ids;
+    for (size_t i = 0; i < jobs_num; ++i) {
+        if (reload_pending_jobs) {
+            scheduler.remove_all_pending_jobs();
+            for (const auto& job : pending_jobs) {
+                scheduler.add_pending_job(job);
+            }
+        }
+        auto job = scheduler.start_next_job();
+        if (!job) {
+            break;
+        }
+        started_ids.emplace_back(job->id);
+        scheduler.finish_job(job->id);
+        pending_jobs.erase(std::find_if(pending_jobs.begin(), pending_jobs.end(), [&](auto& pj) {
+            return pj.id == job->id;
+        }));
+    }
+    return started_ids;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, creators_take_turns_across_reloads) {
+    std::vector<JobScheduler::Job> pending_jobs;
+    for (uint64_t id = 1; id <= 4; ++id) {
+        pending_jobs.emplace_back(judge_job(id, id, 5, 1));
+    }
+    pending_jobs.emplace_back(judge_job(5, 5, 5, 2));
+    pending_jobs.emplace_back(judge_job(6, 6, 5, 2));
+    for (bool reload_pending_jobs : {false, true}) {
+        JobScheduler scheduler;
+        EXPECT_EQ(
+            process_jobs(scheduler, pending_jobs, pending_jobs.size(), reload_pending_jobs),
+            (std::vector<uint64_t>{1, 5, 2, 6, 3, 4})
+        ) << reload_pending_jobs;
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, lower_priority_jobs_age) {
+    std::vector<JobScheduler::Job> pending_jobs;
+    constexpr uint64_t high_priority_jobs_num = JobScheduler::aging_threshold * 2 + 10;
+    for (uint64_t id = 1; id <= high_priority_jobs_num; ++id) {
+        pending_jobs.emplace_back(judge_job(id, id, 5));
+    }
+    pending_jobs.emplace_back(judge_job(1001, 1001, 4));
+    pending_jobs.emplace_back(judge_job(1002, 1002, 4));
+    pending_jobs.emplace_back(judge_job(1003, 1003, 4));
+
+    for (bool reload_pending_jobs : {false, true}) {
+        JobScheduler scheduler;
+        auto started_ids =
+            process_jobs(scheduler, pending_jobs, pending_jobs.size(), reload_pending_jobs);
+        ASSERT_EQ(started_ids.size(), pending_jobs.size());
+        // The lower priority class gets every aging_threshold-th turn
+        std::vector<size_t> low_priority_positions;
+        for (size_t i = 0; i < started_ids.size(); ++i) {
+            if (started_ids[i] > 1000) {
+                low_priority_positions.emplace_back(i);
+            }
+        }
+        constexpr auto threshold = JobScheduler::aging_threshold;
+        EXPECT_EQ(
+            low_priority_positions,
+            (std::vector<size_t>{threshold - 1, threshold * 2 - 1, started_ids.size() - 1})
+        ) << reload_pending_jobs;
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, aging_survives_priority_class_having_no_startable_jobs) {
+    JobScheduler scheduler;
+    for (uint64_t id = 1; id <= JobScheduler::aging_threshold * 2; ++id) {
+        scheduler.add_pending_job(judge_job(id, id, 5));
+    }
+    scheduler.add_pending_job(judge_job(1001, 1001, 4));
+    for (size_t i = 0; i < JobScheduler::aging_threshold - 1; ++i) {
+        auto job_id = start_next_job_id(scheduler);
+        ASSERT_TRUE(job_id);
+        EXPECT_LT(*job_id, 1000);
+        scheduler.finish_job(*job_id);
+    }
+    // For a moment, the lower priority has no startable jobs
+    scheduler.remove_pending_job(1001);
+    scheduler.add_pending_job(judge_job(1001, 1001, 4));
+    EXPECT_EQ(start_next_job_id(scheduler), 1001);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, conflicting_pending_jobs_start_in_order_of_ids) {
+    JobScheduler scheduler;
+    // Creator 1 has had their turn after creator 2, so creator 2 goes first now
+    scheduler.add_pending_job(judge_job(1, 100, 5, 2));
+    scheduler.add_pending_job(judge_job(2, 101, 5, 1));
+    ASSERT_EQ(start_next_job_id(scheduler), 1);
+    ASSERT_EQ(start_next_job_id(scheduler), 2);
+    scheduler.finish_job(1);
+    scheduler.finish_job(2);
+
+    scheduler.add_pending_job(problem_job(3, JT::REUPLOAD_PROBLEM, 7));
+    auto change_statement = problem_job(4, JT::CHANGE_PROBLEM_STATEMENT, 7);
+    change_statement.creator = 2;
+    scheduler.add_pending_job(change_statement);
+    auto unrelated = problem_job(5, JT::CHANGE_PROBLEM_STATEMENT, 8);
+    unrelated.creator = 2;
+    scheduler.add_pending_job(unrelated);
+
+    EXPECT_EQ(start_next_job_id(scheduler), 5);
+    EXPECT_EQ(start_next_job_id(scheduler), 3);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt); // 4 waits for 3
+    scheduler.finish_job(3);
+    EXPECT_EQ(start_next_job_id(scheduler), 4);
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_JobScheduler, earlier_conflicting_pending_job_blocks_later_ones) {
+    JobScheduler scheduler;
+    scheduler.add_pending_job(problem_job(3, JT::EDIT_PROBLEM, 7));
+    // Added later, but goes first as it has a lower id
+    scheduler.add_pending_job(problem_job(2, JT::DELETE_PROBLEM, 7));
+    scheduler.add_pending_job(problem_job(5, JT::MERGE_PROBLEMS, 9, 7));
+    scheduler.add_pending_job(problem_job(4, JT::EDIT_PROBLEM, 9));
+
+    // Removing the first job unblocks the next one
+    scheduler.remove_pending_job(2);
+    EXPECT_EQ(start_next_job_id(scheduler), 3);
+    EXPECT_EQ(start_next_job_id(scheduler), 4);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt);
+    scheduler.finish_job(3);
+    EXPECT_EQ(start_next_job_id(scheduler), std::nullopt);
+    scheduler.finish_job(4);
+    EXPECT_EQ(start_next_job_id(scheduler), 5);
+    EXPECT_EQ(scheduler.pending_jobs_num(), 0);
+}
@@ -0,0 +1,31 @@
+#include "../../src/job_server/job_handlers/tracee_cpus_pool.hh"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <optional>
+#include <vector>
+
+using job_server::job_handlers::parse_cpus;
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(job_server_TraceeCpusPool, parse_cpus) {
+    EXPECT_EQ(parse_cpus("3"), (vector<size_t>{3}));
+    EXPECT_EQ(parse_cpus("2-3"), (vector<size_t>{2, 3}));
+    EXPECT_EQ(parse_cpus("4-4"), (vector<size_t>{4}));
+    EXPECT_EQ(parse_cpus("0-2,5,7-8"), (vector<size_t>{0, 1, 2, 5, 7, 8}));
+}
+
+// NOLINTNEXTLINE
+TEST(job_server_TraceeCpusPool, parse_cpus_rejects_invalid_cpus) {
+    EXPECT_EQ(parse_cpus(""), std::nullopt);
+    EXPECT_EQ(parse_cpus("5-2"), std::nullopt);
+    EXPECT_EQ(parse_cpus("-2"), std::nullopt);
+    EXPECT_EQ(parse_cpus("2-"), std::nullopt);
+    EXPECT_EQ(parse_cpus("1-2-3"), std::nullopt);
+    EXPECT_EQ(parse_cpus("1,"), std::nullopt);
+    EXPECT_EQ(parse_cpus(",1"), std::nullopt);
+    EXPECT_EQ(parse_cpus("1,,2"), std::nullopt);
+    EXPECT_EQ(parse_cpus("a"), std::nullopt);
+    EXPECT_EQ(parse_cpus("99999999999999999999"), std::nullopt);
+}
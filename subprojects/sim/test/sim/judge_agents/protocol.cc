@@ -0,0 +1,277 @@
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <sim/judge_agents/protocol.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/socket_stream_ext.hh>
+#include <simlib/temporary_directory.hh>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <variant>
+
+using sim::judge_agents::CompilationResult;
+using sim::judge_agents::ConnectionError;
+using sim::judge_agents::Hello;
+using sim::judge_agents::JudgeReport;
+using sim::judge_agents::JudgeTask;
+using sim::judge_agents::Package;
+using sim::judge_agents::PackageRequest;
+using sim::judge_agents::TaskFailure;
+
+namespace {
+
+struct SocketPair {
+    FileDescriptor a;
+    FileDescriptor b;
+};
+
+SocketPair socket_pair() {
+    int sock_fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sock_fds)) {
+        THROW("socketpair()");
+    }
+    return {.a = FileDescriptor{sock_fds[0]}, .b = FileDescriptor{sock_fds[1]}};
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, judge_task) {
+    auto sp = socket_pair();
+    sim::judge_agents::send_message(
+        sp.a,
+        JudgeTask{
+            .package_file_id = 42,
+            .language = sim::SolutionLanguage::CPP17,
+            .solution_source = "int main() {}",
+            .solution_compilation_time_limit = std::chrono::seconds{30},
+            .solution_compilation_memory_limit = 1 << 30,
+            .checker_compilation_time_limit = std::chrono::seconds{20},
+            .checker_compilation_memory_limit = 512 << 20,
+            .compilation_errors_max_length = 16 << 10,
+        }
+    );
+    auto msg = sim::judge_agents::recv_message(sp.b);
+    auto* task = std::get_if<JudgeTask>(&msg);
+    ASSERT_NE(task, nullptr);
+    EXPECT_EQ(task->package_file_id, 42);
+    EXPECT_EQ(task->language, sim::SolutionLanguage::CPP17);
+    EXPECT_EQ(task->solution_source, "int main() {}");
+    EXPECT_EQ(task->solution_compilation_time_limit, std::chrono::seconds{30});
+    EXPECT_EQ(task->solution_compilation_memory_limit, 1 << 30);
+    EXPECT_EQ(task->checker_compilation_time_limit, std::chrono::seconds{20});
+    EXPECT_EQ(task->checker_compilation_memory_limit, 512 << 20);
+    EXPECT_EQ(task->compilation_errors_max_length, 16 << 10);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, package) {
+    auto sp = socket_pair();
+    sim::judge_agents::send_message(sp.b, PackageRequest{});
+    ASSERT_TRUE(std::holds_alternative<PackageRequest>(sim::judge_agents::recv_message(sp.a)));
+
+    auto contents = std::string{"PK\3\4\0zip"};
+    sim::judge_agents::send_message(sp.a, Package{.contents = contents});
+    auto msg = sim::judge_agents::recv_message(sp.b);
+    auto* package = std::get_if<Package>(&msg);
+    ASSERT_NE(package, nullptr);
+    EXPECT_EQ(package->contents, contents);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, compilation_result) {
+    auto sp = socket_pair();
+    sim::judge_agents::send_message(
+        sp.b,
+        CompilationResult{
+            .status = CompilationResult::Status::SOLUTION_COMPILATION_ERROR,
+            .compilation_errors = "error: expected ';'",
+            .log = "Compiling solution...\n",
+        }
+    );
+    auto msg = sim::judge_agents::recv_message(sp.a);
+    auto* res = std::get_if<CompilationResult>(&msg);
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->status, CompilationResult::Status::SOLUTION_COMPILATION_ERROR);
+    EXPECT_EQ(res->compilation_errors, "error: expected ';'");
+    EXPECT_EQ(res->log, "Compiling solution...\n");
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, judge_report) {
+    auto sp = socket_pair();
+    sim::JudgeReport report;
+    report.groups.emplace_back();
+    report.groups.back().score = 30;
+    report.groups.back().max_score = 50;
+    report.groups.back().tests.emplace_back(
+        "1a",
+        sim::JudgeReport::Test::OK,
+        std::chrono::milliseconds{120},
+        std::chrono::seconds{1},
+        4 << 20,
+        64 << 20,
+        ""
+    );
+    report.groups.back().tests.emplace_back(
+        "1b",
+        sim::JudgeReport::Test::WA,
+        std::chrono::milliseconds{310},
+        std::chrono::seconds{1},
+        5 << 20,
+        64 << 20,
+        "Line 1: expected 7, got 8"
+    );
+    report.groups.emplace_back();
+    report.judge_log = "Judging (final): {\n}\n";
+    sim::judge_agents::send_message(
+        sp.b, JudgeReport{.final = true, .partial = false, .report = report, .log = "log"}
+    );
+
+    auto msg = sim::judge_agents::recv_message(sp.a);
+    auto* res = std::get_if<JudgeReport>(&msg);
+    ASSERT_NE(res, nullptr);
+    EXPECT_TRUE(res->final);
+    EXPECT_FALSE(res->partial);
+    EXPECT_EQ(res->log, "log");
+    EXPECT_EQ(res->report.judge_log, report.judge_log);
+    ASSERT_EQ(res->report.groups.size(), 2);
+    EXPECT_EQ(res->report.groups[0].score, 30);
+    EXPECT_EQ(res->report.groups[0].max_score, 50);
+    EXPECT_TRUE(res->report.groups[1].tests.empty());
+    ASSERT_EQ(res->report.groups[0].tests.size(), 2);
+    for (size_t i = 0; i < 2; ++i) {
+        const auto& expected = report.groups[0].tests[i];
+        const auto& test = res->report.groups[0].tests[i];
+        EXPECT_EQ(test.name, expected.name);
+        EXPECT_EQ(test.status, expected.status);
+        EXPECT_EQ(test.runtime, expected.runtime);
+        EXPECT_EQ(test.time_limit, expected.time_limit);
+        EXPECT_EQ(test.memory_consumed, expected.memory_consumed);
+        EXPECT_EQ(test.memory_limit, expected.memory_limit);
+        EXPECT_EQ(test.comment, expected.comment);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, task_failure) {
+    auto sp = socket_pair();
+    sim::judge_agents::send_message(sp.b, TaskFailure{.error = "invalid package"});
+    auto msg = sim::judge_agents::recv_message(sp.a);
+    auto* failure = std::get_if<TaskFailure>(&msg);
+    ASSERT_NE(failure, nullptr);
+    EXPECT_EQ(failure->error, "invalid package");
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, hello) {
+    auto sp = socket_pair();
+    sim::judge_agents::send_message(sp.b, Hello{.secret = "s3cret"});
+    auto msg = sim::judge_agents::recv_message(sp.a);
+    auto* hello = std::get_if<Hello>(&msg);
+    ASSERT_NE(hello, nullptr);
+    EXPECT_EQ(hello->secret, "s3cret");
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, is_correct_secret) {
+    using sim::judge_agents::is_correct_secret;
+    EXPECT_TRUE(is_correct_secret("", ""));
+    EXPECT_TRUE(is_correct_secret("s3cret", "s3cret"));
+    EXPECT_FALSE(is_correct_secret("", "s3cret"));
+    EXPECT_FALSE(is_correct_secret("s3cre", "s3cret"));
+    EXPECT_FALSE(is_correct_secret("s3crett", "s3cret"));
+    EXPECT_FALSE(is_correct_secret("s3creT", "s3cret"));
+    EXPECT_FALSE(is_correct_secret("s3cret", ""));
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, disconnection) {
+    auto sp = socket_pair();
+    ASSERT_EQ(sp.b.close(), 0);
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.a), ConnectionError);
+    EXPECT_THROW(sim::judge_agents::send_message(sp.a, PackageRequest{}), ConnectionError);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, malformed_messages) {
+    auto sp = socket_pair();
+    // Unknown message type
+    ASSERT_EQ(send_as_bytes(sp.a, 0, uint8_t{77}, uint64_t{0}), 0);
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+    // Truncated Package
+    ASSERT_EQ(send_as_bytes(sp.a, 0, uint8_t{2}, uint64_t{8}, uint64_t{100}), 0);
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+    // Trailing data after PackageRequest
+    ASSERT_EQ(send_as_bytes(sp.a, 0, uint8_t{1}, uint64_t{1}, uint8_t{0}), 0);
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+    // JudgeTask with an invalid language (only the payload up to the language is needed)
+    ASSERT_EQ(send_as_bytes(sp.a, 0, uint8_t{0}, uint64_t{12}, uint64_t{42}, int{77}), 0);
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, too_big_message) {
+    auto sp = socket_pair();
+    // Nothing is allocated for the announced payload, which is never sent
+    ASSERT_EQ(
+        send_as_bytes(
+            sp.a, 0, uint8_t{2}, uint64_t{sim::judge_agents::max_message_payload_len + 1}
+        ),
+        0
+    );
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, judge_report_with_huge_counts) {
+    auto sp = socket_pair();
+    // final, partial, groups count
+    ASSERT_EQ(
+        send_as_bytes(sp.a, 0, uint8_t{4}, uint64_t{10}, uint8_t{1}, uint8_t{0}, ~uint64_t{0}), 0
+    );
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+    // final, partial, groups count, tests count of the first group
+    ASSERT_EQ(
+        send_as_bytes(
+            sp.a, 0, uint8_t{4}, uint64_t{18}, uint8_t{1}, uint8_t{0}, uint64_t{1}, ~uint64_t{0}
+        ),
+        0
+    );
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, recv_timeout) {
+    auto sp = socket_pair();
+    sim::judge_agents::set_recv_timeout(sp.b, std::chrono::milliseconds{50});
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+    // The timeout applies to the payload as well
+    ASSERT_EQ(send_as_bytes(sp.a, 0, uint8_t{2}, uint64_t{8}), 0);
+    EXPECT_THROW(sim::judge_agents::recv_message(sp.b), ConnectionError);
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, unix_socket_address) {
+    auto tmp_dir = TemporaryDirectory{"/tmp/judge-agents-protocol-test.XXXXXX"};
+    auto address = concat_tostr("unix:", tmp_dir.path(), "agents.sock");
+    auto listening_fd = sim::judge_agents::listen_for_agents(address);
+    auto agent_fd = sim::judge_agents::connect_to_job_server(address);
+    auto job_server_fd = FileDescriptor{accept4(listening_fd, nullptr, nullptr, SOCK_CLOEXEC)};
+    ASSERT_TRUE(job_server_fd.is_open());
+    sim::judge_agents::send_message(agent_fd, PackageRequest{});
+    auto msg = sim::judge_agents::recv_message(job_server_fd);
+    ASSERT_TRUE(std::holds_alternative<PackageRequest>(msg));
+}
+
+// NOLINTNEXTLINE
+TEST(judge_agents_protocol, invalid_addresses) {
+    EXPECT_THROW(sim::judge_agents::connect_to_job_server("127.0.0.1"), std::runtime_error);
+    EXPECT_THROW(sim::judge_agents::connect_to_job_server("127.0.0.1:http"), std::runtime_error);
+    EXPECT_THROW(sim::judge_agents::connect_to_job_server("*:8080"), std::runtime_error);
+    EXPECT_THROW(sim::judge_agents::connect_to_job_server("unix:"), std::runtime_error);
+}
@@ -3,7 +3,9 @@
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/throw_assert.hh>
 #include <simlib/time_format_conversions.hh>
+#include <sys/mman.h>
 #include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -54,4 +56,40 @@ int main() {
             sb.await_result(std::move(handles[i]));
         }
     });
+
+    auto parallel_sb = sandbox::spawn_supervisor({
+        .max_concurrent_requests = std::thread::hardware_concurrency(),
+    });
+    benchmark("    parallel", [&] {
+        std::vector<sandbox::SupervisorConnection::RequestHandle> handles;
+        handles.reserve(N);
+        for (size_t i = 0; i < N; i++) {
+            handles.emplace_back(parallel_sb.send_request({{"/bin/true"}}, {}));
+        }
+        for (size_t i = 0; i < N; i++) {
+            parallel_sb.await_result(std::move(handles[i]));
+        }
+    });
+
+    // The tracee cgroup is reused between requests if the tracee leaves no memory charged to it.
+    // Output written to tmpfs stays charged, which forces recreating the cgroup.
+    std::vector<int> output_fds;
+    output_fds.reserve(N);
+    for (size_t i = 0; i < N; i++) {
+        output_fds.emplace_back(memfd_create("sandbox_bench_output", MFD_CLOEXEC));
+        throw_assert(output_fds.back() != -1);
+    }
+    benchmark("sync, reused cgroup", [&] {
+        for (size_t i = 0; i < N; i++) {
+            sb.await_result(sb.send_request({{"/bin/echo"}}, {}));
+        }
+    });
+    benchmark("   sync, new cgroup", [&] {
+        for (size_t i = 0; i < N; i++) {
+            sb.await_result(sb.send_request({{"/bin/echo"}}, {.stdout_fd = output_fds[i]}));
+        }
+    });
+    for (int fd : output_fds) {
+        throw_assert(close(fd) == 0);
+    }
 }
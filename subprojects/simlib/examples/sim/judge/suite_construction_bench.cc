@@ -0,0 +1,40 @@
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <seccomp.h>
+#include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
+#include <simlib/sandbox/seccomp/bpf_builder.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/time_format_conversions.hh>
+#include <utility>
+
+int main() {
+    constexpr auto N = 1000;
+    auto benchmark = [&](auto name, auto run) {
+        auto start_tp = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < N; ++i) {
+            run();
+        }
+        auto duration = (std::chrono::steady_clock::now() - start_tp) / N;
+        std::cout << name << ": " << to_string(duration, false).c_str() << " = "
+                  << std::chrono::seconds{1} / duration << " / second" << std::endl;
+    };
+
+    // Done by every suite constructor before the BPF programs were prebuilt
+    benchmark("building BPF", [] {
+        auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
+        sandbox::seccomp::allow_common_safe_syscalls(bpf);
+        (void)bpf.export_to_fd();
+    });
+
+    for (auto [name, lang] : {
+             std::pair{"         C11", sim::SolutionLanguage::C11},
+             std::pair{"       C++17", sim::SolutionLanguage::CPP17},
+             std::pair{"      Pascal", sim::SolutionLanguage::PASCAL},
+             std::pair{"      Python", sim::SolutionLanguage::PYTHON},
+             std::pair{"        Rust", sim::SolutionLanguage::RUST},
+         })
+    {
+        benchmark(name, [lang = lang] { (void)sim::lang_to_suite(lang); });
+    }
+}
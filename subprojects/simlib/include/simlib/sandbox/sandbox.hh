@@ -15,6 +15,11 @@
 
 namespace sandbox {
 
+struct SupervisorOptions {
+    // Requests above this limit wait until one of the running requests completes
+    size_t max_concurrent_requests = 1;
+};
+
 struct RequestOptions {
     std::optional<int> stdin_fd = std::nullopt;
     std::optional<int> stdout_fd = std::nullopt;
@@ -87,6 +92,10 @@ struct RequestOptions {
 
         // Writes "$max_usec $period_usec" to cpu.max cgroup file
         std::optional<CpuMaxBandwidth> cpu_max_bandwidth = std::nullopt;
+
+        // Writes it to cpuset.cpus cgroup file, e.g. "2-3,6" pins the tracee to CPUs 2, 3 and 6.
+        // Requires the cpuset controller to be available to the sandbox.
+        std::optional<std::string_view> cpuset_cpus = std::nullopt;
     } cgroup = {};
 
     struct Prlimit {
@@ -139,6 +148,7 @@ class SupervisorConnection {
                  // the already processed requests
     int supervisor_pidfd;
     int supervisor_error_fd;
+    uint64_t sent_requests_num_ = 0;
     int uncaught_exceptions_in_constructor = std::uncaught_exceptions();
 
     SupervisorConnection(int sock_fd_, int supervisor_pidfd_, int supervisor_error_fd_) noexcept
@@ -148,14 +158,15 @@ class SupervisorConnection {
 
 public:
     // Spawns supervisor process. Throws on error.
-    friend SupervisorConnection spawn_supervisor();
+    friend SupervisorConnection spawn_supervisor(const SupervisorOptions& options);
 
     SupervisorConnection(const SupervisorConnection&) = delete;
 
     SupervisorConnection(SupervisorConnection&& sc) noexcept
     : sock_fd{std::exchange(sc.sock_fd, -1)}
     , supervisor_pidfd{std::exchange(sc.supervisor_pidfd, -1)}
-    , supervisor_error_fd{std::exchange(sc.supervisor_error_fd, -1)} {}
+    , supervisor_error_fd{std::exchange(sc.supervisor_error_fd, -1)}
+    , sent_requests_num_{sc.sent_requests_num_} {}
 
     SupervisorConnection& operator=(const SupervisorConnection&) = delete;
     SupervisorConnection& operator=(SupervisorConnection&&) noexcept = delete;
@@ -252,6 +263,12 @@ public:
     /// Throws if there is any error with the supervisor.
     Result await_result(RequestHandle&& request_handle);
 
+    /// Returns false if the supervisor died, reported an error or the connection is broken.
+    /// Does not block.
+    [[nodiscard]] bool is_healthy() const noexcept;
+
+    [[nodiscard]] uint64_t sent_requests_num() const noexcept { return sent_requests_num_; }
+
 private:
     void kill_and_wait_supervisor() noexcept;
 
@@ -265,6 +282,6 @@ private:
     void mark_supervisor_is_dead_and_waited() noexcept { supervisor_pidfd = -1; }
 };
 
-SupervisorConnection spawn_supervisor();
+SupervisorConnection spawn_supervisor(const SupervisorOptions& options = {});
 
 } // namespace sandbox
@@ -6,4 +6,8 @@ namespace sandbox::seccomp {
 
 void allow_common_safe_syscalls(BpfBuilder& bpf);
 
+// Returns the prebuilt (see prebuilt_bpf_fd()) BPF program that allows the common safe syscalls
+// and makes the others fail with ENOSYS
+int common_safe_syscalls_bpf_fd();
+
 } // namespace sandbox::seccomp
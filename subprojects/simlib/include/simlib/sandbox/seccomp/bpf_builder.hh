@@ -133,7 +133,8 @@ public:
     }
 
     [[nodiscard]] FileDescriptor export_to_fd() const {
-        auto mfd = FileDescriptor{memfd_create("seccomp bpf", MFD_CLOEXEC)};
+        // Sealing allows sharing the program safely, see prebuilt_bpf_fd()
+        auto mfd = FileDescriptor{memfd_create("seccomp bpf", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
         if (!mfd.is_open()) {
             THROW("memfd_create()", errmsg());
         }
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <functional>
+#include <simlib/file_descriptor.hh>
+#include <string_view>
+
+namespace sandbox::seccomp {
+
+// Returns the file descriptor of the BPF program of the seccomp policy named @p policy_name. The
+// program is built with @p build_bpf_fd (e.g. BpfBuilder::export_to_fd()) only on the first call
+// with this name in the process, sealed against modifications and shared by all the callers until
+// the end of the process. Thread-safe.
+int prebuilt_bpf_fd(
+    std::string_view policy_name, const std::function<FileDescriptor()>& build_bpf_fd
+);
+
+} // namespace sandbox::seccomp
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <simlib/sandbox/sandbox.hh>
+#include <utility>
+#include <vector>
+
+namespace sandbox {
+
+// Pool of spawned supervisors, so that the cost of spawning a supervisor is not paid on every use.
+// Safe to use from multiple threads.
+class SupervisorPool {
+public:
+    struct Options {
+        // Surplus supervisors are killed upon return
+        size_t max_idle_supervisors;
+        // Supervisors that have handled that many requests are killed upon return, 0 means no limit
+        uint64_t max_requests_per_supervisor;
+    };
+
+private:
+    Options options;
+    std::mutex mutex;
+    std::vector<SupervisorConnection> idle_scs;
+    std::atomic<uint64_t> leases_num_{0};
+    std::atomic<uint64_t> spawned_supervisors_num_{0};
+
+public:
+    explicit SupervisorPool(Options options);
+
+    SupervisorPool(const SupervisorPool&) = delete;
+    SupervisorPool(SupervisorPool&&) = delete;
+    SupervisorPool& operator=(const SupervisorPool&) = delete;
+    SupervisorPool& operator=(SupervisorPool&&) = delete;
+    // Kills idle supervisors, leases have to be destroyed before the pool
+    ~SupervisorPool();
+
+    // Returns the supervisor to the pool upon destruction (unless the supervisor is unhealthy, is
+    // due to be recycled or the lease is destroyed during stack unwinding)
+    class [[nodiscard]] Lease {
+        SupervisorPool* pool; // nullptr if the supervisor does not belong to any pool
+        std::optional<SupervisorConnection> sc;
+        int uncaught_exceptions_in_constructor = std::uncaught_exceptions();
+
+        Lease(SupervisorPool& pool, SupervisorConnection&& sc) noexcept
+        : pool{&pool}
+        , sc{std::move(sc)} {}
+
+        friend class SupervisorPool;
+
+    public:
+        // Lease of the supervisor that does not belong to any pool, it is killed upon destruction
+        explicit Lease(SupervisorConnection&& sc) noexcept : pool{nullptr}, sc{std::move(sc)} {}
+
+        Lease(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept
+        : pool{std::exchange(other.pool, nullptr)}
+        , sc{std::move(other.sc)}
+        , uncaught_exceptions_in_constructor{other.uncaught_exceptions_in_constructor} {}
+
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() noexcept(false);
+
+        SupervisorConnection& operator*() noexcept { return *sc; }
+
+        SupervisorConnection* operator->() noexcept { return &*sc; }
+    };
+
+    // Returns an idle healthy supervisor or spawns a new one if there is none
+    Lease lease();
+
+    // Spawns supervisors so that there are at least @p idle_supervisors_num idle supervisors
+    // (but no more than options.max_idle_supervisors)
+    void warm_up(size_t idle_supervisors_num);
+
+    [[nodiscard]] uint64_t leases_num() const noexcept { return leases_num_; }
+
+    // Including the supervisors spawned by warm_up()
+    [[nodiscard]] uint64_t spawned_supervisors_num() const noexcept {
+        return spawned_supervisors_num_;
+    }
+
+private:
+    SupervisorConnection spawn_counted_supervisor();
+
+
+    [[nodiscard]] bool is_reusable(const SupervisorConnection& sc) const noexcept;
+};
+
+} // namespace sandbox
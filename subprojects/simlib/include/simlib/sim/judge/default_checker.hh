@@ -0,0 +1,49 @@
+#pragma once
+
+#include <simlib/file_path.hh>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sim::judge {
+
+// The checker used if the problem does not provide one. It is run in-process (there is no need to
+// sandbox it) and compares outputs line by line ignoring trailing spaces in lines and trailing
+// whitespace at the end of the output. Returns the checker output i.e. "OK\n" or
+// "WRONG\n0\n<comment with the context of the first difference>\n".
+std::string run_default_checker(FilePath expected_output, FilePath program_output);
+
+// Compares the program output with the expected output while the program output is being
+// produced, so that a wrong answer can be detected before the program finishes. Verdicts are the
+// same as the ones of run_default_checker().
+class StreamingDefaultChecker {
+    std::string_view expected; // mapped expected output
+    size_t expected_pos = 0;
+    // Whitespace at the end of the output fed so far, it is not matched yet
+    uint64_t pending_newlines = 0;
+    uint64_t pending_spaces = 0; // after the last pending newline
+    bool wrong_answer = false;
+
+public:
+    explicit StreamingDefaultChecker(FilePath expected_output);
+
+    StreamingDefaultChecker(const StreamingDefaultChecker&) = delete;
+    StreamingDefaultChecker(StreamingDefaultChecker&&) = delete;
+    StreamingDefaultChecker& operator=(const StreamingDefaultChecker&) = delete;
+    StreamingDefaultChecker& operator=(StreamingDefaultChecker&&) = delete;
+
+    ~StreamingDefaultChecker();
+
+    // Feeds the next chunk of the program output. Returns false iff the output fed so far has no
+    // continuation that run_default_checker() would accept i.e. the answer is certainly wrong.
+    [[nodiscard]] bool feed(std::string_view program_output_chunk) noexcept;
+
+    // Returns whether run_default_checker() accepts the output fed so far as the whole output
+    [[nodiscard]] bool accepts_fed_output() const noexcept;
+
+private:
+    [[nodiscard]] bool feed_non_whitespace(char c) noexcept;
+};
+
+} // namespace sim::judge
@@ -1,24 +1,105 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <simlib/file_descriptor.hh>
 #include <simlib/sim/judge/compilation_cache.hh>
+#include <simlib/string_view.hh>
 #include <string>
+#include <sys/types.h>
 
 namespace sim::judge {
 
+// Size-bounded disk cache of compiled files. The least recently used entries are evicted once the
+// total size or the number of entries exceeds its budget. The order of use is kept in a journal in
+// the cache directory, so the directory is not scanned on start-up. Safe to use from multiple
+// threads and processes at the same time.
 class DiskCompilationCache : public CompilationCache {
     std::string cache_dir;
     std::chrono::seconds max_staleness;
+    uint64_t max_size_in_bytes;
+    uint64_t max_entries_num;
+    std::atomic<uint64_t> hits_num_{0};
+    std::atomic<uint64_t> misses_num_{0};
+
+    struct Entry {
+        uint64_t size_in_bytes;
+        uint64_t last_use; // number of the journal record of the last use
+    };
+
+    // Everything below is protected by the mutex (against other threads) and the lock file
+    // (against other processes), see lock()
+    std::mutex mutex;
+    FileDescriptor lock_fd;
+    FileDescriptor journal_fd;
+    ino_t journal_ino = 0;
+    off64_t journal_replayed_len = 0;
+    uint64_t journal_records_num = 0;
+    std::map<std::string, Entry, std::less<>> entries; // file name => entry
+    std::map<uint64_t, std::string> entries_by_last_use; // last_use => file name
+    uint64_t total_size_in_bytes = 0;
 
 public:
-    explicit DiskCompilationCache(std::string cache_dir, std::chrono::seconds max_staleness);
+    // Files already present in @p cache_dir are taken into account
+    DiskCompilationCache(
+        std::string cache_dir,
+        std::chrono::seconds max_staleness,
+        uint64_t max_size_in_bytes,
+        uint64_t max_entries_num
+    );
+
+    DiskCompilationCache(const DiskCompilationCache&) = delete;
+    DiskCompilationCache(DiskCompilationCache&&) = delete;
+    DiskCompilationCache& operator=(const DiskCompilationCache&) = delete;
+    DiskCompilationCache& operator=(DiskCompilationCache&&) = delete;
+    ~DiskCompilationCache() override = default;
 
     bool copy_from_cache_if_newer_than(
         std::string_view name, FilePath dest, const std::chrono::system_clock::time_point& tp
     ) override;
 
     void save_or_override(std::string_view name, FilePath src) override;
+
+    // Calls of copy_from_cache_if_newer_than() that copied the cached file
+    [[nodiscard]] uint64_t hits_num() const noexcept { return hits_num_; }
+
+    // Calls of copy_from_cache_if_newer_than() that did not copy anything
+    [[nodiscard]] uint64_t misses_num() const noexcept { return misses_num_; }
+
+private:
+    class [[nodiscard]] Lock;
+
+    Lock lock();
+
+    // Applies the journal records appended by other processes. Has to be called with lock() held.
+    void sync_with_journal();
+
+    // Has to be called with lock() held
+    void apply_journal_record(StringView record);
+
+    // @p record has to end with '\n'. Has to be called with lock() held.
+    void append_journal_record(const std::string& record);
+
+    // Removes the entry from memory only. Has to be called with lock() held.
+    void forget_entry(StringView file_name);
+
+    // Has to be called with lock() held
+    void remove_entry(const std::string& file_name);
+
+    // Has to be called with lock() held
+    void evict_if_needed();
+
+    // Rewrites the journal once it is dominated by the records of the past uses. Has to be called
+    // with lock() held.
+    void compact_journal_if_needed();
+
+    // Has to be called with lock() held
+    void replace_journal(StringView contents);
 };
 
 } // namespace sim::judge
@@ -5,12 +5,26 @@
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/slice.hh>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace sim::judge::language_suite {
 
 class Cpp_GCC final : public FullyCompiledLanguage {
+public:
+    struct PrecompiledHeaders {
+        // Directory in which the precompiled headers are kept. It may be shared by the suites of
+        // all the standards and by multiple processes.
+        std::string dir;
+        // Headers as named in #include <...>, e.g. "bits/stdc++.h"
+        std::vector<std::string> headers;
+    };
+
+private:
     std::string_view std_flag;
+    std::optional<PrecompiledHeaders> precompiled_headers;
+    std::optional<std::string> precompiled_headers_path; // set once they are prepared
 
     [[nodiscard]] sandbox::Result run_compiler(
         Slice<std::string_view> extra_args,
@@ -19,6 +33,12 @@ class Cpp_GCC final : public FullyCompiledLanguage {
         CompileOptions options
     );
 
+    // Returns the directory with the precompiled headers for this compiler and standard,
+    // generating them if it does not exist yet. Headers that the compiler rejects are omitted. If
+    // the compiler does not finish for some header (e.g. it times out under load), nothing is
+    // generated and std::nullopt is returned, so that the next compilation tries again.
+    std::optional<std::string> prepare_precompiled_headers();
+
 public:
     enum class Standard {
         Cpp11,
@@ -33,9 +53,15 @@ public:
         Gnupp23,
     };
 
-    explicit Cpp_GCC(Standard standard);
+    // If @p precompiled_headers are given, they are generated on the first compilation (once per
+    // compiler version and standard) and used by every compiled source that includes them first
+    explicit Cpp_GCC(
+        Standard standard, std::optional<PrecompiledHeaders> precompiled_headers = std::nullopt
+    );
 
 protected:
+    [[nodiscard]] std::vector<std::string_view> compiler_flags() const final;
+
     sandbox::Result is_supported_impl(CompileOptions options) final;
 
     sandbox::Result compile_impl(
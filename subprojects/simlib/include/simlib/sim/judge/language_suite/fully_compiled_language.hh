@@ -8,14 +8,16 @@
 #include <simlib/sim/judge/language_suite/suite.hh>
 #include <simlib/slice.hh>
 #include <simlib/temporary_file.hh>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace sim::judge::language_suite {
 
 class FullyCompiledLanguage : public Suite {
 protected:
     std::string compiler_executable_path;
-    FileDescriptor compiler_seccomp_bpf_fd;
+    int compiler_seccomp_bpf_fd; // see sandbox::seccomp::prebuilt_bpf_fd()
 
 private:
     TemporaryFile executable_tmp_file{
@@ -25,12 +27,16 @@ private:
     };
     bool executable_file_is_ready = false;
 
+    // Hash identifying the executable compiled from @p source, see CompileOptions::Cache
+    std::string content_hash(FilePath source);
+
 protected:
-    FileDescriptor executable_seccomp_bpf_fd;
+    int executable_seccomp_bpf_fd; // see sandbox::seccomp::prebuilt_bpf_fd()
 
 public:
+    // @p compiler_seccomp_bpf_fd has to stay open as long as the suite exists
     explicit FullyCompiledLanguage(
-        std::string compiler_executable_path, FileDescriptor compiler_seccomp_bpf_fd
+        std::string compiler_executable_path, int compiler_seccomp_bpf_fd
     );
 
     [[nodiscard]] bool is_supported() final;
@@ -44,7 +50,16 @@ public:
         Slice<sandbox::RequestOptions::LinuxNamespaces::Mount::Operation> mount_ops
     ) final;
 
+    // Identifies the compiler together with compiler_flags(); changes with upgrades of the compiler
+    // and with changes of the flags, i.e. whenever the same source may compile to a different
+    // executable
+    [[nodiscard]] std::string compiler_identity() const;
+
 protected:
+    // Arguments passed to the compiler on every compilation, besides the ones naming the source and
+    // the executable. They are a part of the identity of the executable in the compilation cache.
+    [[nodiscard]] virtual std::vector<std::string_view> compiler_flags() const = 0;
+
     [[nodiscard]] virtual sandbox::Result is_supported_impl(CompileOptions options) = 0;
 
     virtual sandbox::Result compile_impl(
@@ -15,12 +15,11 @@ class FullyInterpretedLanguage : public Suite {
 protected:
     std::string interpreter_executable_path;
     TemporaryFile source_tmp_file{"/tmp/sim_fully_interpreted_language_suite_source.XXXXXX"};
-    FileDescriptor seccomp_bpf_fd;
+    int seccomp_bpf_fd; // see sandbox::seccomp::prebuilt_bpf_fd()
 
 public:
-    explicit FullyInterpretedLanguage(
-        std::string interpreter_executable_path, FileDescriptor seccomp_bpf_fd
-    );
+    // @p seccomp_bpf_fd has to stay open as long as the suite exists
+    explicit FullyInterpretedLanguage(std::string interpreter_executable_path, int seccomp_bpf_fd);
 
     [[nodiscard]] bool is_supported() final {
         return access(interpreter_executable_path.c_str(), F_OK) == 0;
@@ -6,6 +6,7 @@
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/slice.hh>
 #include <string_view>
+#include <vector>
 
 namespace sim::judge::language_suite {
 
@@ -23,6 +24,8 @@ public:
     explicit Pascal();
 
 protected:
+    [[nodiscard]] std::vector<std::string_view> compiler_flags() const final;
+
     sandbox::Result is_supported_impl(CompileOptions options) final;
 
     sandbox::Result compile_impl(
@@ -2,13 +2,18 @@
 
 #include <chrono>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <simlib/concurrent/mutexed_value.hh>
 #include <simlib/file_descriptor.hh>
 #include <simlib/result.hh>
 #include <simlib/sandbox/sandbox.hh>
+#include <simlib/sandbox/supervisor_pool.hh>
 #include <simlib/sim/judge/compilation_cache.hh>
 #include <simlib/slice.hh>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace sim::judge::language_suite {
@@ -16,8 +21,30 @@ namespace sim::judge::language_suite {
 // A language suite interface
 // NOLINTNEXTLINE(cppcoreguidelines-special-member-functions)
 class Suite {
+    sandbox::SupervisorPool* supervisor_pool = nullptr; // nullptr means spawning own supervisors
+    std::optional<sandbox::SupervisorPool::Lease> sc_lease; // leased on the first use of sc()
+    std::optional<std::string> tracee_cpus;
+
+    // Present only if concurrent runs are enabled
+    struct RunSupervisors {
+        std::vector<sandbox::SupervisorPool::Lease> extra_scs; // sc() is used too
+        // 0 denotes sc(), i > 0 denotes extra_scs[i - 1]
+        concurrent::MutexedValue<std::vector<size_t>> idle_sc_idxs;
+    };
+
+    std::unique_ptr<RunSupervisors> run_supervisors;
+
 protected:
-    sandbox::SupervisorConnection sc = sandbox::spawn_supervisor();
+    // Spawns or leases the supervisor on the first use
+    sandbox::SupervisorConnection& sc();
+
+    // To be used as sandbox::RequestOptions::Cgroup::cpuset_cpus of every request
+    [[nodiscard]] std::optional<std::string_view> cpuset_cpus() const noexcept {
+        if (tracee_cpus) {
+            return *tracee_cpus;
+        }
+        return std::nullopt;
+    }
 
 public:
     Suite() = default;
@@ -38,6 +65,10 @@ public:
         struct Cache {
             CompilationCache& compilation_cache; // NOLINT
             std::string_view cached_name;
+            // If true, the executable is cached under cached_name followed by the hash of the
+            // source contents, the compiler and its flags, so the entry is shared by all identical
+            // sources regardless of their paths and modification times
+            bool content_addressed = false;
         };
 
         std::optional<Cache> cache = std::nullopt;
@@ -45,6 +76,28 @@ public:
 
     [[nodiscard]] virtual bool is_supported() = 0;
 
+    // Makes the suite lease supervisors from @p supervisor_pool instead of spawning its own ones.
+    // Supervisors in use are released. Must not be called while any run is in progress.
+    void set_supervisor_pool(sandbox::SupervisorPool& supervisor_pool);
+
+    // A supervisor handles requests one by one, so to allow up to @p max_concurrent_runs runs
+    // (issued from different threads) to be in progress at the same time, additional supervisors
+    // are spawned (or leased). Must not be called while any run is in progress.
+    void set_max_concurrent_runs(size_t max_concurrent_runs);
+
+    // Releases all the supervisors (leased ones return to the pool), e.g. while the suite waits
+    // idle for the next use. They are obtained again by set_max_concurrent_runs() or on the next
+    // run or compilation, which then are not concurrent. Must not be called while any run is in
+    // progress.
+    void release_supervisors();
+
+    // Pins the compilers and the programs run by the suite to the CPUs @p cpus given in the
+    // cpuset.cpus format, e.g. "2-3". std::nullopt means no pinning. Requires the cpuset cgroup
+    // controller to be delegated to the user. Must not be called while any run is in progress.
+    void set_tracee_cpus(std::optional<std::string> cpus) noexcept {
+        tracee_cpus = std::move(cpus);
+    }
+
     virtual Result<std::optional<sandbox::result::Ok>, FileDescriptor>
     compile(FilePath source, CompileOptions options) = 0;
 
@@ -67,11 +120,42 @@ public:
         std::vector<std::string_view> env = {};
     };
 
-    struct [[nodiscard]] RunHandle {
+    // Should be passed to await_result(). A handle destroyed without being awaited cancels the
+    // run and frees its supervisor for other runs.
+    class [[nodiscard]] RunHandle {
+    public:
         sandbox::SupervisorConnection::RequestHandle request_handle;
+        size_t sc_idx; // supervisor that handles the request
+
+    private:
+        // Where to return sc_idx once the run is awaited or cancelled, nullptr if nowhere
+        concurrent::MutexedValue<std::vector<size_t>>* idle_sc_idxs;
+
+        RunHandle(
+            sandbox::SupervisorConnection::RequestHandle request_handle_,
+            size_t sc_idx_,
+            concurrent::MutexedValue<std::vector<size_t>>* idle_sc_idxs_
+        ) noexcept
+        : request_handle{std::move(request_handle_)}
+        , sc_idx{sc_idx_}
+        , idle_sc_idxs{idle_sc_idxs_} {}
 
-        explicit RunHandle(sandbox::SupervisorConnection::RequestHandle request_handle_) noexcept
-        : request_handle{std::move(request_handle_)} {}
+        void release_sc() noexcept;
+
+    public:
+        RunHandle(const RunHandle&) = delete;
+
+        RunHandle(RunHandle&& rh) noexcept
+        : request_handle{std::move(rh.request_handle)}
+        , sc_idx{rh.sc_idx}
+        , idle_sc_idxs{std::exchange(rh.idle_sc_idxs, nullptr)} {}
+
+        RunHandle& operator=(const RunHandle&) = delete;
+        RunHandle& operator=(RunHandle&&) = delete;
+
+        ~RunHandle() { release_sc(); }
+
+        friend class Suite;
     };
 
     virtual RunHandle async_run(
@@ -81,6 +165,21 @@ public:
     ) = 0;
 
     virtual sandbox::result::Ok await_result(RunHandle&& run_handle);
+
+private:
+    sandbox::SupervisorPool::Lease lease_supervisor();
+
+    sandbox::SupervisorConnection& run_sc(size_t sc_idx) {
+        return sc_idx == 0 ? sc() : *run_supervisors->extra_scs[sc_idx - 1];
+    }
+
+protected:
+    // To be used by async_run() instead of sc().send_request() to allow concurrent runs
+    RunHandle send_run_request(
+        std::string_view executable_path,
+        Slice<const std::string_view> argv,
+        const sandbox::RequestOptions& options
+    );
 };
 
 } // namespace sim::judge::language_suite
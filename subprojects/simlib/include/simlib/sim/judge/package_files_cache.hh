@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <simlib/file_path.hh>
+#include <string>
+#include <string_view>
+
+namespace sim::judge {
+
+// Size-bounded disk cache of files extracted from packages. Files are grouped by package and
+// whole packages are evicted in the least recently used order. Safe to use from multiple threads
+// of one process.
+class PackageFilesCache {
+    struct Package {
+        uint64_t size_in_bytes = 0;
+        std::chrono::system_clock::time_point last_used;
+        size_t leases_num = 0;
+    };
+
+    std::string cache_dir;
+    uint64_t max_size_in_bytes;
+
+    std::mutex mutex;
+    std::map<std::string, Package, std::less<>> packages; // package dir name => package
+    uint64_t total_size_in_bytes = 0;
+
+public:
+    // Packages already present in @p cache_dir are taken into account
+    PackageFilesCache(std::string cache_dir, uint64_t max_size_in_bytes);
+
+    PackageFilesCache(const PackageFilesCache&) = delete;
+    PackageFilesCache(PackageFilesCache&&) = delete;
+    PackageFilesCache& operator=(const PackageFilesCache&) = delete;
+    PackageFilesCache& operator=(PackageFilesCache&&) = delete;
+    ~PackageFilesCache() = default;
+
+    // Files of the leased package are not evicted until the lease is destroyed
+    class [[nodiscard]] Lease {
+        PackageFilesCache* cache;
+        std::string package_dir_name;
+
+        Lease(PackageFilesCache& cache, std::string package_dir_name) noexcept
+        : cache{&cache}
+        , package_dir_name{std::move(package_dir_name)} {}
+
+        friend class PackageFilesCache;
+
+    public:
+        Lease(const Lease&) = delete;
+        Lease(Lease&& other) noexcept
+        : cache{std::exchange(other.cache, nullptr)}
+        , package_dir_name{std::move(other.package_dir_name)} {}
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease();
+
+        // Returns path of the cached file @p path of the package. If the file is not cached,
+        // @p extract_to is called to extract the file to the given path first. Concurrent calls
+        // for the same file are allowed (the file may be extracted more than once).
+        std::string get_file(FilePath path, const std::function<void(FilePath)>& extract_to);
+    };
+
+    // @p package_name has to identify the package's contents
+    Lease lease(std::string_view package_name);
+
+private:
+    // Has to be called with mutex locked
+    void evict_if_needed();
+};
+
+} // namespace sim::judge
@@ -10,7 +10,8 @@ namespace sim::judge {
 
 struct TestArgs {
     language_suite::Suite& compiled_program; // NOLINT
-    language_suite::Suite& compiled_checker; // NOLINT
+    // nullptr means the default checker, which is run in-process (see default_checker.hh)
+    language_suite::Suite* compiled_checker;
     FilePath test_input;
     FilePath expected_output;
 
@@ -27,6 +28,13 @@ struct TestArgs {
         uint64_t memory_limit_in_bytes;
         uint64_t max_comment_len;
     } checker;
+
+    // Only with the default checker and a regular test input file: the output is compared with the
+    // expected output while the program is running and the program is killed as soon as the answer
+    // is certainly wrong. The program's runtime, CPU time and peak memory usage are then the ones
+    // measured until it was killed, so time and memory limit verdicts still take precedence over
+    // the wrong answer only if they were exceeded before the wrong answer was detected.
+    bool abort_on_wrong_answer = false;
 };
 
 TestReport test_on_test(TestArgs args);
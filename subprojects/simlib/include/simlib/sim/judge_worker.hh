@@ -1,21 +1,31 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <simlib/concat.hh>
 #include <simlib/escape_bytes_to_utf8_str.hh>
 #include <simlib/file_manip.hh>
 #include <simlib/file_path.hh>
 #include <simlib/logger.hh>
 #include <simlib/macros/stack_unwinding.hh>
+#include <simlib/sandbox/supervisor_pool.hh>
 #include <simlib/sim/judge/compilation_cache.hh>
+#include <simlib/sim/judge/language_suite/cpp_gcc.hh>
 #include <simlib/sim/judge/language_suite/suite.hh>
+#include <simlib/sim/judge/package_files_cache.hh>
 #include <simlib/sim/judge/test_report.hh>
 #include <simlib/sim/simfile.hh>
 #include <simlib/temporary_directory.hh>
 #include <simlib/time_format_conversions.hh>
 #include <simlib/to_string.hh>
+#include <string>
 #include <utility>
 
 namespace sim {
@@ -202,7 +212,12 @@ inline SolutionLanguage filename_to_lang(const StringView& filename) {
     THROW("Should not reach here");
 }
 
-std::unique_ptr<judge::language_suite::Suite> lang_to_suite(SolutionLanguage lang);
+// C++ suites use @p cpp_precompiled_headers, see judge::language_suite::Cpp_GCC
+std::unique_ptr<judge::language_suite::Suite> lang_to_suite(
+    SolutionLanguage lang,
+    const std::optional<judge::language_suite::Cpp_GCC::PrecompiledHeaders>&
+        cpp_precompiled_headers = std::nullopt
+);
 
 class JudgeLogger {
 protected:
@@ -410,6 +425,25 @@ struct JudgeWorkerOptions {
     // |        0                                 |
     // +------------------------------------------+
     double score_cut_lambda = 2.0 / 3; // has to be from [0, 1]
+    // Number of tests of a group that may be judged at the same time; every additional one costs
+    // two sandbox supervisors (for the solution and the checker). Reports and logs are the same
+    // as with judging tests one by one.
+    size_t max_concurrently_judged_tests = 1; // has to be greater than 0
+    // If set, sandbox supervisors are leased from the pool instead of being spawned. The pool has
+    // to outlive the JudgeWorker.
+    sandbox::SupervisorPool* supervisor_pool = nullptr;
+    // If the problem uses the default checker, the solution is killed as soon as its output is
+    // certainly wrong. Its runtime is then the one measured until it was killed.
+    bool abort_on_wrong_answer = false;
+    // If set, judge_initial_and_final() judges the final tests at the same time as the initial
+    // ones. It takes twice as many sandbox supervisors.
+    bool judge_initial_and_final_concurrently = false;
+    // If set, the compilers, the solution and the checker run only on these CPUs, see
+    // judge::language_suite::Suite::set_tracee_cpus()
+    std::optional<std::string> tracee_cpus = std::nullopt;
+    // If set, the C++ solutions and checkers are compiled using these precompiled headers
+    std::optional<judge::language_suite::Cpp_GCC::PrecompiledHeaders> cpp_precompiled_headers =
+        std::nullopt;
 };
 
 /**
@@ -428,6 +462,18 @@ class JudgeWorker {
     std::chrono::nanoseconds checker_time_limit;
     uint64_t checker_memory_limit_in_bytes;
     double score_cut_lambda; // has to be from [0, 1]
+    size_t max_concurrently_judged_tests;
+    sandbox::SupervisorPool* supervisor_pool;
+    bool abort_on_wrong_answer;
+    bool judge_initial_and_final_concurrently;
+    std::optional<std::string> tracee_cpus;
+    std::optional<judge::language_suite::Cpp_GCC::PrecompiledHeaders> cpp_precompiled_headers;
+
+    [[nodiscard]] size_t max_concurrent_runs() const noexcept;
+
+    // Obtains the supervisors released by release_supervisors() before the runs are issued from
+    // different threads
+    void obtain_supervisors_for_concurrent_runs() const;
 
 public:
     explicit JudgeWorker(JudgeWorkerOptions options = {});
@@ -440,8 +486,14 @@ public:
     ~JudgeWorker() = default;
 
     /// Loads package from @p package_path using @p simfile (if not specified,
-    /// uses one found in the package)
-    void load_package(FilePath package_path, std::optional<std::string> simfile);
+    /// uses one found in the package). If @p cache is provided, files extracted from the zip
+    /// package are kept in it under @p cached_name that has to identify the package contents.
+    void load_package(
+        FilePath package_path,
+        std::optional<std::string> simfile,
+        judge::PackageFilesCache* cache = nullptr,
+        std::optional<std::string> cached_name = std::nullopt
+    );
 
     // Returns a reference to the loaded package's Simfile
     Simfile& simfile() noexcept { return sf; }
@@ -449,7 +501,16 @@ public:
     // Returns a const reference to the loaded package's Simfile
     [[nodiscard]] const Simfile& simfile() const noexcept { return sf; }
 
-    /// Compiles checker
+    // Changes JudgeWorkerOptions::tracee_cpus, also for the already compiled checker and solution
+    void set_tracee_cpus(const std::optional<std::string>& cpus);
+
+    // Releases the supervisors of the compiled checker and solution (leased ones return to
+    // JudgeWorkerOptions::supervisor_pool), e.g. while the JudgeWorker waits for the next solution.
+    // The compiled checker and solution are kept and the supervisors are obtained again on their
+    // next use.
+    void release_supervisors();
+
+    /// Compiles checker (the default checker is run in-process, so it needs no compilation)
     int compile_checker(
         std::chrono::nanoseconds time_limit,
         uint64_t compiler_memory_limit_in_bytes,
@@ -459,7 +520,21 @@ public:
         std::optional<std::string> cached_name = std::nullopt
     );
 
-    /// Compiles solution
+    /// Compiles checker like compile_checker() but in another thread, so that the solution can be
+    /// compiled at the same time with compile_solution() (only with that method). @p c_errors has
+    /// to be valid until the returned future is ready.
+    [[nodiscard]] std::future<int> async_compile_checker(
+        std::chrono::nanoseconds time_limit,
+        uint64_t compiler_memory_limit_in_bytes,
+        std::string* c_errors,
+        size_t c_errors_max_len,
+        judge::CompilationCache* cache = nullptr,
+        std::optional<std::string> cached_name = std::nullopt
+    );
+
+    /// Compiles solution. If @p content_addressed_cache is true, the executable is cached under
+    /// @p cached_name followed by the hash of the source, the compiler and its flags, so that e.g.
+    /// identical resubmissions and rejudged submissions are not compiled again.
     int compile_solution(
         FilePath source,
         SolutionLanguage lang,
@@ -468,9 +543,15 @@ public:
         std::string* c_errors,
         size_t c_errors_max_len,
         judge::CompilationCache* cache = nullptr,
-        std::optional<std::string> cached_name = std::nullopt
+        std::optional<std::string> cached_name = std::nullopt,
+        bool content_addressed_cache = false
     );
 
+    // Identifies the compiler of the compiled solution and its flags, see
+    // judge::language_suite::FullyCompiledLanguage::compiler_identity(). Empty for the interpreted
+    // languages and if no solution is compiled.
+    [[nodiscard]] std::string solution_compiler_identity() const;
+
     /// Compiles solution
     /// @p source should be a path in package main dir e.g. If main dir ==
     /// "foo/" and solution has path "foo/bar/test", then @p source should be
@@ -516,7 +597,29 @@ public:
         uint64_t memory_limit_in_bytes
     ) const;
 
+    struct TestResult {
+        JudgeReport::Test report;
+        judge::TestReport judge_report;
+    };
+
+    // The subsequent judgments reuse @p tests (test name => result), e.g. saved by a judgment
+    // interrupted by a restart, instead of judging these tests again. The caller is responsible for
+    // them coming from the same solution and package.
+    void set_judged_tests(std::map<std::string, TestResult, std::less<>> tests) {
+        judged_tests = std::move(tests);
+    }
+
+    // The subsequent judgments call @p callback with the result of every judged test (but not of
+    // the reused ones, see set_judged_tests()). It may be called from different threads at the same
+    // time.
+    void set_test_judged_callback(std::function<void(const TestResult&)> callback) {
+        test_judged_callback = std::move(callback);
+    }
+
 private:
+    std::map<std::string, TestResult, std::less<>> judged_tests;
+    std::function<void(const TestResult&)> test_judged_callback;
+
     template <class Func>
     JudgeReport process_tests(
         bool final,
@@ -525,6 +628,16 @@ private:
         Func&& judge_on_test
     ) const;
 
+    // Accesses to package_loader of judgings that run at the same time are synchronized with
+    // @p package_loader_mutex. Once @p cancelled is set, judging of every next test throws.
+    JudgeReport judge(
+        bool final,
+        JudgeLogger& judge_log,
+        const std::optional<std::function<void(const JudgeReport&)>>& partial_report_callback,
+        std::mutex& package_loader_mutex,
+        const std::atomic<bool>& cancelled
+    ) const;
+
 public:
     /**
      * @brief Judges last compiled solution on the last loaded package.
@@ -545,6 +658,24 @@ public:
         VerboseJudgeLogger logger;
         return judge(final, logger);
     }
+
+    /**
+     * @brief Judges last compiled solution on the initial and then the final tests.
+     * @details The same as calling judge() for the initial and then for the final tests, but with
+     *   JudgeWorkerOptions::judge_initial_and_final_concurrently the final tests are judged in
+     *   another thread at the same time as the initial ones. Either way, @p report_callback is
+     *   called only from the calling thread and every initial report is passed to it before any
+     *   final one.
+     *
+     * @param report_callback called as report_callback(report, final, partial) with every partial
+     *   report and then with the complete report of the initial and then of the final tests
+     * @return The initial and the final judge reports
+     */
+    std::pair<JudgeReport, JudgeReport> judge_initial_and_final(
+        JudgeLogger& initial_judge_log,
+        JudgeLogger& final_judge_log,
+        const std::function<void(const JudgeReport&, bool final, bool partial)>& report_callback
+    ) const;
 };
 
 } // namespace sim
@@ -1,6 +1,7 @@
 #include "../../communication/client_supervisor.hh"
 #include "serialize.hh"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
@@ -9,6 +10,7 @@
 #include <memory>
 #include <simlib/array_vec.hh>
 #include <simlib/contains.hh>
+#include <simlib/ctype.hh>
 #include <simlib/macros/throw.hh>
 #include <simlib/overloaded.hh>
 #include <simlib/sandbox/sandbox.hh>
@@ -193,6 +195,7 @@ void serialize(Writer<phase>& writer, const RequestOptions::Cgroup& cg) {
             {cg.memory_limit_in_bytes.has_value(), cgroup::mask::memory_limit_in_bytes},
             {cg.swap_limit_in_bytes.has_value(), cgroup::mask::swap_limit_in_bytes},
             {cg.cpu_max_bandwidth.has_value(), cgroup::mask::cpu_max_bandwidth},
+            {cg.cpuset_cpus.has_value(), cgroup::mask::cpuset_cpus},
         }, as<cgroup::mask_t>);
     if (cg.process_num_limit) {
         writer.write(*cg.process_num_limit, as<cgroup::process_num_limit_t>);
@@ -206,6 +209,16 @@ void serialize(Writer<phase>& writer, const RequestOptions::Cgroup& cg) {
     if (cg.cpu_max_bandwidth) {
         serialize(writer, *cg.cpu_max_bandwidth);
     }
+    if (cg.cpuset_cpus) {
+        // Validate here, as an invalid request makes the supervisor die
+        auto is_valid_char = [](char c) { return is_digit(c) || c == '-' || c == ','; };
+        if (cg.cpuset_cpus->empty() ||
+            !std::all_of(cg.cpuset_cpus->begin(), cg.cpuset_cpus->end(), is_valid_char))
+        {
+            THROW("invalid cpuset_cpus: ", *cg.cpuset_cpus);
+        }
+        serialize_as_null_terminated(writer, *cg.cpuset_cpus);
+    }
 }
 
 template <Phase phase>
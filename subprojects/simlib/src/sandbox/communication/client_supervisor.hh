@@ -12,6 +12,12 @@ constexpr inline bool is_superset_of = std::is_integral_v<A> && std::is_integral
     std::numeric_limits<A>::min() <= std::numeric_limits<B>::min() &&
     std::numeric_limits<A>::max() >= std::numeric_limits<B>::max();
 
+// Sent once by the client, before any request
+namespace handshake {
+using max_concurrent_requests_t = uint32_t;
+static constexpr max_concurrent_requests_t max_concurrent_requests_limit = 1024;
+} // namespace handshake
+
 namespace request {
 using body_len_t = uint64_t;
 
@@ -111,6 +117,7 @@ static constexpr mask_t process_num_limit = 1 << 0;
 static constexpr mask_t memory_limit_in_bytes = 1 << 1;
 static constexpr mask_t swap_limit_in_bytes = 1 << 2;
 static constexpr mask_t cpu_max_bandwidth = 1 << 3;
+static constexpr mask_t cpuset_cpus = 1 << 4;
 } // namespace mask
 
 using process_num_limit_t = uint32_t;
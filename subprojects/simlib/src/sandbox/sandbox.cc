@@ -8,6 +8,7 @@
 #include <exception>
 #include <fcntl.h>
 #include <optional>
+#include <poll.h>
 #include <simlib/errmsg.hh>
 #include <simlib/file_contents.hh>
 #include <simlib/file_descriptor.hh>
@@ -59,6 +60,22 @@ static void write_file(int error_fd, FilePath file_path, StringView data) noexce
     }
 }
 
+// Does nothing if the controller is unavailable, e.g. not delegated to the user
+static void enable_optional_controller(
+    int error_fd, FilePath subtree_control_path, StringView controller
+) noexcept {
+    auto fd = open(subtree_control_path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (fd == -1) {
+        sandbox::do_die_with_error(error_fd, "open(", subtree_control_path, ")");
+    }
+    if (write_all(fd, controller) != controller.size() && errno != ENOENT) {
+        sandbox::do_die_with_error(error_fd, "write(", subtree_control_path, ")");
+    }
+    if (close(fd)) {
+        sandbox::do_die_with_error(error_fd, "close()");
+    }
+}
+
 namespace sandbox {
 
 [[noreturn]] void execute_supervisor(int error_fd, int sock_fd) noexcept {
@@ -270,6 +287,8 @@ namespace sandbox {
             cgroup_path.resize(cgroup_path.size() - std::strlen("others/cgroup.procs"));
             cgroup_path += "cgroup.subtree_control"; // won't throw
             write_file(error_fd, cgroup_path.c_str(), "+pids +memory +cpu");
+            // Needed only for pinning tracees to CPUs
+            enable_optional_controller(error_fd, cgroup_path.c_str(), "+cpuset");
             // Execute the supervisor
             char argv0[] = "";
             auto sock_as_str = to_string(sock_fd);
@@ -313,7 +332,18 @@ namespace sandbox {
     do_die_with_error(error_fd, "execveat()");
 }
 
-SupervisorConnection spawn_supervisor() {
+SupervisorConnection spawn_supervisor(const SupervisorOptions& options) {
+    namespace handshake = communication::client_supervisor::handshake;
+    if (options.max_concurrent_requests == 0 ||
+        options.max_concurrent_requests > handshake::max_concurrent_requests_limit)
+    {
+        THROW(
+            "max_concurrent_requests has to be in range [1, ",
+            handshake::max_concurrent_requests_limit,
+            "]"
+        );
+    }
+
     int supervisor_error_fd = memfd_create("sandbox supervisor errors", MFD_CLOEXEC);
     if (supervisor_error_fd == -1) {
         THROW("memfd_create()", errmsg());
@@ -330,6 +360,20 @@ SupervisorConnection spawn_supervisor() {
     int sock_fd = sock_fds[0];
     int supervisor_sock_fd = sock_fds[1];
 
+    // The supervisor will receive it once it starts
+    if (send_as_bytes(
+            sock_fd,
+            MSG_NOSIGNAL,
+            static_cast<handshake::max_concurrent_requests_t>(options.max_concurrent_requests)
+        ))
+    {
+        int errnum = errno;
+        (void)close(supervisor_sock_fd);
+        (void)close(sock_fd);
+        (void)close(supervisor_error_fd);
+        THROW("send()", errmsg(errnum));
+    }
+
     // Sadly, we cannot use clone3() with .flags == CLONE_PIDFD because it causes malloc() to hang
     // indefinitely occasionally in the child process if the parent process (the current process) is
     // multi-threaded.
@@ -471,6 +515,7 @@ SupervisorConnection::RequestHandle SupervisorConnection::do_send_request(
         handle_send_error("send()");
     }
 
+    ++sent_requests_num_;
     if (result_pipe->writable.close()) {
         THROW("close()", errmsg());
     }
@@ -587,6 +632,23 @@ Result SupervisorConnection::await_result(RequestHandle&& request_handle) {
     };
 }
 
+bool SupervisorConnection::is_healthy() const noexcept {
+    if (supervisor_is_dead_and_waited() || sock_fd == -1) {
+        return false;
+    }
+    // pidfd becomes readable when the process dies
+    pollfd pfd = {
+        .fd = supervisor_pidfd,
+        .events = POLLIN,
+        .revents = 0,
+    };
+    if (poll(&pfd, 1, 0) != 0) {
+        return false;
+    }
+    // The supervisor writes to the error fd only before dying
+    return lseek64(supervisor_error_fd, 0, SEEK_CUR) == 0;
+}
+
 void SupervisorConnection::kill_and_wait_supervisor() noexcept {
     (void)syscalls::pidfd_send_signal(supervisor_pidfd, SIGKILL, nullptr, 0);
     // Try to wait the supervisor process, otherwise it will become zombie until this process dies
@@ -1,6 +1,8 @@
+#include <cerrno>
 #include <seccomp.h>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
 #include <simlib/sandbox/seccomp/bpf_builder.hh>
+#include <simlib/sandbox/seccomp/prebuilt_bpf.hh>
 #include <sys/ioctl.h>
 
 namespace sandbox::seccomp {
@@ -257,4 +259,12 @@ void allow_common_safe_syscalls(BpfBuilder& bpf) {
     bpf.allow_syscall(SCMP_SYS(writev));
 }
 
+int common_safe_syscalls_bpf_fd() {
+    return prebuilt_bpf_fd("common_safe_syscalls", [] {
+        auto bpf = BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
+        allow_common_safe_syscalls(bpf);
+        return bpf.export_to_fd();
+    });
+}
+
 } // namespace sandbox::seccomp
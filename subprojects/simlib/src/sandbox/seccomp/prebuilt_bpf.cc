@@ -0,0 +1,32 @@
+#include <fcntl.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <simlib/errmsg.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sandbox/seccomp/prebuilt_bpf.hh>
+#include <string>
+#include <string_view>
+
+namespace sandbox::seccomp {
+
+int prebuilt_bpf_fd(
+    std::string_view policy_name, const std::function<FileDescriptor()>& build_bpf_fd
+) {
+    static std::mutex mutex;
+    static std::map<std::string, FileDescriptor, std::less<>> bpf_fds; // policy name => fd
+
+    std::lock_guard lock{mutex};
+    auto it = bpf_fds.find(policy_name);
+    if (it == bpf_fds.end()) {
+        auto fd = build_bpf_fd();
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)) {
+            THROW("fcntl()", errmsg());
+        }
+        it = bpf_fds.emplace(policy_name, std::move(fd)).first;
+    }
+    return it->second;
+}
+
+} // namespace sandbox::seccomp
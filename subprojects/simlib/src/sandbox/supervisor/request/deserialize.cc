@@ -172,11 +172,13 @@ void deserialize(Reader& reader, Request::Cgroup& cg) {
     bool has_memory_limit_in_bytes;
     bool has_swap_limit_in_bytes;
     bool has_cpu_max_bandwidth;
+    bool has_cpuset_cpus;
     reader.read_flags({
         {has_process_num_limit, cgroup::mask::process_num_limit},
         {has_memory_limit_in_bytes, cgroup::mask::memory_limit_in_bytes},
         {has_swap_limit_in_bytes, cgroup::mask::swap_limit_in_bytes},
         {has_cpu_max_bandwidth, cgroup::mask::cpu_max_bandwidth},
+        {has_cpuset_cpus, cgroup::mask::cpuset_cpus},
     }, from<cgroup::mask_t>);
     reader.read_optional_if(
         cg.process_num_limit, from<cgroup::process_num_limit_t>, has_process_num_limit
@@ -191,6 +193,11 @@ void deserialize(Reader& reader, Request::Cgroup& cg) {
         cg.cpu_max_bandwidth.emplace();
         deserialize(reader, *cg.cpu_max_bandwidth);
     }
+    if (has_cpuset_cpus) {
+        cg.cpuset_cpus = deserialize_cstring_view(reader);
+    } else {
+        cg.cpuset_cpus = std::nullopt;
+    }
 }
 
 void deserialize(Reader& reader, Request::Prlimit& pr) {
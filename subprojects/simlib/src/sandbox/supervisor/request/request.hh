@@ -83,6 +83,7 @@ struct Request {
         };
 
         std::optional<CpuMaxBandwidth> cpu_max_bandwidth;
+        std::optional<CStringView> cpuset_cpus;
     } cgroup;
 
     struct Prlimit {
@@ -269,6 +269,23 @@ recv_request_header_with_fds(std::byte* buff, size_t header_len) noexcept {
     return fds;
 }
 
+[[nodiscard]] size_t recv_max_concurrent_requests() noexcept {
+    namespace handshake = communication::client_supervisor::handshake;
+    handshake::max_concurrent_requests_t max_concurrent_requests;
+    if (recv_bytes_as(SOCK_FD, 0, max_concurrent_requests)) {
+        if (errno == EPIPE) {
+            _exit(0); // No requests
+        }
+        die_with_error("recv()");
+    }
+    if (max_concurrent_requests == 0 ||
+        max_concurrent_requests > handshake::max_concurrent_requests_limit)
+    {
+        die_with_msg("invalid number of max concurrent requests: ", max_concurrent_requests);
+    }
+    return max_concurrent_requests;
+}
+
 request::Request recv_request() noexcept {
     // Receive header
     communication::client_supervisor::request::body_len_t body_len;
@@ -532,21 +549,14 @@ write_file_at_but_expect_write_error(int dirfd, FilePath file_path, StringView d
 }
 
 template <class T>
-static size_t read_file_at_into_number(int dirfd, FilePath file_path) noexcept {
-    auto fd = openat(dirfd, file_path, O_RDONLY | O_CLOEXEC);
-    if (fd < 0) {
-        die_with_error("openat()");
-    }
+static size_t read_fd_into_number(int fd, FilePath file_path) noexcept {
     std::array<char, 24> buff;
     ssize_t len;
     do {
-        len = read(fd, buff.data(), buff.size());
+        len = pread(fd, buff.data(), buff.size(), 0);
     } while (len < 0 && errno == EINTR);
     if (len < 0) {
-        die_with_error("read()");
-    }
-    if (close(fd)) {
-        die_with_error("close()");
+        die_with_error("pread()");
     }
     auto data = StringView{buff.data(), static_cast<size_t>(len)};
     if (data.empty() || data.back() != '\n') {
@@ -560,6 +570,19 @@ static size_t read_file_at_into_number(int dirfd, FilePath file_path) noexcept {
     return *res;
 }
 
+template <class T>
+static size_t read_file_at_into_number(int dirfd, FilePath file_path) noexcept {
+    auto fd = openat(dirfd, file_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        die_with_error("openat()");
+    }
+    auto res = read_fd_into_number<T>(fd, file_path);
+    if (close(fd)) {
+        die_with_error("close()");
+    }
+    return res;
+}
+
 namespace user_namespace {
 
 struct SetupArgs {
@@ -595,37 +618,57 @@ MountNamespace setup() noexcept { return {}; }
 
 namespace cgroups {
 
+// Each concurrently handled request has its own tracee cgroup
+struct TraceeCgroup {
+    int cgroupfs_fd;
+    decltype(noexcept_concat("tracee", size_t{})) path;
+
+    int fd;
+    int kill_fd;
+    int cpu_stat_fd;
+    int memory_peak_fd;
+    bool cpuset_is_enabled;
+    // Resetting memory.peak is possible since Linux 6.12, without it the tracee cgroup cannot be
+    // reused and is recreated for every request
+    bool memory_peak_is_resettable;
+
+    void destroy() noexcept;
+    void create_and_set_up() noexcept;
+    [[nodiscard]] bool is_empty() const noexcept;
+    [[nodiscard]] bool try_reset_peak_memory_usage() noexcept;
+    // Reuses the tracee cgroup if possible, otherwise recreates it
+    void reset() noexcept;
+
+    void write_process_num_limit(optional<uint32_t> process_num_limit) noexcept;
+    void write_memory_limit(optional<uint64_t> memory_limit_in_bytes) noexcept;
+    void write_swap_limit(optional<uint64_t> memory_limit_in_bytes) noexcept;
+    void write_cpu_max(
+        optional<request::Request::Cgroup::CpuMaxBandwidth> cpu_max_bandwidth
+    ) noexcept;
+    void write_cpuset_cpus(optional<CStringView> cpuset_cpus) noexcept;
+
+    [[nodiscard]] bool read_populated() const noexcept;
+    [[nodiscard]] cgroups::CpuTimes read_cpu_times() const noexcept;
+    [[nodiscard]] uint64_t read_current_memory_usage() const noexcept;
+    [[nodiscard]] uint64_t read_peak_memory_usage() const noexcept;
+
+    void set_limits(const request::Request::Cgroup& cg) noexcept;
+};
+
 struct Cgroups {
     const int cgroupfs_fd;
     static constexpr auto supervisor_cgroup_path = StaticCStringBuff{"supervisor"};
     static constexpr auto pid1_cgroup_path = StaticCStringBuff{"pid1"};
-    static constexpr auto tracee_cgroup_path = StaticCStringBuff{"tracee"};
 
     const int pid1_cgroup_fd;
-    int tracee_cgroup_fd;
-    int tracee_cgroup_kill_fd;
-    int tracee_cgroup_cpu_stat_fd;
+    // The cpuset controller is optional, as it is needed only for pinning tracees to CPUs
+    const bool cpuset_is_enabled;
 
     void assert_nsdelegate_is_active() noexcept;
     void assert_process_cannot_cross_ns_root_dir_boundary() noexcept;
     void assert_controller_interface_files_in_ns_root_dir_are_unwritable() const noexcept;
 
-    void destroy_tracee_cgroup() noexcept;
-    void create_and_set_up_tracee_cgroup() noexcept;
-    void reset_tracee_cgroup() noexcept;
-
-    void write_tracee_cgroup_process_num_limit(optional<uint32_t> process_num_limit) noexcept;
-    void write_tracee_cgroup_memory_limit(optional<uint64_t> memory_limit_in_bytes) noexcept;
-    void write_tracee_cgroup_swap_limit(optional<uint64_t> memory_limit_in_bytes) noexcept;
-    void write_tracee_cgroup_cpu_max(
-        optional<request::Request::Cgroup::CpuMaxBandwidth> cpu_max_bandwidth
-    ) noexcept;
-
-    [[nodiscard]] cgroups::CpuTimes read_tracee_cgroup_cpu_times() const noexcept;
-    [[nodiscard]] uint64_t read_tracee_cgroup_current_memory_usage() const noexcept;
-    [[nodiscard]] uint64_t read_tracee_cgroup_peak_memory_usage() const noexcept;
-
-    void set_tracee_limits(const request::Request::Cgroup& cg) noexcept;
+    [[nodiscard]] TraceeCgroup create_tracee_cgroup(size_t id) const noexcept;
 };
 
 Cgroups setup(mount_namespace::MountNamespace& /*required to mount cgroup2*/) noexcept {
@@ -671,6 +714,12 @@ Cgroups setup(mount_namespace::MountNamespace& /*required to mount cgroup2*/) no
 
     // Enable resource controllers
     write_file_at(cgroupfs_fd, "cgroup.subtree_control", "+pids +memory +cpu");
+    auto cpuset_error =
+        write_file_at_but_expect_write_error(cgroupfs_fd, "cgroup.subtree_control", "+cpuset");
+    if (cpuset_error && *cpuset_error != ENOENT) {
+        errno = *cpuset_error;
+        die_with_error("write(cgroup.subtree_control)");
+    }
 
     int pid1_cgroup_fd = openat(cgroupfs_fd, Cgroups::pid1_cgroup_path.c_str(), O_PATH | O_CLOEXEC);
     if (pid1_cgroup_fd < 0) {
@@ -680,12 +729,9 @@ Cgroups setup(mount_namespace::MountNamespace& /*required to mount cgroup2*/) no
     Cgroups cgs = {
         .cgroupfs_fd = cgroupfs_fd,
         .pid1_cgroup_fd = pid1_cgroup_fd,
-        .tracee_cgroup_fd = -1,
-        .tracee_cgroup_kill_fd = -1,
-        .tracee_cgroup_cpu_stat_fd = -1,
+        .cpuset_is_enabled = !cpuset_error,
     };
 
-    cgs.create_and_set_up_tracee_cgroup();
     cgs.assert_nsdelegate_is_active();
     return cgs;
 }
@@ -769,83 +815,135 @@ void Cgroups::assert_controller_interface_files_in_ns_root_dir_are_unwritable()
     }
 }
 
-void Cgroups::create_and_set_up_tracee_cgroup() noexcept {
-    if (mkdirat(cgroupfs_fd, tracee_cgroup_path.c_str(), S_0755)) {
+TraceeCgroup Cgroups::create_tracee_cgroup(size_t id) const noexcept {
+    TraceeCgroup tracee_cgroup = {
+        .cgroupfs_fd = cgroupfs_fd,
+        .path = noexcept_concat("tracee", id),
+        .fd = -1,
+        .kill_fd = -1,
+        .cpu_stat_fd = -1,
+        .memory_peak_fd = -1,
+        .cpuset_is_enabled = cpuset_is_enabled,
+        .memory_peak_is_resettable = false,
+    };
+    tracee_cgroup.create_and_set_up();
+    return tracee_cgroup;
+}
+
+void TraceeCgroup::create_and_set_up() noexcept {
+    if (mkdirat(cgroupfs_fd, path.c_str(), S_0755)) {
         die_with_error("mkdirat()");
     }
-    tracee_cgroup_fd = openat(cgroupfs_fd, tracee_cgroup_path.c_str(), O_PATH | O_CLOEXEC);
-    if (tracee_cgroup_fd < 0) {
+    fd = openat(cgroupfs_fd, path.c_str(), O_PATH | O_CLOEXEC);
+    if (fd < 0) {
         die_with_error("openat()");
     }
-    tracee_cgroup_kill_fd = openat(tracee_cgroup_fd, "cgroup.kill", O_WRONLY | O_CLOEXEC);
-    if (tracee_cgroup_kill_fd < 0) {
+    kill_fd = openat(fd, "cgroup.kill", O_WRONLY | O_CLOEXEC);
+    if (kill_fd < 0) {
         die_with_error("openat()");
     }
-    tracee_cgroup_cpu_stat_fd = openat(tracee_cgroup_fd, "cpu.stat", O_RDONLY | O_CLOEXEC);
-    if (tracee_cgroup_cpu_stat_fd < 0) {
+    cpu_stat_fd = openat(fd, "cpu.stat", O_RDONLY | O_CLOEXEC);
+    if (cpu_stat_fd < 0) {
         die_with_error("openat()");
     }
+    // Writing to memory.peak resets the peak reported by reads through the same file descriptor.
+    // On older kernels memory.peak is read-only.
+    memory_peak_fd = openat(fd, "memory.peak", O_RDWR | O_CLOEXEC);
+    memory_peak_is_resettable = memory_peak_fd >= 0;
+    if (!memory_peak_is_resettable) {
+        if (errno != EACCES) {
+            die_with_error("openat()");
+        }
+        memory_peak_fd = openat(fd, "memory.peak", O_RDONLY | O_CLOEXEC);
+        if (memory_peak_fd < 0) {
+            die_with_error("openat()");
+        }
+    }
     // Disable PSI accounting to reduce the sandboxing overhead
-    write_file_at(tracee_cgroup_fd, "cgroup.pressure", "0");
+    write_file_at(fd, "cgroup.pressure", "0");
 }
 
-void Cgroups::destroy_tracee_cgroup() noexcept {
-    if (close(tracee_cgroup_fd)) {
+void TraceeCgroup::destroy() noexcept {
+    if (close(fd)) {
+        die_with_error("close()");
+    }
+    fd = -1;
+    if (close(kill_fd)) {
         die_with_error("close()");
     }
-    tracee_cgroup_fd = -1;
-    if (close(tracee_cgroup_kill_fd)) {
+    kill_fd = -1;
+    if (close(cpu_stat_fd)) {
         die_with_error("close()");
     }
-    tracee_cgroup_kill_fd = -1;
-    if (close(tracee_cgroup_cpu_stat_fd)) {
+    cpu_stat_fd = -1;
+    if (close(memory_peak_fd)) {
         die_with_error("close()");
     }
-    tracee_cgroup_cpu_stat_fd = -1;
+    memory_peak_fd = -1;
 
-    if (unlinkat(cgroupfs_fd, tracee_cgroup_path.c_str(), AT_REMOVEDIR)) {
+    if (unlinkat(cgroupfs_fd, path.c_str(), AT_REMOVEDIR)) {
         die_with_error("unlinkat()");
     }
 }
 
-void Cgroups::reset_tracee_cgroup() noexcept {
-    destroy_tracee_cgroup();
-    create_and_set_up_tracee_cgroup();
+bool TraceeCgroup::is_empty() const noexcept {
+    // Memory charged to the cgroup after the tracee died (e.g. files created by the tracee on
+    // tmpfs) would offset the memory limit of the next tracee
+    return !read_populated() && read_current_memory_usage() == 0;
+}
+
+// NOLINTNEXTLINE(readability-make-member-function-const)
+bool TraceeCgroup::try_reset_peak_memory_usage() noexcept {
+    // Writing any non-empty string resets the peak to the current memory usage
+    return write_all(memory_peak_fd, "0", 1) == 1;
+}
+
+void TraceeCgroup::reset() noexcept {
+    // Limits are rewritten by set_limits() anyway and the cpu times are measured relative to the
+    // tracee's start, so only the peak memory usage needs resetting. The cgroup is reused only if
+    // the tracee left nothing charged to it, so the runs that write files (e.g. compilations or
+    // judged runs writing their output to a file) gain nothing: the page cache of the written files
+    // stays charged and the cgroup is recreated as before.
+    if (memory_peak_is_resettable && is_empty() && try_reset_peak_memory_usage()) {
+        return;
+    }
+    destroy();
+    create_and_set_up();
 }
 
 // NOLINTNEXTLINE(readability-make-member-function-const)
-void Cgroups::write_tracee_cgroup_process_num_limit(optional<uint32_t> process_num_limit) noexcept {
+void TraceeCgroup::write_process_num_limit(optional<uint32_t> process_num_limit) noexcept {
     write_file_at(
-        tracee_cgroup_fd,
+        fd,
         "pids.max",
         process_num_limit ? StringView{from_unsafe{to_string(*process_num_limit)}} : "max"
     );
 }
 
 // NOLINTNEXTLINE(readability-make-member-function-const)
-void Cgroups::write_tracee_cgroup_memory_limit(optional<uint64_t> memory_limit_in_bytes) noexcept {
+void TraceeCgroup::write_memory_limit(optional<uint64_t> memory_limit_in_bytes) noexcept {
     write_file_at(
-        tracee_cgroup_fd,
+        fd,
         "memory.max",
         memory_limit_in_bytes ? StringView{from_unsafe{to_string(*memory_limit_in_bytes)}} : "max"
     );
 }
 
 // NOLINTNEXTLINE(readability-make-member-function-const)
-void Cgroups::write_tracee_cgroup_swap_limit(optional<uint64_t> swap_limit_in_bytes) noexcept {
+void TraceeCgroup::write_swap_limit(optional<uint64_t> swap_limit_in_bytes) noexcept {
     write_file_at(
-        tracee_cgroup_fd,
+        fd,
         "memory.swap.max",
         swap_limit_in_bytes ? StringView{from_unsafe{to_string(*swap_limit_in_bytes)}} : "max"
     );
 }
 
 // NOLINTNEXTLINE(readability-make-member-function-const)
-void Cgroups::write_tracee_cgroup_cpu_max(
+void TraceeCgroup::write_cpu_max(
     optional<request::Request::Cgroup::CpuMaxBandwidth> cpu_max_bandwidth
 ) noexcept {
     write_file_at(
-        tracee_cgroup_fd,
+        fd,
         "cpu.max",
         cpu_max_bandwidth ? StringView{from_unsafe{noexcept_concat(
                                 cpu_max_bandwidth->max_usec, ' ', cpu_max_bandwidth->period_usec
@@ -854,26 +952,65 @@ void Cgroups::write_tracee_cgroup_cpu_max(
     );
 }
 
-cgroups::CpuTimes Cgroups::read_tracee_cgroup_cpu_times() const noexcept {
-    return read_cpu_times(tracee_cgroup_cpu_stat_fd, [] [[noreturn]] (auto&&... msg) {
+// NOLINTNEXTLINE(readability-make-member-function-const)
+void TraceeCgroup::write_cpuset_cpus(optional<CStringView> cpuset_cpus) noexcept {
+    if (!cpuset_is_enabled) {
+        if (cpuset_cpus) {
+            die_with_msg("cannot set cpuset_cpus: the cpuset cgroup controller is unavailable");
+        }
+        return;
+    }
+    // Empty cpuset.cpus means using the CPUs of the parent cgroup
+    write_file_at(fd, "cpuset.cpus", cpuset_cpus ? StringView{*cpuset_cpus} : "\n");
+}
+
+bool TraceeCgroup::read_populated() const noexcept {
+    auto events_fd = openat(fd, "cgroup.events", O_RDONLY | O_CLOEXEC);
+    if (events_fd < 0) {
+        die_with_error("openat()");
+    }
+    std::array<char, sizeof("populated 0\nfrozen 0\n") - 1> buff;
+    ssize_t len;
+    do {
+        len = read(events_fd, buff.data(), buff.size());
+    } while (len < 0 && errno == EINTR);
+    if (len < 0) {
+        die_with_error("read()");
+    }
+    if (close(events_fd)) {
+        die_with_error("close()");
+    }
+    auto data = StringView{buff.data(), static_cast<size_t>(len)};
+    if (has_prefix(data, "populated 0\n")) {
+        return false;
+    }
+    if (has_prefix(data, "populated 1\n")) {
+        return true;
+    }
+    die_with_msg("cgroup.events: unexpected contents: ", data);
+}
+
+cgroups::CpuTimes TraceeCgroup::read_cpu_times() const noexcept {
+    return cgroups::read_cpu_times(cpu_stat_fd, [] [[noreturn]] (auto&&... msg) {
         die_with_msg("read_cpu_times(): ", std::forward<decltype(msg)>(msg)...);
     });
 }
 
-uint64_t Cgroups::read_tracee_cgroup_current_memory_usage() const noexcept {
-    return read_file_at_into_number<uint64_t>(tracee_cgroup_fd, "memory.current");
+uint64_t TraceeCgroup::read_current_memory_usage() const noexcept {
+    return read_file_at_into_number<uint64_t>(fd, "memory.current");
 }
 
-uint64_t Cgroups::read_tracee_cgroup_peak_memory_usage() const noexcept {
-    return read_file_at_into_number<uint64_t>(tracee_cgroup_fd, "memory.peak");
+uint64_t TraceeCgroup::read_peak_memory_usage() const noexcept {
+    return read_fd_into_number<uint64_t>(memory_peak_fd, "memory.peak");
 }
 
-void Cgroups::set_tracee_limits(const request::Request::Cgroup& cg) noexcept {
-    write_tracee_cgroup_process_num_limit(cg.process_num_limit);
-    assert(read_tracee_cgroup_current_memory_usage() == 0 && "Needed to not offset limit by this");
-    write_tracee_cgroup_memory_limit(cg.memory_limit_in_bytes);
-    write_tracee_cgroup_swap_limit(cg.swap_limit_in_bytes);
-    write_tracee_cgroup_cpu_max(cg.cpu_max_bandwidth);
+void TraceeCgroup::set_limits(const request::Request::Cgroup& cg) noexcept {
+    write_process_num_limit(cg.process_num_limit);
+    assert(read_current_memory_usage() == 0 && "Needed to not offset limit by this");
+    write_memory_limit(cg.memory_limit_in_bytes);
+    write_swap_limit(cg.swap_limit_in_bytes);
+    write_cpu_max(cg.cpu_max_bandwidth);
+    write_cpuset_cpus(cg.cpuset_cpus);
 }
 
 } // namespace cgroups
@@ -1010,63 +1147,161 @@ Fds open_fds() noexcept {
 
 } // namespace killing_request
 
-enum class [[nodiscard]] WaitRes {
-    PIDFD_READABLE,
-    REQUEST_CANCELLED,
-    KILL_TRACEE,
+struct RequestSlot {
+    volatile communication::supervisor_pid1_tracee::SharedMemState* shared_mem_state;
+    cgroups::TraceeCgroup tracee_cgroup;
+
+    bool is_busy;
+    // Fields below are valid only if is_busy == true
+    int pid1_pidfd;
+    int result_fd;
+    int kill_tracee_fd;
+    int fd_to_wait_on_for_tracee_execve;
+    bool is_cancelled;
+
+    enum class TraceeKilling {
+        NOT_REQUESTED,
+        // Killing the tracee cgroup before the tracee is placed in it would have no effect
+        AWAITING_TRACEE_EXECVE,
+        DONE,
+    } tracee_killing;
 };
 
-// Waits for pid1 death or read and write shutdown of the other end of the SOCK_FD (we can't wait
-// only for the read-close)
-WaitRes wait_for_pid1_death_or_sock_fd_shutdown_or_result_fd_error_or_kill_fd(
-    int pid1_pidfd, int result_fd, int kill_tracee_fd
-) noexcept {
-    std::array<pollfd, 4> pfds;
-    auto& sock_fd_pfd = pfds[0];
-    auto& pidfd_pfd = pfds[1];
-    auto& response_pfd = pfds[2];
-    auto& kill_tracee_pfd = pfds[3];
-    sock_fd_pfd = {
-        .fd = SOCK_FD,
-        .events = 0, // wait for POLLHUP i.e. both read and write shutdown of the other end
-        .revents = 0,
-    };
+[[nodiscard]] std::unique_ptr<RequestSlot[]>
+create_request_slots(size_t slots_num, const cgroups::Cgroups& cgroups) noexcept {
+    std::unique_ptr<RequestSlot[]> slots;
+    try {
+        slots = std::make_unique<RequestSlot[]>(slots_num);
+    } catch (...) {
+        die_with_msg("create_request_slots(): failed to allocate memory");
+    }
+    namespace sms = communication::supervisor_pid1_tracee;
+    for (size_t i = 0; i < slots_num; ++i) {
+        auto shared_mem_state_raw = mmap(
+            nullptr,
+            sizeof(sms::SharedMemState),
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS,
+            -1,
+            0
+        );
+        // NOLINTNEXTLINE(performance-no-int-to-ptr)
+        if (shared_mem_state_raw == MAP_FAILED) {
+            die_with_error("mmap()");
+        }
+        slots[i] = {
+            .shared_mem_state = sms::initialize(shared_mem_state_raw),
+            .tracee_cgroup = cgroups.create_tracee_cgroup(i),
+            .is_busy = false,
+            .pid1_pidfd = -1,
+            .result_fd = -1,
+            .kill_tracee_fd = -1,
+            .fd_to_wait_on_for_tracee_execve = -1,
+            .is_cancelled = false,
+            .tracee_killing = RequestSlot::TraceeKilling::NOT_REQUESTED,
+        };
+    }
+    return slots;
+}
+
+// Fills the 3 pollfds used to wait for the events of the request handled in the slot
+void set_request_slot_pfds(const RequestSlot& slot, pollfd* pfds) noexcept {
+    auto& pidfd_pfd = pfds[0];
+    auto& response_pfd = pfds[1];
+    auto& kill_tracee_pfd = pfds[2];
+    // poll() ignores negative file descriptors
     pidfd_pfd = {
-        .fd = pid1_pidfd,
+        .fd = slot.is_busy ? slot.pid1_pidfd : -1,
         .events = POLLIN,
         .revents = 0,
     };
     response_pfd = {
-        .fd = result_fd,
+        .fd = slot.is_busy && !slot.is_cancelled ? slot.result_fd : -1,
         .events = 0, // wait for POLLERR i.e. read end of the response pipe was closed
         .revents = 0,
     };
     kill_tracee_pfd = {
-        .fd = kill_tracee_fd,
+        .fd = -1,
         .events = POLLIN,
         .revents = 0,
     };
-    for (;;) {
-        int rc = poll(pfds.data(), pfds.size(), -1);
-        if (rc == 0 || (rc == -1 && errno == EINTR)) {
-            continue;
-        }
-        if (rc == -1) {
-            die_with_error("poll()");
-        }
-        if (sock_fd_pfd.revents & POLLHUP) {
-            // Probably the client process died and we are still alive, but we cannot
-            // communicate with the client anymore, so die early to save resources.
-            die_with_msg("the other end of the socket was closed");
-        }
-        if (pidfd_pfd.revents & POLLIN) {
-            return WaitRes::PIDFD_READABLE; // pid1 process is waitable
+    if (slot.is_busy && !slot.is_cancelled) {
+        switch (slot.tracee_killing) {
+        case RequestSlot::TraceeKilling::NOT_REQUESTED: {
+            kill_tracee_pfd.fd = slot.kill_tracee_fd;
+        } break;
+        case RequestSlot::TraceeKilling::AWAITING_TRACEE_EXECVE: {
+            // POLLHUP is reported once the other end is closed
+            kill_tracee_pfd.fd = slot.fd_to_wait_on_for_tracee_execve;
+        } break;
+        case RequestSlot::TraceeKilling::DONE: break;
         }
-        if (response_pfd.revents & POLLERR) {
-            return WaitRes::REQUEST_CANCELLED; // read end of the response pipe was closed
+    }
+}
+
+void finish_request(RequestSlot& slot) noexcept {
+    siginfo_t si;
+    syscalls::waitid(P_PIDFD, slot.pid1_pidfd, &si, __WALL | WEXITED, nullptr);
+
+    if (!slot.is_cancelled) {
+        read_shared_mem_state_and_send_response(
+            slot.shared_mem_state,
+            Si{
+                .code = si.si_code,
+                .status = si.si_status,
+            },
+            slot.tracee_cgroup.read_cpu_times(),
+            slot.tracee_cgroup.read_peak_memory_usage(),
+            slot.result_fd
+        );
+    }
+
+    if (close(slot.pid1_pidfd)) {
+        die_with_error("close()");
+    }
+    if (close(slot.result_fd)) {
+        die_with_error("close()");
+    }
+    if (close(slot.kill_tracee_fd)) {
+        die_with_error("close()");
+    }
+    if (close(slot.fd_to_wait_on_for_tracee_execve)) {
+        die_with_error("close()");
+    }
+    slot.is_busy = false;
+
+    communication::supervisor_pid1_tracee::reset(slot.shared_mem_state);
+    slot.tracee_cgroup.reset();
+}
+
+void handle_request_slot_events(RequestSlot& slot, const pollfd* pfds) noexcept {
+    const auto& pidfd_pfd = pfds[0];
+    const auto& response_pfd = pfds[1];
+    const auto& kill_tracee_pfd = pfds[2];
+    if (pidfd_pfd.revents & POLLIN) {
+        finish_request(slot); // pid1 process is waitable
+        return;
+    }
+    if (response_pfd.revents & POLLERR) {
+        // Read end of the response pipe was closed
+        if (syscalls::pidfd_send_signal(slot.pid1_pidfd, SIGKILL, nullptr, 0)) {
+            die_with_error("pidfd_send_signal()");
         }
-        if (kill_tracee_pfd.revents & POLLIN) {
-            return WaitRes::KILL_TRACEE;
+        slot.is_cancelled = true;
+        return;
+    }
+    if (kill_tracee_pfd.revents & (POLLIN | POLLHUP)) {
+        switch (slot.tracee_killing) {
+        case RequestSlot::TraceeKilling::NOT_REQUESTED: {
+            slot.tracee_killing = RequestSlot::TraceeKilling::AWAITING_TRACEE_EXECVE;
+        } break;
+        case RequestSlot::TraceeKilling::AWAITING_TRACEE_EXECVE: {
+            if (write(slot.tracee_cgroup.kill_fd, "1", 1) < 0) {
+                die_with_error("write()");
+            }
+            slot.tracee_killing = RequestSlot::TraceeKilling::DONE;
+        } break;
+        case RequestSlot::TraceeKilling::DONE: break;
         }
     }
 }
@@ -1079,21 +1314,8 @@ void main(int argc, char** argv) noexcept {
     set_process_name();
     close_all_stray_file_descriptors();
     replace_stdin_stdout_stderr_with_dev_null();
+    auto max_concurrent_requests = recv_max_concurrent_requests();
 
-    namespace sms = communication::supervisor_pid1_tracee;
-    auto shared_mem_state_raw = mmap(
-        nullptr,
-        sizeof(sms::SharedMemState),
-        PROT_READ | PROT_WRITE,
-        MAP_SHARED | MAP_ANONYMOUS,
-        -1,
-        0
-    );
-    // NOLINTNEXTLINE(performance-no-int-to-ptr)
-    if (shared_mem_state_raw == MAP_FAILED) {
-        die_with_error("mmap()");
-    }
-    auto shared_mem_state = sms::initialize(shared_mem_state_raw);
     auto supervisor_pidfd = syscalls::pidfd_open(getpid(), 0);
 
     auto supervisor_outside_euid = geteuid();
@@ -1117,6 +1339,7 @@ void main(int argc, char** argv) noexcept {
     });
     auto mount_ns = mount_namespace::setup();
     auto cgroups = cgroups::setup(mount_ns);
+    auto request_slots = create_request_slots(max_concurrent_requests, cgroups);
     setup_uts_namespace();
 
     capabilities::set_and_lock_all_securebits_for_this_and_all_descendant_processes();
@@ -1126,15 +1349,60 @@ void main(int argc, char** argv) noexcept {
 
     ignore_sigpipe(); // needed for sending responses
 
-    for (;; [&] {
-             sms::reset(shared_mem_state);
-             cgroups.reset_tracee_cgroup();
-         }())
-    {
+    // SOCK_FD followed by 3 pollfds for every request slot
+    std::unique_ptr<pollfd[]> pfds;
+    try {
+        pfds = std::make_unique<pollfd[]>(1 + 3 * max_concurrent_requests);
+    } catch (...) {
+        die_with_msg("failed to allocate memory");
+    }
+    auto& sock_fd_pfd = pfds[0];
+
+    for (;;) {
+        size_t busy_slots_num = 0;
+        RequestSlot* free_slot = nullptr;
+        for (size_t i = 0; i < max_concurrent_requests; ++i) {
+            if (request_slots[i].is_busy) {
+                ++busy_slots_num;
+            } else if (!free_slot) {
+                free_slot = &request_slots[i];
+            }
+            set_request_slot_pfds(request_slots[i], &pfds[1 + 3 * i]);
+        }
+        sock_fd_pfd = {
+            .fd = SOCK_FD,
+            // Without a free slot, wait only for POLLHUP i.e. both read and write shutdown of the
+            // other end
+            .events = static_cast<short>(free_slot ? POLLIN : 0),
+            .revents = 0,
+        };
+
+        int rc = poll(pfds.get(), 1 + 3 * max_concurrent_requests, -1);
+        if (rc == 0 || (rc == -1 && errno == EINTR)) {
+            continue;
+        }
+        if (rc == -1) {
+            die_with_error("poll()");
+        }
+        if ((sock_fd_pfd.revents & POLLHUP) && busy_slots_num > 0) {
+            // Probably the client process died and we are still alive, but we cannot
+            // communicate with the client anymore, so die early to save resources.
+            die_with_msg("the other end of the socket was closed");
+        }
+        for (size_t i = 0; i < max_concurrent_requests; ++i) {
+            if (request_slots[i].is_busy) {
+                handle_request_slot_events(request_slots[i], &pfds[1 + 3 * i]);
+            }
+        }
+        if (!free_slot || !(sock_fd_pfd.revents & POLLIN)) {
+            continue;
+        }
+
+        auto& slot = *free_slot;
         auto request = recv_request();
         auto killing_request_fds = killing_request::open_fds();
 
-        cgroups.set_tracee_limits(request.cgroup);
+        slot.tracee_cgroup.set_limits(request.cgroup);
 
         int pid1_pidfd = 0;
         clone_args cl_args = {};
@@ -1152,7 +1420,7 @@ void main(int argc, char** argv) noexcept {
             constexpr uid_t PID1_USER_NS_INSIDE_UID = 1;
             constexpr uid_t PID1_USER_NS_INSIDE_GID = 1;
             pid1::main({
-                .shared_mem_state = shared_mem_state,
+                .shared_mem_state = slot.shared_mem_state,
                 .executable = request.executable,
                 .stdin_fd = request.stdin_fd,
                 .stdout_fd = request.stdout_fd,
@@ -1161,9 +1429,9 @@ void main(int argc, char** argv) noexcept {
                 .env = std::move(request.env),
                 .supervisor_pidfd = supervisor_pidfd,
                 .fd_to_close_upon_execve = killing_request_fds.fd_to_close_upon_execve,
-                .tracee_cgroup_fd = cgroups.tracee_cgroup_fd,
-                .tracee_cgroup_kill_fd = cgroups.tracee_cgroup_kill_fd,
-                .tracee_cgroup_cpu_stat_fd = cgroups.tracee_cgroup_cpu_stat_fd,
+                .tracee_cgroup_fd = slot.tracee_cgroup.fd,
+                .tracee_cgroup_kill_fd = slot.tracee_cgroup.kill_fd,
+                .tracee_cgroup_cpu_stat_fd = slot.tracee_cgroup.cpu_stat_fd,
                 .linux_namespaces =
                     {
                         .user =
@@ -1214,61 +1482,14 @@ void main(int argc, char** argv) noexcept {
             die_with_error("close()");
         }
 
-        auto wait_res = wait_for_pid1_death_or_sock_fd_shutdown_or_result_fd_error_or_kill_fd(
-            pid1_pidfd, request.result_fd, request.kill_tracee_fd
-        );
-        switch (wait_res) {
-        case WaitRes::PIDFD_READABLE: break;
-        case WaitRes::REQUEST_CANCELLED: {
-            if (syscalls::pidfd_send_signal(pid1_pidfd, SIGKILL, nullptr, 0)) {
-                die_with_error("pidfd_send_signal()");
-            }
-        } break;
-        case WaitRes::KILL_TRACEE: {
-            char c;
-            if (read(killing_request_fds.fd_to_wait_on_for_close_of_the_other_fd, &c, sizeof(c)) <
-                0)
-            {
-                die_with_error("read()");
-            }
-            if (write(cgroups.tracee_cgroup_kill_fd, "1", 1) < 0) {
-                die_with_error("write()");
-            }
-        } break;
-        }
-
-        siginfo_t si;
-        syscalls::waitid(P_PIDFD, pid1_pidfd, &si, __WALL | WEXITED, nullptr);
-
-        switch (wait_res) {
-        case WaitRes::PIDFD_READABLE:
-        case WaitRes::KILL_TRACEE: {
-            read_shared_mem_state_and_send_response(
-                shared_mem_state,
-                Si{
-                    .code = si.si_code,
-                    .status = si.si_status,
-                },
-                cgroups.read_tracee_cgroup_cpu_times(),
-                cgroups.read_tracee_cgroup_peak_memory_usage(),
-                request.result_fd
-            );
-        } break;
-        case WaitRes::REQUEST_CANCELLED: break;
-        }
-
-        if (close(pid1_pidfd)) {
-            die_with_error("close()");
-        }
-        if (close(request.result_fd)) {
-            die_with_error("close()");
-        }
-        if (close(request.kill_tracee_fd)) {
-            die_with_error("close()");
-        }
-        if (close(killing_request_fds.fd_to_wait_on_for_close_of_the_other_fd)) {
-            die_with_error("close()");
-        }
+        slot.is_busy = true;
+        slot.pid1_pidfd = pid1_pidfd;
+        slot.result_fd = request.result_fd;
+        slot.kill_tracee_fd = request.kill_tracee_fd;
+        slot.fd_to_wait_on_for_tracee_execve =
+            killing_request_fds.fd_to_wait_on_for_close_of_the_other_fd;
+        slot.is_cancelled = false;
+        slot.tracee_killing = RequestSlot::TraceeKilling::NOT_REQUESTED;
     }
 }
 
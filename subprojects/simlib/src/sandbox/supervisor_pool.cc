@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <simlib/sandbox/sandbox.hh>
+#include <simlib/sandbox/supervisor_pool.hh>
+#include <utility>
+
+namespace sandbox {
+
+SupervisorPool::SupervisorPool(Options options) : options{options} {
+    // Returning a supervisor to the pool must not allocate
+    idle_scs.reserve(options.max_idle_supervisors);
+}
+
+SupervisorPool::~SupervisorPool() {
+    while (!idle_scs.empty()) {
+        try {
+            auto sc = std::move(idle_scs.back());
+            idle_scs.pop_back();
+        } catch (...) {
+            // Errors of idle supervisors are not related to any request
+        }
+    }
+}
+
+SupervisorPool::Lease::~Lease() noexcept(false) {
+    // During stack unwinding the supervisor may still be handling an abandoned request
+    if (!pool || uncaught_exceptions_in_constructor != std::uncaught_exceptions() ||
+        !pool->is_reusable(*sc))
+    {
+        return; // the supervisor is killed by the destructor of sc
+    }
+
+    std::lock_guard lock{pool->mutex};
+    if (pool->idle_scs.size() < pool->options.max_idle_supervisors) {
+        pool->idle_scs.emplace_back(std::move(*sc));
+    }
+}
+
+SupervisorPool::Lease SupervisorPool::lease() {
+    ++leases_num_;
+    for (;;) {
+        std::optional<SupervisorConnection> sc;
+        {
+            std::lock_guard lock{mutex};
+            if (idle_scs.empty()) {
+                break;
+            }
+            sc.emplace(std::move(idle_scs.back()));
+            idle_scs.pop_back();
+        }
+        if (sc->is_healthy()) {
+            return Lease{*this, std::move(*sc)};
+        }
+        try {
+            auto dead_sc = std::move(*sc);
+        } catch (...) {
+            // The supervisor died while idle, so its error is not related to any request. It is
+            // replaced by another supervisor.
+        }
+    }
+    return Lease{*this, spawn_counted_supervisor()};
+}
+
+void SupervisorPool::warm_up(size_t idle_supervisors_num) {
+    idle_supervisors_num = std::min(idle_supervisors_num, options.max_idle_supervisors);
+    for (;;) {
+        {
+            std::lock_guard lock{mutex};
+            if (idle_scs.size() >= idle_supervisors_num) {
+                return;
+            }
+        }
+        // Spawn without holding the lock
+        auto sc = spawn_counted_supervisor();
+        std::lock_guard lock{mutex};
+        if (idle_scs.size() < options.max_idle_supervisors) {
+            idle_scs.emplace_back(std::move(sc));
+        }
+    }
+}
+
+SupervisorConnection SupervisorPool::spawn_counted_supervisor() {
+    auto sc = spawn_supervisor();
+    ++spawned_supervisors_num_;
+    return sc;
+}
+
+bool SupervisorPool::is_reusable(const SupervisorConnection& sc) const noexcept {
+    if (options.max_requests_per_supervisor != 0 &&
+        sc.sent_requests_num() >= options.max_requests_per_supervisor)
+    {
+        return false;
+    }
+    return sc.is_healthy();
+}
+
+} // namespace sandbox
@@ -1,12 +0,0 @@
-#pragma once
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-extern const unsigned char default_checker_c[];
-extern const unsigned default_checker_c_len;
-
-#ifdef __cplusplus
-}
-#endif
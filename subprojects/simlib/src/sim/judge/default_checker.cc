@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <simlib/errmsg.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sim/judge/default_checker.hh>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using std::string;
+using std::string_view;
+
+namespace {
+
+// Constants below configure how much context is print around the found difference in output.
+// solution answer: ___________________x__________________
+// test out:        ___________________y__________________
+//                  <-- HISTORY_LEN --> <-- FUTURE_LEN -->
+constexpr size_t HISTORY_LEN = 24;
+constexpr size_t FUTURE_LEN = 64;
+constexpr size_t MAX_RESULT_LEN = 512 + HISTORY_LEN + FUTURE_LEN;
+
+static_assert(HISTORY_LEN >= 3);
+static_assert(FUTURE_LEN >= 3);
+
+// Returns the whole file mapped read-only, it has to be unmapped with unmap_file()
+string_view map_file(FilePath path) {
+    auto fd = FileDescriptor{path, O_RDONLY | O_LARGEFILE | O_CLOEXEC};
+    if (!fd.is_open()) {
+        THROW("open(", path, ")", errmsg());
+    }
+    struct stat64 st = {};
+    if (fstat64(fd, &st)) {
+        THROW("fstat64()", errmsg());
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        return {}; // mmap() does not accept empty mappings
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) { // NOLINT(performance-no-int-to-ptr)
+        THROW("mmap()", errmsg());
+    }
+    (void)madvise(data, size, MADV_SEQUENTIAL); // it is only a hint
+    return {static_cast<const char*>(data), size};
+}
+
+void unmap_file(string_view data) noexcept {
+    if (!data.empty()) {
+        (void)munmap(const_cast<char*>(data.data()), data.size()); // NOLINT
+    }
+}
+
+class MappedFile {
+    string_view data_;
+
+public:
+    explicit MappedFile(FilePath path) : data_{map_file(path)} {}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    ~MappedFile() { unmap_file(data_); }
+
+    [[nodiscard]] string_view contents() const noexcept { return data_; }
+};
+
+struct Reader {
+    string_view data;
+    size_t pos = 0;
+
+    [[nodiscard]] bool eof() const noexcept { return pos == data.size(); }
+
+    [[nodiscard]] char cur() const noexcept { return data[pos]; }
+};
+
+struct FileLoc {
+    uint64_t line = 1;
+    uint64_t column = 1;
+
+    void advance(char c) noexcept {
+        if (c == '\n') {
+            ++line;
+            column = 1;
+        } else {
+            ++column;
+        }
+    }
+
+    void advance(string_view str) noexcept {
+        // std::count() gets vectorized, so this is much faster than advancing char by char
+        auto newlines = static_cast<uint64_t>(std::count(str.begin(), str.end(), '\n'));
+        if (newlines == 0) {
+            column += str.size();
+            return;
+        }
+        line += newlines;
+        column = str.size() - str.rfind('\n');
+    }
+};
+
+// Returns the length of the common prefix of @p a and @p b. Blocks are compared using memcmp()
+// that is vectorized in libc, only the differing block is scanned byte by byte.
+size_t common_prefix_len(const char* a, const char* b, size_t len) noexcept {
+    constexpr size_t BLOCK_LEN = 256;
+    size_t i = 0;
+    while (i + BLOCK_LEN <= len && std::memcmp(a + i, b + i, BLOCK_LEN) == 0) {
+        i += BLOCK_LEN;
+    }
+    while (i < len && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+class ResultBuf {
+    string buf;
+
+public:
+    void append(string_view str) { buf.append(str.substr(0, MAX_RESULT_LEN - buf.size())); }
+
+    void append(char c) { append(string_view{&c, 1}); }
+
+    void append(uint64_t x) { append(string_view{std::to_string(x)}); }
+
+    string release() && noexcept { return std::move(buf); }
+};
+
+ResultBuf start_wrong_answer(const FileLoc& ans_loc) {
+    ResultBuf res;
+    res.append("WRONG\n0\nLine ");
+    res.append(ans_loc.line);
+    res.append(" column ");
+    res.append(ans_loc.column);
+    res.append(": ");
+    return res;
+}
+
+struct Histories {
+    string ans;
+    string out;
+};
+
+// Moves @p ans_loc to the beginning of the ans history
+Histories histories_to_print(
+    const Reader& ans, const Reader& out, FileLoc& ans_loc, ptrdiff_t ans_is_this_bytes_ahead
+) {
+    const auto& further_reader = ans_is_this_bytes_ahead >= 0 ? ans : out;
+    size_t longer_history_len = 0;
+    while (longer_history_len < HISTORY_LEN && further_reader.pos > longer_history_len) {
+        char c = further_reader.data[further_reader.pos - longer_history_len - 1];
+        if (c == '\n' || c == ' ') {
+            break;
+        }
+        ++longer_history_len;
+    }
+
+    string longer_history;
+    if (longer_history_len == HISTORY_LEN) {
+        longer_history = "...";
+        longer_history += further_reader.data.substr(
+            further_reader.pos - longer_history_len + 3, longer_history_len - 3
+        );
+    } else {
+        longer_history =
+            further_reader.data.substr(further_reader.pos - longer_history_len, longer_history_len);
+    }
+
+    auto longer_is_ahead_of_shorter_this_bytes_num = static_cast<size_t>(
+        ans_is_this_bytes_ahead >= 0 ? ans_is_this_bytes_ahead : -ans_is_this_bytes_ahead
+    );
+    auto shorter_history = longer_is_ahead_of_shorter_this_bytes_num < longer_history_len
+        ? longer_history.substr(0, longer_history_len - longer_is_ahead_of_shorter_this_bytes_num)
+        : string{};
+
+    if (ans_is_this_bytes_ahead >= 0) {
+        ans_loc.column -=
+            longer_history_len == HISTORY_LEN ? longer_history_len - 3 : longer_history_len;
+        return {.ans = std::move(longer_history), .out = std::move(shorter_history)};
+    }
+    ans_loc.column -= longer_history_len == HISTORY_LEN
+        ? (shorter_history.size() <= 3 ? 0 : shorter_history.size() - 3)
+        : shorter_history.size();
+    return {.ans = std::move(shorter_history), .out = std::move(longer_history)};
+}
+
+// Future starts at @p reader.pos
+string future_to_print(const Reader& reader) {
+    auto rest = reader.data.substr(reader.pos);
+    string future;
+    for (char c : rest) {
+        if (future.size() == FUTURE_LEN) {
+            break;
+        }
+        if (c == '\n') {
+            break;
+        }
+        future += c;
+    }
+    if (future.size() == FUTURE_LEN) {
+        future.replace(FUTURE_LEN - 3, 3, "...");
+    } else {
+        // Trim trailing whitespace not to print it in the context
+        while (!future.empty() && future.back() == ' ') {
+            future.pop_back();
+        }
+    }
+    return future;
+}
+
+// The current char of the longer reader is a non-whitespace character, but the end of line
+// (or the end of file if @p at_eof) was expected
+string unexpected_char_wrong_answer(
+    Reader& ans,
+    Reader& out,
+    FileLoc ans_loc,
+    bool ans_is_longer,
+    ptrdiff_t ans_is_this_bytes_ahead,
+    bool at_eof
+) {
+    auto& longer_reader = ans_is_longer ? ans : out;
+    char c = longer_reader.cur();
+    auto histories = histories_to_print(ans, out, ans_loc, ans_is_this_bytes_ahead);
+    // Future starts AFTER the current character
+    ++longer_reader.pos;
+
+    auto res = start_wrong_answer(ans_loc);
+    auto append_context = [&](const Reader& reader, const string& history, bool is_longer) {
+        if (!is_longer && history.empty()) {
+            res.append(at_eof ? "end of file" : "''");
+            return;
+        }
+        res.append('\'');
+        res.append(history);
+        if (is_longer) {
+            res.append(c);
+            res.append(future_to_print(reader));
+        }
+        res.append('\'');
+    };
+    res.append("read ");
+    append_context(ans, histories.ans, ans_is_longer);
+    res.append(", expected ");
+    append_context(out, histories.out, !ans_is_longer);
+    res.append('\n');
+    return std::move(res).release();
+}
+
+} // namespace
+
+namespace sim::judge {
+
+string run_default_checker(FilePath expected_output, FilePath program_output) {
+    auto out_file = MappedFile{expected_output};
+    auto ans_file = MappedFile{program_output};
+    auto out = Reader{.data = out_file.contents()};
+    auto ans = Reader{.data = ans_file.contents()};
+    auto ans_loc = FileLoc{};
+
+    for (;;) {
+        if (out.eof() || ans.eof()) {
+            // Only whitespace may be left
+            bool ans_is_longer = out.eof();
+            auto& longer_reader = ans_is_longer ? ans : out;
+            ptrdiff_t ans_is_this_bytes_ahead = 0;
+            for (; !longer_reader.eof(); ++longer_reader.pos) {
+                char c = longer_reader.cur();
+                if (c != ' ' && c != '\n') {
+                    return unexpected_char_wrong_answer(
+                        ans, out, ans_loc, ans_is_longer, ans_is_this_bytes_ahead, true
+                    );
+                }
+                ans_is_this_bytes_ahead += ans_is_longer ? 1 : -1;
+                if (ans_is_longer) {
+                    ans_loc.advance(c);
+                }
+            }
+            return "OK\n";
+        }
+
+        auto common_len = std::min(out.data.size() - out.pos, ans.data.size() - ans.pos);
+        auto equal_len =
+            common_prefix_len(out.data.data() + out.pos, ans.data.data() + ans.pos, common_len);
+        ans_loc.advance(ans.data.substr(ans.pos, equal_len));
+        out.pos += equal_len;
+        ans.pos += equal_len;
+        if (equal_len == common_len) {
+            continue;
+        }
+
+        char out_c = out.cur();
+        char ans_c = ans.cur();
+        if (out_c == '\n' || ans_c == '\n') {
+            // Only spaces may precede the end of line in the longer line
+            bool ans_is_longer = out_c == '\n';
+            auto& longer_reader = ans_is_longer ? ans : out;
+            auto& shorter_reader = ans_is_longer ? out : ans;
+            ptrdiff_t ans_is_this_bytes_ahead = 0;
+            while (!longer_reader.eof()) {
+                char c = longer_reader.cur();
+                if (c == '\n') {
+                    ++longer_reader.pos;
+                    if (ans_is_longer) {
+                        ans_loc.advance('\n');
+                    }
+                    break;
+                }
+                if (c != ' ') {
+                    return unexpected_char_wrong_answer(
+                        ans, out, ans_loc, ans_is_longer, ans_is_this_bytes_ahead, false
+                    );
+                }
+                ans_is_this_bytes_ahead += ans_is_longer ? 1 : -1;
+                ++longer_reader.pos;
+                if (ans_is_longer) {
+                    ans_loc.advance(' ');
+                }
+            }
+            ++shorter_reader.pos;
+            if (!ans_is_longer) {
+                ans_loc.advance('\n');
+            }
+            continue;
+        }
+
+        // Found difference inside the current line
+        auto histories = histories_to_print(ans, out, ans_loc, 0);
+        // Future starts AFTER the current character
+        ++out.pos;
+        ++ans.pos;
+
+        auto res = start_wrong_answer(ans_loc);
+        res.append("read '");
+        res.append(histories.ans);
+        res.append(ans_c);
+        res.append(future_to_print(ans));
+        res.append("', expected '");
+        res.append(histories.out);
+        res.append(out_c);
+        res.append(future_to_print(out));
+        res.append("'\n");
+        return std::move(res).release();
+    }
+}
+
+StreamingDefaultChecker::StreamingDefaultChecker(FilePath expected_output)
+: expected{map_file(expected_output)} {}
+
+StreamingDefaultChecker::~StreamingDefaultChecker() { unmap_file(expected); }
+
+bool StreamingDefaultChecker::feed(string_view program_output_chunk) noexcept {
+    if (wrong_answer) {
+        return false;
+    }
+    auto& chunk = program_output_chunk;
+    while (!chunk.empty()) {
+        if (pending_newlines == 0 && pending_spaces == 0) {
+            // Fast path: bytes identical to the expected ones are accepted up to the last
+            // non-whitespace one, as the following whitespace may turn out to be trailing
+            auto len = common_prefix_len(
+                chunk.data(),
+                expected.data() + expected_pos,
+                std::min(chunk.size(), expected.size() - expected_pos)
+            );
+            while (len > 0 && (chunk[len - 1] == ' ' || chunk[len - 1] == '\n')) {
+                --len;
+            }
+            expected_pos += len;
+            chunk.remove_prefix(len);
+            if (chunk.empty()) {
+                break;
+            }
+        }
+
+        char c = chunk.front();
+        chunk.remove_prefix(1);
+        if (c == '\n') {
+            ++pending_newlines;
+            pending_spaces = 0;
+        } else if (c == ' ') {
+            ++pending_spaces;
+        } else if (!feed_non_whitespace(c)) {
+            wrong_answer = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StreamingDefaultChecker::feed_non_whitespace(char c) noexcept {
+    // Whitespace preceding c has to be the same in both outputs except for trailing spaces in lines
+    uint64_t newlines = 0;
+    uint64_t spaces = 0;
+    size_t pos = expected_pos;
+    for (; pos < expected.size(); ++pos) {
+        if (expected[pos] == '\n') {
+            ++newlines;
+            spaces = 0;
+        } else if (expected[pos] == ' ') {
+            ++spaces;
+        } else {
+            break;
+        }
+    }
+    if (pos == expected.size() || expected[pos] != c || newlines != pending_newlines ||
+        spaces != pending_spaces)
+    {
+        return false;
+    }
+    expected_pos = pos + 1;
+    pending_newlines = 0;
+    pending_spaces = 0;
+    return true;
+}
+
+bool StreamingDefaultChecker::accepts_fed_output() const noexcept {
+    if (wrong_answer) {
+        return false;
+    }
+    // Whitespace at the end of the program output is ignored, so only whitespace may be left
+    auto rest = expected.substr(expected_pos);
+    return std::all_of(rest.begin(), rest.end(), [](char c) { return c == ' ' || c == '\n'; });
+}
+
+} // namespace sim::judge
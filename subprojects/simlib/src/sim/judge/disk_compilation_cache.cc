@@ -1,35 +1,80 @@
+#include "to_cached_path.hh"
+
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <simlib/concat_tostr.hh>
+#include <simlib/directory.hh>
 #include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
 #include <simlib/file_info.hh>
 #include <simlib/file_manip.hh>
 #include <simlib/file_perms.hh>
 #include <simlib/macros/throw.hh>
 #include <simlib/sim/judge/disk_compilation_cache.hh>
+#include <simlib/string_transform.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// to_cached_path() never produces names starting with '.'
+constexpr CStringView lock_file_name = ".lock";
+constexpr CStringView journal_file_name = ".journal";
+constexpr CStringView new_journal_file_name = ".journal.new";
+
+// The journal is rewritten once it has this many records more than twice the number of entries
+constexpr uint64_t journal_slack_records_num = 4096;
+
+} // namespace
+
+namespace sim::judge {
+
+// Every journal record is a line in one of the formats:
+//   S <size in bytes> <file name>  - the file was saved
+//   U <file name>                  - the file was used
+//   R <file name>                  - the file was removed
+class DiskCompilationCache::Lock {
+    std::unique_lock<std::mutex> mutex_lock;
+    int lock_fd;
 
-static std::string to_cached_path(std::string_view name) {
-    std::string res;
-    for (auto c : name) {
-        if (c == '\\') {
-            res += "\\\\";
-        } else if (c == ',') {
-            res += "\\,";
-        } else if (c == '/') {
-            res += ',';
-        } else {
-            res += c;
+public:
+    Lock(std::mutex& mutex, int lock_fd) : mutex_lock{mutex}, lock_fd{lock_fd} {
+        while (flock(lock_fd, LOCK_EX)) {
+            if (errno != EINTR) {
+                THROW("flock()", errmsg());
+            }
         }
     }
-    return res;
-}
 
-namespace sim::judge {
+    Lock(const Lock&) = delete;
+    Lock(Lock&&) = delete;
+    Lock& operator=(const Lock&) = delete;
+    Lock& operator=(Lock&&) = delete;
+
+    ~Lock() { (void)flock(lock_fd, LOCK_UN); }
+};
 
 DiskCompilationCache::DiskCompilationCache(
-    std::string cache_dir, std::chrono::seconds max_staleness
+    std::string cache_dir,
+    std::chrono::seconds max_staleness,
+    uint64_t max_size_in_bytes,
+    uint64_t max_entries_num
 )
 : cache_dir{std::move(cache_dir)}
-, max_staleness{max_staleness} {
+, max_staleness{max_staleness}
+, max_size_in_bytes{max_size_in_bytes}
+, max_entries_num{max_entries_num} {
     if (this->cache_dir.empty()) {
         std::terminate();
     }
@@ -39,32 +84,232 @@ DiskCompilationCache::DiskCompilationCache(
     if (mkdir(this->cache_dir) && errno != EEXIST) {
         THROW("mkdir()", errmsg());
     }
+    lock_fd = FileDescriptor{
+        concat_tostr(this->cache_dir, lock_file_name), O_RDWR | O_CREAT | O_CLOEXEC, S_0600
+    };
+    if (!lock_fd.is_open()) {
+        THROW("open()", errmsg());
+    }
+
+    auto guard = lock();
+    sync_with_journal();
+    // The budgets may have been lowered
+    evict_if_needed();
+    compact_journal_if_needed();
 }
 
+DiskCompilationCache::Lock DiskCompilationCache::lock() { return Lock{mutex, lock_fd}; }
+
 bool DiskCompilationCache::copy_from_cache_if_newer_than(
     std::string_view name, FilePath dest, const std::chrono::system_clock::time_point& tp
 ) {
-    auto path = cache_dir + to_cached_path(name);
-    struct stat64 st = {};
-    if (stat64(path.c_str(), &st) == -1) {
-        if (errno == ENOENT) {
+    auto file_name = to_cached_path(name);
+    auto path = concat_tostr(cache_dir, file_name);
+    {
+        auto guard = lock();
+        sync_with_journal();
+        if (entries.find(file_name) == entries.end()) {
+            ++misses_num_;
             return false;
         }
-        THROW("stat64()", errmsg());
-    }
-    auto mtime = get_modification_time(st);
-    if (mtime > tp && std::chrono::system_clock::now() - mtime <= max_staleness) {
-        thread_fork_safe_copy(path, dest, S_0755);
-        return true;
+        struct stat64 st = {};
+        if (stat64(path.c_str(), &st) == -1) {
+            if (errno != ENOENT) {
+                THROW("stat64()", errmsg());
+            }
+            // The file was removed by someone else
+            append_journal_record(concat_tostr("R ", file_name, '\n'));
+            ++misses_num_;
+            return false;
+        }
+        auto mtime = get_modification_time(st);
+        if (std::chrono::system_clock::now() - mtime > max_staleness) {
+            remove_entry(file_name);
+            ++misses_num_;
+            return false;
+        }
+        if (mtime <= tp) {
+            ++misses_num_;
+            return false;
+        }
+        // The use is recorded before copying, so that the file is not evicted in the meantime
+        append_journal_record(concat_tostr("U ", file_name, '\n'));
+        compact_journal_if_needed();
     }
-    return false;
+    thread_fork_safe_copy(path, dest, S_0755);
+    ++hits_num_;
+    return true;
 }
 
 void DiskCompilationCache::save_or_override(std::string_view name, FilePath src) {
-    auto path = cache_dir + to_cached_path(name);
+    auto file_name = to_cached_path(name);
+    auto path = concat_tostr(cache_dir, file_name);
+    auto size_in_bytes = get_file_size(src);
     if (copy_using_rename(src, path)) {
         THROW("copy_using_rename()");
     }
+
+    auto guard = lock();
+    sync_with_journal();
+    append_journal_record(concat_tostr("S ", size_in_bytes, ' ', file_name, '\n'));
+    evict_if_needed();
+    compact_journal_if_needed();
+}
+
+void DiskCompilationCache::sync_with_journal() {
+    auto journal_path = concat_tostr(cache_dir, journal_file_name);
+    struct stat64 st = {};
+    if (stat64(journal_path.c_str(), &st)) {
+        if (errno != ENOENT) {
+            THROW("stat64()", errmsg());
+        }
+        // There is no journal yet, the files already present in the cache directory (e.g. cached
+        // before the journal was introduced) are taken into account in the order of modification
+        std::vector<std::tuple<std::chrono::system_clock::time_point, std::string, uint64_t>> files;
+        for_each_dir_component(cache_dir, [&](dirent* file) {
+            if (file->d_name[0] == '.') {
+                return;
+            }
+            struct stat64 file_st = {};
+            if (stat64(concat_tostr(cache_dir, file->d_name).c_str(), &file_st)) {
+                THROW("stat64()", errmsg());
+            }
+            if (S_ISREG(file_st.st_mode)) {
+                files.emplace_back(
+                    get_modification_time(file_st),
+                    file->d_name,
+                    static_cast<uint64_t>(file_st.st_size)
+                );
+            }
+        });
+        std::sort(files.begin(), files.end());
+        std::string journal;
+        for (const auto& [mtime, file_name, size_in_bytes] : files) {
+            back_insert(journal, "S ", size_in_bytes, ' ', file_name, '\n');
+        }
+        replace_journal(journal);
+        if (stat64(journal_path.c_str(), &st)) {
+            THROW("stat64()", errmsg());
+        }
+    }
+
+    if (!journal_fd.is_open() || st.st_ino != journal_ino) {
+        // The journal has been rewritten (or has not been opened yet), so it is replayed from the
+        // beginning
+        journal_fd = FileDescriptor{journal_path, O_RDWR | O_APPEND | O_CLOEXEC};
+        if (!journal_fd.is_open()) {
+            THROW("open()", errmsg());
+        }
+        journal_ino = st.st_ino;
+        journal_replayed_len = 0;
+        journal_records_num = 0;
+        entries.clear();
+        entries_by_last_use.clear();
+        total_size_in_bytes = 0;
+    }
+
+    auto new_records = get_file_contents(journal_fd, journal_replayed_len, -1);
+    size_t pos = 0;
+    for (;;) {
+        auto newline_pos = new_records.find('\n', pos);
+        if (newline_pos == std::string::npos) {
+            break;
+        }
+        apply_journal_record(StringView{new_records}.substr(pos, newline_pos - pos));
+        pos = newline_pos + 1;
+    }
+    journal_replayed_len += static_cast<off64_t>(pos);
+    if (pos < new_records.size()) {
+        // The last record was torn by a crash in the middle of appending it
+        if (ftruncate64(journal_fd, journal_replayed_len)) {
+            THROW("ftruncate()", errmsg());
+        }
+    }
+}
+
+void DiskCompilationCache::apply_journal_record(StringView record) {
+    ++journal_records_num;
+    if (record.size() < 2 || record[1] != ' ') {
+        return; // Malformed record
+    }
+    auto op = record[0];
+    record.remove_prefix(2);
+    if (op == 'S') {
+        auto space_pos = record.find(' ');
+        if (space_pos == StringView::npos) {
+            return; // Malformed record
+        }
+        auto size_in_bytes = str2num<uint64_t>(record.substr(0, space_pos));
+        if (!size_in_bytes) {
+            return; // Malformed record
+        }
+        auto file_name = record.substr(space_pos + 1);
+        forget_entry(file_name);
+        entries.emplace(file_name.to_string(), Entry{*size_in_bytes, journal_records_num});
+        entries_by_last_use.emplace(journal_records_num, file_name.to_string());
+        total_size_in_bytes += *size_in_bytes;
+    } else if (op == 'U') {
+        auto it = entries.find(record);
+        if (it != entries.end()) {
+            entries_by_last_use.erase(it->second.last_use);
+            it->second.last_use = journal_records_num;
+            entries_by_last_use.emplace(journal_records_num, it->first);
+        }
+    } else if (op == 'R') {
+        forget_entry(record);
+    }
+}
+
+void DiskCompilationCache::append_journal_record(const std::string& record) {
+    write_all_throw(journal_fd, record);
+    journal_replayed_len += static_cast<off64_t>(record.size());
+    apply_journal_record(StringView{record}.substr(0, record.size() - 1)); // without '\n'
+}
+
+void DiskCompilationCache::forget_entry(StringView file_name) {
+    auto it = entries.find(file_name);
+    if (it != entries.end()) {
+        total_size_in_bytes -= it->second.size_in_bytes;
+        entries_by_last_use.erase(it->second.last_use);
+        entries.erase(it);
+    }
+}
+
+void DiskCompilationCache::remove_entry(const std::string& file_name) {
+    if (unlink(concat_tostr(cache_dir, file_name).c_str()) && errno != ENOENT) {
+        THROW("unlink()", errmsg());
+    }
+    append_journal_record(concat_tostr("R ", file_name, '\n'));
+}
+
+void DiskCompilationCache::evict_if_needed() {
+    while (!entries.empty() &&
+           (total_size_in_bytes > max_size_in_bytes || entries.size() > max_entries_num))
+    {
+        auto least_recently_used = entries_by_last_use.begin()->second;
+        remove_entry(least_recently_used);
+    }
+}
+
+void DiskCompilationCache::compact_journal_if_needed() {
+    if (journal_records_num <= 2 * entries.size() + journal_slack_records_num) {
+        return;
+    }
+    std::string journal;
+    for (const auto& [last_use, file_name] : entries_by_last_use) {
+        back_insert(journal, "S ", entries.at(file_name).size_in_bytes, ' ', file_name, '\n');
+    }
+    replace_journal(journal);
+    sync_with_journal();
+}
+
+void DiskCompilationCache::replace_journal(StringView contents) {
+    // Renaming makes other processes notice the new journal and replay it
+    auto new_journal_path = concat_tostr(cache_dir, new_journal_file_name);
+    put_file_contents(new_journal_path, contents.data(), contents.size(), S_0600);
+    if (rename(new_journal_path.c_str(), concat_tostr(cache_dir, journal_file_name).c_str())) {
+        THROW("rename()", errmsg());
+    }
 }
 
 } // namespace sim::judge
@@ -22,9 +22,11 @@ struct CheckerOutputReport {
 };
 
 inline CheckerOutputReport
-get_checker_output_report(FileDescriptor checker_output_fd, uint64_t max_comment_len) {
-    auto checker_output =
-        get_file_contents(checker_output_fd, 0, static_cast<off_t>(max_comment_len) + 32);
+get_checker_output_report(std::string checker_output, uint64_t max_comment_len) {
+    // Only the beginning of the output is taken into account
+    if (checker_output.size() > max_comment_len + 32) {
+        checker_output.resize(max_comment_len + 32);
+    }
     SimpleParser parser(checker_output);
 
     auto line1 = parser.extract_next('\n');
@@ -78,4 +80,12 @@ get_checker_output_report(FileDescriptor checker_output_fd, uint64_t max_comment
     };
 }
 
+inline CheckerOutputReport
+get_checker_output_report(FileDescriptor checker_output_fd, uint64_t max_comment_len) {
+    return get_checker_output_report(
+        get_file_contents(checker_output_fd, 0, static_cast<off_t>(max_comment_len) + 32),
+        max_comment_len
+    );
+}
+
 } // namespace sim::judge
@@ -3,7 +3,6 @@
 #include <simlib/merge.hh>
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
-#include <simlib/sandbox/seccomp/bpf_builder.hh>
 #include <simlib/sim/judge/language_suite/bash.hh>
 #include <simlib/sim/judge/language_suite/fully_interpreted_language.hh>
 #include <simlib/slice.hh>
@@ -19,18 +18,14 @@ using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 namespace sim::judge::language_suite {
 
 Bash::Bash()
-: FullyInterpretedLanguage{"/usr/bin/bash", [] {
-                               auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
-                               sandbox::seccomp::allow_common_safe_syscalls(bpf);
-                               return bpf.export_to_fd();
-                           }()} {}
+: FullyInterpretedLanguage{"/usr/bin/bash", sandbox::seccomp::common_safe_syscalls_bpf_fd()} {}
 
 Suite::RunHandle Bash::async_run(
     Slice<std::string_view> args,
     RunOptions options,
     Slice<sandbox::RequestOptions::LinuxNamespaces::Mount::Operation> mount_ops
 ) {
-    return RunHandle{sc.send_request(
+    return send_run_request(
         interpreter_executable_path,
         merge(std::vector<std::string_view>{"bash", "source.sh"}, args),
         {
@@ -105,6 +100,7 @@ Suite::RunHandle Bash::async_run(
                     .process_num_limit = options.process_num_limit,
                     .memory_limit_in_bytes = options.memory_limit_in_bytes,
                     .swap_limit_in_bytes = 0,
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -121,7 +117,7 @@ Suite::RunHandle Bash::async_run(
             .cpu_time_limit = options.cpu_time_limit,
             .seccomp_bpf_fd = seccomp_bpf_fd,
         }
-    )};
+    );
 }
 
 } // namespace sim::judge::language_suite
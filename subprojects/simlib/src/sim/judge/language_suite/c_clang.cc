@@ -5,7 +5,6 @@
 #include <simlib/merge.hh>
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
-#include <simlib/sandbox/seccomp/bpf_builder.hh>
 #include <simlib/sim/judge/language_suite/c_clang.hh>
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/slice.hh>
@@ -21,11 +20,7 @@ using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 namespace sim::judge::language_suite {
 
 C_Clang::C_Clang(Standard standard)
-: FullyCompiledLanguage{"/usr/bin/clang", [] {
-    auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
-    sandbox::seccomp::allow_common_safe_syscalls(bpf);
-    return bpf.export_to_fd();
-}()}
+: FullyCompiledLanguage{"/usr/bin/clang", sandbox::seccomp::common_safe_syscalls_bpf_fd()}
 , std_flag([&] {
     switch (standard) {
     case Standard::C11: return "-std=c11";
@@ -106,9 +101,9 @@ sandbox::Result C_Clang::run_compiler(
             .no_exec = false,
         });
     }
-    return sc.await_result(sc.send_request(
+    return sc().await_result(sc().send_request(
         compiler_executable_path,
-        merge(std::vector<std::string_view>{"clang", std_flag, "-O2"}, extra_args),
+        merge(merge(std::vector<std::string_view>{"clang"}, compiler_flags()), extra_args),
         {
             .stdout_fd = compilation_errors_fd,
             .stderr_fd = compilation_errors_fd,
@@ -136,6 +131,7 @@ sandbox::Result C_Clang::run_compiler(
                             .max_usec = 10000,
                             .period_usec = 10000,
                         },
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -149,6 +145,8 @@ sandbox::Result C_Clang::run_compiler(
     ));
 }
 
+std::vector<std::string_view> C_Clang::compiler_flags() const { return {std_flag, "-O2"}; }
+
 sandbox::Result C_Clang::is_supported_impl(CompileOptions options) {
     return run_compiler({{"--version"}}, std::nullopt, {}, std::move(options));
 }
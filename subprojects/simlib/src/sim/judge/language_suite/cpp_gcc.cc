@@ -1,16 +1,31 @@
 #include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <optional>
+#include <simlib/concat_tostr.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
 #include <simlib/file_info.hh>
+#include <simlib/file_manip.hh>
 #include <simlib/file_path.hh>
+#include <simlib/macros/throw.hh>
 #include <simlib/merge.hh>
+#include <simlib/overloaded.hh>
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
-#include <simlib/sandbox/seccomp/bpf_builder.hh>
+#include <simlib/sha.hh>
 #include <simlib/sim/judge/language_suite/cpp_gcc.hh>
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/slice.hh>
+#include <string>
 #include <string_view>
 #include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <variant>
 #include <vector>
 
 using MountTmpfs = sandbox::RequestOptions::LinuxNamespaces::Mount::MountTmpfs;
@@ -20,12 +35,8 @@ using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 
 namespace sim::judge::language_suite {
 
-Cpp_GCC::Cpp_GCC(Standard standard)
-: FullyCompiledLanguage{"/usr/bin/g++", [] {
-    auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
-    sandbox::seccomp::allow_common_safe_syscalls(bpf);
-    return bpf.export_to_fd();
-}()}
+Cpp_GCC::Cpp_GCC(Standard standard, std::optional<PrecompiledHeaders> precompiled_headers)
+: FullyCompiledLanguage{"/usr/bin/g++", sandbox::seccomp::common_safe_syscalls_bpf_fd()}
 , std_flag([&] {
     switch (standard) {
     case Standard::Cpp11: return "-std=c++11";
@@ -40,7 +51,8 @@ Cpp_GCC::Cpp_GCC(Standard standard)
     case Standard::Gnupp23: return "-std=gnu++23";
     }
     __builtin_unreachable();
-}()) {}
+}())
+, precompiled_headers{std::move(precompiled_headers)} {}
 
 sandbox::Result Cpp_GCC::run_compiler(
     Slice<std::string_view> extra_args,
@@ -110,9 +122,9 @@ sandbox::Result Cpp_GCC::run_compiler(
             .no_exec = false,
         });
     }
-    return sc.await_result(sc.send_request(
+    return sc().await_result(sc().send_request(
         compiler_executable_path,
-        merge(std::vector<std::string_view>{"g++", std_flag, "-O2"}, extra_args),
+        merge(merge(std::vector<std::string_view>{"g++"}, compiler_flags()), extra_args),
         {
             .stdout_fd = compilation_errors_fd,
             .stderr_fd = compilation_errors_fd,
@@ -140,6 +152,7 @@ sandbox::Result Cpp_GCC::run_compiler(
                             .max_usec = 10000,
                             .period_usec = 10000,
                         },
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -153,31 +166,139 @@ sandbox::Result Cpp_GCC::run_compiler(
     ));
 }
 
+std::vector<std::string_view> Cpp_GCC::compiler_flags() const { return {std_flag, "-O2"}; }
+
 sandbox::Result Cpp_GCC::is_supported_impl(CompileOptions options) {
     return run_compiler({{"--version"}}, std::nullopt, {}, std::move(options));
 }
 
+std::optional<std::string> Cpp_GCC::prepare_precompiled_headers() {
+    // Precompiled headers are usable only with the same compiler and flags, so they are kept in a
+    // directory named after them
+    auto key_data = compiler_identity();
+    for (const auto& header : precompiled_headers->headers) {
+        back_insert(key_data, header, '\0');
+    }
+    auto key = sha3_256(key_data);
+    auto dir = precompiled_headers->dir;
+    if (dir.empty() || dir.back() != '/') {
+        dir += '/';
+    }
+    auto path = concat_tostr(dir, key, '/');
+    if (is_directory(path)) {
+        return path;
+    }
+
+    if (mkdir_r(dir)) {
+        THROW("mkdir_r()", errmsg());
+    }
+    // The headers are generated in a temporary directory that is then renamed, so that nobody
+    // uses them before they are complete
+    auto tmp_path = concat_tostr(dir, '.', key, ".XXXXXX");
+    if (!mkdtemp(tmp_path.data())) {
+        THROW("mkdtemp()", errmsg());
+    }
+    auto source_path = concat_tostr(tmp_path, "/.header.hh");
+    for (const auto& header : precompiled_headers->headers) {
+        auto source = concat_tostr("#include <", header, ">\n");
+        put_file_contents(source_path, source);
+        // GCC looks for <header>.gch in every include directory before looking for the header
+        auto gch_path = concat_tostr(tmp_path, '/', header, ".gch");
+        if (create_subdirectories(gch_path)) {
+            THROW("create_subdirectories()", errmsg());
+        }
+        put_file_contents(gch_path, "");
+        bool compiler_finished = false;
+        auto succeeded = std::visit(
+            overloaded{
+                [&](const sandbox::result::Ok& res_ok) {
+                    compiler_finished = res_ok.si.code == CLD_EXITED;
+                    return res_ok.si == sandbox::Si{.code = CLD_EXITED, .status = 0};
+                },
+                [](const sandbox::result::Error& /*res_err*/) { return false; },
+            },
+            run_compiler(
+                {{"-x", "c++-header", "header.hh", "-o", "header.gch"}},
+                std::nullopt,
+                {{
+                    CreateFile{.path = "/../header.gch"},
+                    CreateFile{.path = "/../header.hh"},
+                    BindMount{
+                        .source = gch_path,
+                        .dest = "/../header.gch",
+                        .read_only = false,
+                    },
+                    BindMount{
+                        .source = source_path,
+                        .dest = "/../header.hh",
+                    },
+                }},
+                {
+                    .time_limit = std::chrono::seconds{120}, // Under load it may take time.
+                    .cpu_time_limit = std::chrono::seconds{60},
+                    .memory_limit_in_bytes = uint64_t{2} << 30,
+                    .max_file_size_in_bytes = uint64_t{1} << 30,
+                }
+            )
+        );
+        if (!compiler_finished) {
+            // The failure may be transient, so it must not be published as the header's omission
+            if (remove_r(tmp_path)) {
+                THROW("remove_r()", errmsg());
+            }
+            return std::nullopt;
+        }
+        if (!succeeded && unlink(gch_path.c_str())) {
+            THROW("unlink()", errmsg());
+        }
+    }
+    if (unlink(source_path.c_str())) {
+        THROW("unlink()", errmsg());
+    }
+
+    if (rename(tmp_path.c_str(), path.c_str())) {
+        if (errno != EEXIST && errno != ENOTEMPTY) {
+            THROW("rename()", errmsg());
+        }
+        // Someone else has generated them in the meantime
+        if (remove_r(tmp_path)) {
+            THROW("remove_r()", errmsg());
+        }
+    }
+    return path;
+}
+
 sandbox::Result Cpp_GCC::compile_impl(
     FilePath source, FilePath executable, int compilation_errors_fd, CompileOptions options
 ) {
-    return run_compiler(
-        {{"source.cc", "-o", "exe"}},
-        compilation_errors_fd,
-        {{
-            CreateFile{.path = "/../exe"},
-            CreateFile{.path = "/../source.cc"},
-            BindMount{
-                .source = std::string_view{executable},
-                .dest = "/../exe",
-                .read_only = false,
-            },
-            BindMount{
-                .source = std::string_view{source},
-                .dest = "/../source.cc",
-            },
-        }},
-        std::move(options)
-    );
+    auto args = std::vector<std::string_view>{"source.cc", "-o", "exe"};
+    auto mount_ops = std::vector<sandbox::RequestOptions::LinuxNamespaces::Mount::Operation>{
+        CreateFile{.path = "/../exe"},
+        CreateFile{.path = "/../source.cc"},
+        BindMount{
+            .source = std::string_view{executable},
+            .dest = "/../exe",
+            .read_only = false,
+        },
+        BindMount{
+            .source = std::string_view{source},
+            .dest = "/../source.cc",
+        },
+    };
+    if (precompiled_headers && !precompiled_headers_path) {
+        precompiled_headers_path = prepare_precompiled_headers();
+    }
+    if (precompiled_headers_path) {
+        // GCC uses a precompiled header only if it is included before anything else and silently
+        // ignores it if it is not compatible with the compilation
+        args.emplace_back("-I/pch");
+        mount_ops.emplace_back(CreateDir{.path = "/../pch"});
+        mount_ops.emplace_back(BindMount{
+            .source = *precompiled_headers_path,
+            .dest = "/../pch",
+        });
+    }
+    return run_compiler(args, compilation_errors_fd, mount_ops, std::move(options));
 }
 
 } // namespace sim::judge::language_suite
@@ -2,7 +2,9 @@
 #include <cerrno>
 #include <chrono>
 #include <fcntl.h>
+#include <simlib/concat_tostr.hh>
 #include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
 #include <simlib/file_descriptor.hh>
 #include <simlib/file_info.hh>
 #include <simlib/file_path.hh>
@@ -11,10 +13,12 @@
 #include <simlib/overloaded.hh>
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
-#include <simlib/sandbox/seccomp/bpf_builder.hh>
+#include <simlib/sha.hh>
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/slice.hh>
+#include <string>
 #include <string_view>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <variant>
@@ -28,15 +32,42 @@ using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 namespace sim::judge::language_suite {
 
 FullyCompiledLanguage::FullyCompiledLanguage(
-    std::string compiler_executable_path, FileDescriptor compiler_seccomp_bpf_fd
+    std::string compiler_executable_path, int compiler_seccomp_bpf_fd
 )
 : compiler_executable_path{std::move(compiler_executable_path)}
-, compiler_seccomp_bpf_fd{std::move(compiler_seccomp_bpf_fd)}
-, executable_seccomp_bpf_fd{[] {
-    auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
-    sandbox::seccomp::allow_common_safe_syscalls(bpf);
-    return bpf.export_to_fd();
-}()} {}
+, compiler_seccomp_bpf_fd{compiler_seccomp_bpf_fd}
+, executable_seccomp_bpf_fd{sandbox::seccomp::common_safe_syscalls_bpf_fd()} {}
+
+std::string FullyCompiledLanguage::compiler_identity() const {
+    // The compiler is identified by its file, which is replaced by upgrades of the compiler
+    struct stat64 st = {};
+    if (stat64(compiler_executable_path.c_str(), &st)) {
+        THROW("stat64()", errmsg());
+    }
+    auto data = concat_tostr(
+        compiler_executable_path,
+        '\0',
+        st.st_dev,
+        ':',
+        st.st_ino,
+        ':',
+        st.st_size,
+        ':',
+        st.st_mtim.tv_sec,
+        '.',
+        st.st_mtim.tv_nsec,
+        '\0'
+    );
+    for (auto flag : compiler_flags()) {
+        back_insert(data, flag, '\0');
+    }
+    return data;
+}
+
+std::string FullyCompiledLanguage::content_hash(FilePath source) {
+    auto data = concat_tostr(compiler_identity(), get_file_contents(source));
+    return sha3_256(data).to_string();
+}
 
 bool FullyCompiledLanguage::is_supported() {
     if (access(compiler_executable_path, F_OK) != 0) {
@@ -62,15 +93,26 @@ Result<std::optional<sandbox::result::Ok>, FileDescriptor>
 FullyCompiledLanguage::compile(FilePath source, CompileOptions options) {
     executable_file_is_ready = false;
 
-    if (options.cache &&
-        options.cache->compilation_cache.copy_from_cache_if_newer_than(
-            options.cache->cached_name,
-            executable_tmp_file.path(),
-            std::max(get_modification_time(source), get_modification_time(compiler_executable_path))
-        ))
-    {
-        executable_file_is_ready = true;
-        return Ok<std::optional<sandbox::result::Ok>>{std::nullopt};
+    std::string cached_name;
+    if (options.cache) {
+        // Content-addressed entries do not become outdated, as their names change with the source
+        // and the compiler
+        auto outdated_before = std::chrono::system_clock::time_point::min();
+        if (options.cache->content_addressed) {
+            cached_name = concat_tostr(options.cache->cached_name, content_hash(source));
+        } else {
+            cached_name = options.cache->cached_name;
+            outdated_before = std::max(
+                get_modification_time(source), get_modification_time(compiler_executable_path)
+            );
+        }
+        if (options.cache->compilation_cache.copy_from_cache_if_newer_than(
+                cached_name, executable_tmp_file.path(), outdated_before
+            ))
+        {
+            executable_file_is_ready = true;
+            return Ok<std::optional<sandbox::result::Ok>>{std::nullopt};
+        }
     }
 
     auto compilation_errors_fd = FileDescriptor{memfd_create("compilation errors fd", MFD_CLOEXEC)};
@@ -89,7 +131,7 @@ FullyCompiledLanguage::compile(FilePath source, CompileOptions options) {
                     executable_file_is_ready = true;
                     if (cache) {
                         cache->compilation_cache.save_or_override(
-                            cache->cached_name, executable_tmp_file.path()
+                            cached_name, executable_tmp_file.path()
                         );
                     }
                     return Ok{std::optional{ok}};
@@ -113,7 +155,7 @@ Suite::RunHandle FullyCompiledLanguage::async_run(
     if (!executable_file_is_ready) {
         THROW("cannot run without successful compilation preceding the run");
     }
-    return RunHandle{sc.send_request(
+    return send_run_request(
         "/exe",
         merge(std::vector<std::string_view>{""}, args),
         {
@@ -182,6 +224,7 @@ Suite::RunHandle FullyCompiledLanguage::async_run(
                     .process_num_limit = options.process_num_limit,
                     .memory_limit_in_bytes = options.memory_limit_in_bytes,
                     .swap_limit_in_bytes = 0,
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -198,7 +241,7 @@ Suite::RunHandle FullyCompiledLanguage::async_run(
             .cpu_time_limit = options.cpu_time_limit,
             .seccomp_bpf_fd = executable_seccomp_bpf_fd,
         }
-    )};
+    );
 }
 
 } // namespace sim::judge::language_suite
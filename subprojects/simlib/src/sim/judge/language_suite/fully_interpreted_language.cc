@@ -10,10 +10,10 @@
 namespace sim::judge::language_suite {
 
 FullyInterpretedLanguage::FullyInterpretedLanguage(
-    std::string interpreter_executable_path, FileDescriptor seccomp_bpf_fd
+    std::string interpreter_executable_path, int seccomp_bpf_fd
 )
 : interpreter_executable_path{std::move(interpreter_executable_path)}
-, seccomp_bpf_fd{std::move(seccomp_bpf_fd)} {}
+, seccomp_bpf_fd{seccomp_bpf_fd} {}
 
 Result<std::optional<sandbox::result::Ok>, FileDescriptor>
 FullyInterpretedLanguage::compile(FilePath source, CompileOptions /*options*/) {
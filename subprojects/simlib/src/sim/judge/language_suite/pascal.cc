@@ -5,7 +5,6 @@
 #include <simlib/merge.hh>
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
-#include <simlib/sandbox/seccomp/bpf_builder.hh>
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/sim/judge/language_suite/pascal.hh>
 #include <simlib/slice.hh>
@@ -21,11 +20,7 @@ using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 namespace sim::judge::language_suite {
 
 Pascal::Pascal()
-: FullyCompiledLanguage{"/usr/bin/fpc", [] {
-                            auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
-                            sandbox::seccomp::allow_common_safe_syscalls(bpf);
-                            return bpf.export_to_fd();
-                        }()} {}
+: FullyCompiledLanguage{"/usr/bin/fpc", sandbox::seccomp::common_safe_syscalls_bpf_fd()} {}
 
 sandbox::Result Pascal::run_compiler(
     Slice<std::string_view> extra_args,
@@ -92,9 +87,9 @@ sandbox::Result Pascal::run_compiler(
             .no_exec = false,
         });
     }
-    return sc.await_result(sc.send_request(
+    return sc().await_result(sc().send_request(
         compiler_executable_path,
-        merge(std::vector<std::string_view>{"fpc", "-O2", "-XS", "-Xt"}, extra_args),
+        merge(merge(std::vector<std::string_view>{"fpc"}, compiler_flags()), extra_args),
         {
             .stdout_fd = compilation_errors_fd,
             .stderr_fd = compilation_errors_fd,
@@ -122,6 +117,7 @@ sandbox::Result Pascal::run_compiler(
                             .max_usec = 10000,
                             .period_usec = 10000,
                         },
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -135,6 +131,8 @@ sandbox::Result Pascal::run_compiler(
     ));
 }
 
+std::vector<std::string_view> Pascal::compiler_flags() const { return {"-O2", "-XS", "-Xt"}; }
+
 sandbox::Result Pascal::is_supported_impl(CompileOptions options) {
     return run_compiler({{"-iV"}}, std::nullopt, {}, std::move(options));
 }
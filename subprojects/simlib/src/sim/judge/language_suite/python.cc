@@ -4,6 +4,7 @@
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
 #include <simlib/sandbox/seccomp/bpf_builder.hh>
+#include <simlib/sandbox/seccomp/prebuilt_bpf.hh>
 #include <simlib/sim/judge/language_suite/fully_interpreted_language.hh>
 #include <simlib/sim/judge/language_suite/python.hh>
 #include <simlib/slice.hh>
@@ -19,21 +20,19 @@ using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 namespace sim::judge::language_suite {
 
 Python::Python()
-: FullyInterpretedLanguage{"/usr/bin/python3", [] {
-                               auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
-                               sandbox::seccomp::allow_common_safe_syscalls(bpf);
-                               bpf.allow_syscall(
-                                   SCMP_SYS(ioctl), sandbox::seccomp::ARG1_EQ{FIOCLEX}
-                               );
-                               return bpf.export_to_fd();
-                           }()} {}
+: FullyInterpretedLanguage{"/usr/bin/python3", sandbox::seccomp::prebuilt_bpf_fd("python", [] {
+    auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
+    sandbox::seccomp::allow_common_safe_syscalls(bpf);
+    bpf.allow_syscall(SCMP_SYS(ioctl), sandbox::seccomp::ARG1_EQ{FIOCLEX});
+    return bpf.export_to_fd();
+})} {}
 
 Suite::RunHandle Python::async_run(
     Slice<std::string_view> args,
     RunOptions options,
     Slice<sandbox::RequestOptions::LinuxNamespaces::Mount::Operation> mount_ops
 ) {
-    return RunHandle{sc.send_request(
+    return send_run_request(
         interpreter_executable_path,
         merge(std::vector<std::string_view>{"python3", "source.py"}, args),
         {
@@ -108,6 +107,7 @@ Suite::RunHandle Python::async_run(
                     .process_num_limit = options.process_num_limit,
                     .memory_limit_in_bytes = options.memory_limit_in_bytes,
                     .swap_limit_in_bytes = 0,
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -124,7 +124,7 @@ Suite::RunHandle Python::async_run(
             .cpu_time_limit = options.cpu_time_limit,
             .seccomp_bpf_fd = seccomp_bpf_fd,
         }
-    )};
+    );
 }
 
 } // namespace sim::judge::language_suite
@@ -6,6 +6,7 @@
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sandbox/seccomp/allow_common_safe_syscalls.hh>
 #include <simlib/sandbox/seccomp/bpf_builder.hh>
+#include <simlib/sandbox/seccomp/prebuilt_bpf.hh>
 #include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/sim/judge/language_suite/rust.hh>
 #include <simlib/slice.hh>
@@ -23,12 +24,12 @@ using MountProc = sandbox::RequestOptions::LinuxNamespaces::Mount::MountProc;
 namespace sim::judge::language_suite {
 
 Rust::Rust(Edition edition)
-: FullyCompiledLanguage{"/usr/bin/rustc", [] {
+: FullyCompiledLanguage{"/usr/bin/rustc", sandbox::seccomp::prebuilt_bpf_fd("rust_compiler", [] {
     auto bpf = sandbox::seccomp::BpfBuilder{SCMP_ACT_ERRNO(ENOSYS)};
     sandbox::seccomp::allow_common_safe_syscalls(bpf);
     bpf.allow_syscall(SCMP_SYS(ioctl), sandbox::seccomp::ARG1_EQ{FIONBIO});
     return bpf.export_to_fd();
-}()}
+})}
 , edition_str([&] {
     switch (edition) {
     case Edition::ed2018: return "2018";
@@ -109,23 +110,18 @@ sandbox::Result Rust::run_compiler(
             .no_exec = false,
         });
     }
-    return sc.await_result(sc.send_request(
+    return sc().await_result(sc().send_request(
         "/usr/bin/sh",
         merge(
-            std::vector<std::string_view>{
-                "sh",
-                "-c",
-                R"(ln -s /usr/bin/rustc /proc/self/exe && exec "$0" "$@")",
-                compiler_executable_path,
-                "--edition",
-                edition_str,
-                "--codegen",
-                "debuginfo=0",
-                "--codegen",
-                "opt-level=2",
-                "--codegen",
-                "panic=abort",
-            },
+            merge(
+                std::vector<std::string_view>{
+                    "sh",
+                    "-c",
+                    R"(ln -s /usr/bin/rustc /proc/self/exe && exec "$0" "$@")",
+                    compiler_executable_path,
+                },
+                compiler_flags()
+            ),
             extra_args
         ),
         {
@@ -155,6 +151,7 @@ sandbox::Result Rust::run_compiler(
                             .max_usec = 10000,
                             .period_usec = 10000,
                         },
+                    .cpuset_cpus = cpuset_cpus(),
                 },
             .prlimit =
                 {
@@ -168,6 +165,19 @@ sandbox::Result Rust::run_compiler(
     ));
 }
 
+std::vector<std::string_view> Rust::compiler_flags() const {
+    return {
+        "--edition",
+        edition_str,
+        "--codegen",
+        "debuginfo=0",
+        "--codegen",
+        "opt-level=2",
+        "--codegen",
+        "panic=abort",
+    };
+}
+
 sandbox::Result Rust::is_supported_impl(CompileOptions options) {
     return run_compiler({{"--print", "sysroot"}}, std::nullopt, {}, std::move(options));
 }
@@ -1,11 +1,113 @@
+#include <simlib/defer.hh>
 #include <simlib/macros/throw.hh>
 #include <simlib/overloaded.hh>
 #include <simlib/sandbox/sandbox.hh>
 #include <simlib/sim/judge/language_suite/suite.hh>
+#include <utility>
 
 namespace sim::judge::language_suite {
 
+sandbox::SupervisorConnection& Suite::sc() {
+    if (!sc_lease) {
+        sc_lease.emplace(lease_supervisor());
+    }
+    return **sc_lease;
+}
+
+sandbox::SupervisorPool::Lease Suite::lease_supervisor() {
+    if (supervisor_pool) {
+        return supervisor_pool->lease();
+    }
+    return sandbox::SupervisorPool::Lease{sandbox::spawn_supervisor()};
+}
+
+void Suite::set_supervisor_pool(sandbox::SupervisorPool& supervisor_pool) {
+    auto max_concurrent_runs = run_supervisors ? run_supervisors->extra_scs.size() + 1 : 1;
+    release_supervisors();
+    this->supervisor_pool = &supervisor_pool;
+    set_max_concurrent_runs(max_concurrent_runs);
+}
+
+void Suite::release_supervisors() {
+    run_supervisors = nullptr;
+    sc_lease = std::nullopt;
+}
+
+void Suite::set_max_concurrent_runs(size_t max_concurrent_runs) {
+    if (max_concurrent_runs == 0) {
+        THROW("max_concurrent_runs has to be greater than 0");
+    }
+    // Runs may be issued from different threads, so every supervisor is obtained up front
+    (void)sc();
+    if (max_concurrent_runs == 1) {
+        run_supervisors = nullptr;
+        return;
+    }
+
+    auto rs = std::make_unique<RunSupervisors>();
+    rs->extra_scs.reserve(max_concurrent_runs - 1);
+    if (run_supervisors) {
+        // Reuse already spawned supervisors
+        for (auto& extra_sc : run_supervisors->extra_scs) {
+            if (rs->extra_scs.size() == max_concurrent_runs - 1) {
+                break;
+            }
+            rs->extra_scs.emplace_back(std::move(extra_sc));
+        }
+    }
+    while (rs->extra_scs.size() < max_concurrent_runs - 1) {
+        rs->extra_scs.emplace_back(lease_supervisor());
+    }
+
+    auto& idle_sc_idxs = rs->idle_sc_idxs.get().second;
+    for (size_t sc_idx = 0; sc_idx < max_concurrent_runs; ++sc_idx) {
+        idle_sc_idxs.emplace_back(sc_idx);
+    }
+    run_supervisors = std::move(rs);
+}
+
+Suite::RunHandle Suite::send_run_request(
+    std::string_view executable_path,
+    Slice<const std::string_view> argv,
+    const sandbox::RequestOptions& options
+) {
+    if (!run_supervisors) {
+        return RunHandle{sc().send_request(executable_path, argv, options), 0, nullptr};
+    }
+
+    auto sc_idx = run_supervisors->idle_sc_idxs.perform([](auto& idle_sc_idxs) {
+        if (idle_sc_idxs.empty()) {
+            THROW("too many concurrent runs, see set_max_concurrent_runs()");
+        }
+        auto res = idle_sc_idxs.back();
+        idle_sc_idxs.pop_back();
+        return res;
+    });
+    try {
+        return RunHandle{
+            run_sc(sc_idx).send_request(executable_path, argv, options),
+            sc_idx,
+            &run_supervisors->idle_sc_idxs
+        };
+    } catch (...) {
+        run_supervisors->idle_sc_idxs.perform([&](auto& idle_sc_idxs) {
+            idle_sc_idxs.emplace_back(sc_idx);
+        });
+        throw;
+    }
+}
+
+void Suite::RunHandle::release_sc() noexcept {
+    if (idle_sc_idxs) {
+        // Does not allocate: the vector had room for all the indexes since its creation
+        std::exchange(idle_sc_idxs, nullptr)->perform([&](auto& idxs) {
+            idxs.emplace_back(sc_idx);
+        });
+    }
+}
+
 sandbox::result::Ok Suite::await_result(RunHandle&& run_handle) {
+    Defer release_sc = [&] { run_handle.release_sc(); };
     return std::visit(
         overloaded{
             [](sandbox::result::Ok res_ok) { return res_ok; },
@@ -13,7 +115,7 @@ sandbox::result::Ok Suite::await_result(RunHandle&& run_handle) {
                 THROW("Suite run error: ", res_err.description);
             }
         },
-        sc.await_result(std::move(run_handle.request_handle))
+        run_sc(run_handle.sc_idx).await_result(std::move(run_handle.request_handle))
     );
 }
 
@@ -0,0 +1,158 @@
+#include "to_cached_path.hh"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <mutex>
+#include <simlib/concat.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/directory.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_info.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sim/judge/package_files_cache.hh>
+#include <simlib/string_traits.hh>
+#include <simlib/temporary_file.hh>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Cached file names never start with '.', see to_cached_path()
+constexpr std::string_view extracted_tmp_file_prefix = ".extracted.";
+
+} // namespace
+
+namespace sim::judge {
+
+PackageFilesCache::PackageFilesCache(std::string cache_dir, uint64_t max_size_in_bytes)
+: cache_dir{std::move(cache_dir)}
+, max_size_in_bytes{max_size_in_bytes} {
+    if (this->cache_dir.empty()) {
+        THROW("cache_dir cannot be empty");
+    }
+    if (this->cache_dir.back() != '/') {
+        this->cache_dir += '/';
+    }
+    if (mkdir(this->cache_dir) && errno != EEXIST) {
+        THROW("mkdir()", errmsg());
+    }
+
+    for_each_dir_component(this->cache_dir, [&](dirent* package_dirent) {
+        auto package_dir = concat_tostr(this->cache_dir, package_dirent->d_name, '/');
+        struct stat64 st = {};
+        if (stat64(package_dir.c_str(), &st)) {
+            THROW("stat64()", errmsg());
+        }
+        if (!S_ISDIR(st.st_mode)) {
+            return;
+        }
+
+        auto& package = packages[package_dirent->d_name];
+        // Modification time of the package dir is updated on every lease
+        package.last_used = get_modification_time(st);
+        for_each_dir_component(package_dir, [&](dirent* file_dirent) {
+            auto file_path = concat(package_dir, file_dirent->d_name);
+            if (has_prefix(file_dirent->d_name, extracted_tmp_file_prefix)) {
+                // Left by an extraction interrupted e.g. by a crash
+                if (unlink(file_path.to_cstr().c_str())) {
+                    THROW("unlink()", errmsg());
+                }
+                return;
+            }
+            package.size_in_bytes += get_file_size(file_path);
+        });
+        total_size_in_bytes += package.size_in_bytes;
+    });
+
+    std::lock_guard lock{mutex};
+    evict_if_needed();
+}
+
+PackageFilesCache::Lease PackageFilesCache::lease(std::string_view package_name) {
+    auto package_dir_name = to_cached_path(package_name);
+    auto package_dir = concat_tostr(cache_dir, package_dir_name);
+
+    std::lock_guard lock{mutex};
+    auto it = packages.find(package_dir_name);
+    if (it == packages.end()) {
+        if (mkdir(package_dir) && errno != EEXIST) {
+            THROW("mkdir()", errmsg());
+        }
+        it = packages.emplace(package_dir_name, Package{}).first;
+    } else if (utimensat(AT_FDCWD, package_dir.c_str(), nullptr, 0)) {
+        // Preserves the LRU order across restarts
+        THROW("utimensat()", errmsg());
+    }
+
+    auto& package = it->second;
+    package.last_used = std::chrono::system_clock::now();
+    ++package.leases_num;
+    return Lease{*this, std::move(package_dir_name)};
+}
+
+PackageFilesCache::Lease::~Lease() {
+    if (!cache) {
+        return;
+    }
+
+    std::lock_guard lock{cache->mutex};
+    auto& package = cache->packages.at(package_dir_name);
+    --package.leases_num;
+    package.last_used = std::chrono::system_clock::now();
+    try {
+        cache->evict_if_needed();
+    } catch (...) {
+        // Nothing we can do here, it will be retried on the next eviction
+    }
+}
+
+std::string PackageFilesCache::Lease::get_file(
+    FilePath path, const std::function<void(FilePath)>& extract_to
+) {
+    auto package_dir = concat_tostr(cache->cache_dir, package_dir_name, '/');
+    auto file_path = concat_tostr(package_dir, to_cached_path(path.to_str()));
+    if (access(file_path, F_OK) == 0) {
+        return file_path;
+    }
+
+    auto tmp_file = TemporaryFile{concat_tostr(package_dir, extracted_tmp_file_prefix, "XXXXXX")};
+    extract_to(tmp_file.path());
+    auto file_size = get_file_size(tmp_file.path());
+
+    std::lock_guard lock{cache->mutex};
+    if (access(file_path, F_OK) == 0) {
+        return file_path; // Another thread has just extracted the file
+    }
+    if (rename(tmp_file.path().c_str(), file_path.c_str())) {
+        THROW("rename()", errmsg());
+    }
+    cache->packages.at(package_dir_name).size_in_bytes += file_size;
+    cache->total_size_in_bytes += file_size;
+    return file_path;
+}
+
+void PackageFilesCache::evict_if_needed() {
+    while (total_size_in_bytes > max_size_in_bytes) {
+        auto victim = packages.end();
+        for (auto it = packages.begin(); it != packages.end(); ++it) {
+            if (it->second.leases_num == 0 &&
+                (victim == packages.end() || it->second.last_used < victim->second.last_used))
+            {
+                victim = it;
+            }
+        }
+        if (victim == packages.end()) {
+            return; // Every package is in use
+        }
+
+        if (remove_r(concat(cache_dir, victim->first)) && errno != ENOENT) {
+            THROW("remove_r()", errmsg());
+        }
+        total_size_in_bytes -= victim->second.size_in_bytes;
+        packages.erase(victim);
+    }
+}
+
+} // namespace sim::judge
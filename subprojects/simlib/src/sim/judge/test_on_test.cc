@@ -1,12 +1,17 @@
 #include "get_checker_output_report.hh"
 
+#include <cerrno>
+#include <csignal>
 #include <fcntl.h>
+#include <memory>
 #include <optional>
 #include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
 #include <simlib/file_descriptor.hh>
 #include <simlib/macros/throw.hh>
 #include <simlib/pipe.hh>
 #include <simlib/sandbox/sandbox.hh>
+#include <simlib/sim/judge/default_checker.hh>
 #include <simlib/sim/judge/test_on_test.hh>
 #include <simlib/sim/judge/test_report.hh>
 #include <simlib/splice_pipelines.hh>
@@ -14,6 +19,7 @@
 #include <simlib/working_directory.hh>
 #include <string_view>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -22,14 +28,78 @@ using std::string_view;
 using BindMount = sandbox::RequestOptions::LinuxNamespaces::Mount::BindMount;
 using CreateFile = sandbox::RequestOptions::LinuxNamespaces::Mount::CreateFile;
 
+namespace {
+
+void set_checker_verdict(
+    sim::judge::TestReport& report, sim::judge::CheckerOutputReport checker_output_report
+) {
+    using sim::judge::CheckerOutputReport;
+    using sim::judge::TestReport;
+    report.status = [&] {
+        switch (checker_output_report.status) {
+        case CheckerOutputReport::Status::CheckerError: return TestReport::Status::CheckerError;
+        case CheckerOutputReport::Status::WrongAnswer: return TestReport::Status::WrongAnswer;
+        case CheckerOutputReport::Status::OK: return TestReport::Status::OK;
+        }
+        __builtin_unreachable();
+    }();
+    report.comment = std::move(checker_output_report.comment);
+    report.score = checker_output_report.score;
+}
+
+struct OutputTransferResult {
+    bool output_size_limit_exceeded;
+    bool wrong_answer;
+};
+
+// Copies the program output from @p prog_stdout_fd to @p output_file_fd feeding it to
+// @p checker. Stops at the end of the output, on exceeding the output size limit or as soon as
+// the answer is certainly wrong (both may happen at once).
+OutputTransferResult stream_program_output(
+    int prog_stdout_fd,
+    int output_file_fd,
+    uint64_t output_size_limit,
+    sim::judge::StreamingDefaultChecker& checker
+) {
+    static constexpr size_t BUFF_SIZE = 1 << 16;
+    auto buff = std::make_unique<char[]>(BUFF_SIZE);
+    for (;;) {
+        auto len = read(prog_stdout_fd, buff.get(), BUFF_SIZE);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            THROW("read()", errmsg());
+        }
+        if (len == 0) {
+            return {.output_size_limit_exceeded = false, .wrong_answer = false};
+        }
+        auto chunk = string_view{buff.get(), static_cast<size_t>(len)};
+        bool output_size_limit_exceeded = chunk.size() > output_size_limit;
+        if (output_size_limit_exceeded) {
+            chunk = chunk.substr(0, output_size_limit);
+        }
+        output_size_limit -= chunk.size();
+        write_all_throw(output_file_fd, chunk);
+        bool wrong_answer = !checker.feed(chunk);
+        if (output_size_limit_exceeded || wrong_answer) {
+            return {
+                .output_size_limit_exceeded = output_size_limit_exceeded,
+                .wrong_answer = wrong_answer,
+            };
+        }
+    }
+}
+
+} // namespace
+
 namespace sim::judge {
 
 TestReport test_on_test(TestArgs args) {
     static const auto page_size = sysconf(_SC_PAGESIZE);
 
     auto prog_output_file = TemporaryFile{"/tmp/sim-judge-test-on-test-program-output.XXXXXX"};
-    auto prog_stdin_file_fd =
-        FileDescriptor{args.test_input, O_RDONLY | O_LARGEFILE | O_CLOEXEC | O_NONBLOCK};
+    auto prog_stdin_file_fd = FileDescriptor{args.test_input, O_RDONLY | O_LARGEFILE | O_CLOEXEC};
     if (!prog_stdin_file_fd.is_open()) {
         THROW("open(", args.test_input, ")", errmsg());
     }
@@ -39,26 +109,46 @@ TestReport test_on_test(TestArgs args) {
         THROW("open(", prog_output_file.path(), ")", errmsg());
     }
 
-    auto stdin_pipe = pipe2(O_CLOEXEC);
-    if (not stdin_pipe) {
-        THROW("pipe2()", errmsg());
+    struct stat64 test_input_st;
+    if (fstat64(prog_stdin_file_fd, &test_input_st)) {
+        THROW("fstat64()", errmsg());
     }
-    if (fcntl(stdin_pipe->writable, F_SETFL, O_NONBLOCK)) {
-        THROW("fcntl()", errmsg());
+    // A regular file is given to the program directly as stdin, other inputs (e.g. FIFOs) are
+    // pumped through a pipe
+    std::optional<Pipe> stdin_pipe;
+    if (S_ISREG(test_input_st.st_mode)) {
+        // Page cache filled by the program would be charged to the program's memory usage, so we
+        // read the input into the page cache beforehand. Failure only affects performance.
+        (void)posix_fadvise(prog_stdin_file_fd, 0, 0, POSIX_FADV_WILLNEED);
+    } else {
+        stdin_pipe = pipe2(O_CLOEXEC);
+        if (not stdin_pipe) {
+            THROW("pipe2()", errmsg());
+        }
+        if (fcntl(stdin_pipe->writable, F_SETFL, O_NONBLOCK)) {
+            THROW("fcntl()", errmsg());
+        }
+    }
+
+    // The default checker can compare the output while it is produced only if there is no stdin
+    // pump running alongside
+    std::optional<StreamingDefaultChecker> streaming_checker;
+    if (args.abort_on_wrong_answer && !args.compiled_checker && !stdin_pipe) {
+        streaming_checker.emplace(args.expected_output);
     }
 
     auto stdout_pipe = pipe2(O_CLOEXEC);
     if (not stdout_pipe) {
         THROW("pipe2()", errmsg());
     }
-    if (fcntl(stdout_pipe->readable, F_SETFL, O_NONBLOCK)) {
+    if (!streaming_checker && fcntl(stdout_pipe->readable, F_SETFL, O_NONBLOCK)) {
         THROW("fcntl()", errmsg());
     }
 
     auto prog_rh = args.compiled_program.async_run(
         {},
         {
-            .stdin_fd = stdin_pipe->readable,
+            .stdin_fd = stdin_pipe ? int{stdin_pipe->readable} : int{prog_stdin_file_fd},
             .stdout_fd = stdout_pipe->writable,
             .stderr_fd = std::nullopt,
             .time_limit = args.program.time_limit,
@@ -73,24 +163,62 @@ TestReport test_on_test(TestArgs args) {
         {}
     );
 
-    if (stdin_pipe->readable.close()) {
+    if (stdin_pipe && stdin_pipe->readable.close()) {
         THROW("close()", errmsg());
     }
     if (stdout_pipe->writable.close()) {
         THROW("close()", errmsg());
     }
 
-    auto splice_res = splice_pipelines({
-        Pipeline{
-            .readable_fd = std::move(prog_stdin_file_fd),
-            .writable_fd = std::move(stdin_pipe->writable),
-        },
-        Pipeline{
+    // The output is not written by the program directly to the file, as the page cache of the
+    // file would be charged to the program's memory usage
+    bool prog_killed_on_wrong_answer = false;
+    auto output_res = [&]() -> OutputTransferResult {
+        if (streaming_checker) {
+            auto res = stream_program_output(
+                stdout_pipe->readable,
+                prog_stdout_file_fd,
+                args.program.output_size_limit_in_bytes,
+                *streaming_checker
+            );
+            if (res.wrong_answer) {
+                prog_rh.request_handle.get_kill_handle().kill();
+                prog_killed_on_wrong_answer = true;
+                // The pipe is kept open, so that the program still writing dies of our SIGKILL
+                // rather than of SIGPIPE
+                return res;
+            }
+            // If the program is still writing, it will get SIGPIPE
+            if (stdout_pipe->readable.close()) {
+                THROW("close()", errmsg());
+            }
+            return res;
+        }
+
+        auto stdout_pipeline = Pipeline{
             .readable_fd = std::move(stdout_pipe->readable),
             .writable_fd = std::move(prog_stdout_file_fd),
             .transferred_data_limit_in_bytes = args.program.output_size_limit_in_bytes,
-        },
-    });
+        };
+        if (stdin_pipe) {
+            auto splice_res = splice_pipelines({
+                Pipeline{
+                    .readable_fd = std::move(prog_stdin_file_fd),
+                    .writable_fd = std::move(stdin_pipe->writable),
+                },
+                std::move(stdout_pipeline),
+            });
+            return {
+                .output_size_limit_exceeded = splice_res.transferred_data_limit_exceeded[1],
+                .wrong_answer = false,
+            };
+        }
+        auto splice_res = splice_pipelines({std::move(stdout_pipeline)});
+        return {
+            .output_size_limit_exceeded = splice_res.transferred_data_limit_exceeded[0],
+            .wrong_answer = false,
+        };
+    }();
 
     auto prog_res = args.compiled_program.await_result(std::move(prog_rh));
     auto prog_cpu_time = prog_res.cgroup.cpu_time.total();
@@ -119,23 +247,43 @@ TestReport test_on_test(TestArgs args) {
         return report;
     }
 
-    if (splice_res.transferred_data_limit_exceeded[1]) {
+    if (output_res.output_size_limit_exceeded) {
         report.status = TestReport::Status::OutputSizeLimitExceeded;
         report.comment = "";
         return report;
     }
 
-    if (prog_res.si != sandbox::Si{.code = CLD_EXITED, .status = 0}) {
+    // The program killed by us because of a wrong answer is judged on the output it has produced.
+    // The program that has died on its own before the kill arrived gets the same verdict as
+    // without the streaming checker.
+    bool prog_died_of_our_kill = prog_killed_on_wrong_answer &&
+        prog_res.si == sandbox::Si{.code = CLD_KILLED, .status = SIGKILL};
+    if (!prog_died_of_our_kill && prog_res.si != sandbox::Si{.code = CLD_EXITED, .status = 0}) {
         report.status = TestReport::Status::RuntimeError;
         report.comment = "Runtime error: " + prog_res.si.description();
         return report;
     }
 
+    if (!args.compiled_checker) {
+        // The accepted output does not need to be compared once again, otherwise we need the
+        // comment describing the difference
+        set_checker_verdict(
+            report,
+            get_checker_output_report(
+                streaming_checker && streaming_checker->accepts_fed_output()
+                    ? "OK\n"
+                    : run_default_checker(args.expected_output, prog_output_file.path()),
+                args.checker.max_comment_len
+            )
+        );
+        return report;
+    }
+
     auto checker_output_fd = FileDescriptor{memfd_create("checker output", MFD_CLOEXEC)};
     if (!checker_output_fd.is_open()) {
         THROW("memfd_create()", errmsg());
     }
-    auto checker_rh = args.compiled_checker.async_run(
+    auto checker_rh = args.compiled_checker->async_run(
         {{
             "/in",
             "/out",
@@ -180,7 +328,7 @@ TestReport test_on_test(TestArgs args) {
             },
         }}
     );
-    auto checker_res = args.compiled_checker.await_result(std::move(checker_rh));
+    auto checker_res = args.compiled_checker->await_result(std::move(checker_rh));
     report.checker = TestReport::Checker{
         .runtime = checker_res.runtime,
         .cpu_time = checker_res.cgroup.cpu_time.total(),
@@ -207,18 +355,10 @@ TestReport test_on_test(TestArgs args) {
         return report;
     }
 
-    auto checker_output_report =
-        get_checker_output_report(std::move(checker_output_fd), args.checker.max_comment_len);
-    report.status = [&] {
-        switch (checker_output_report.status) {
-        case CheckerOutputReport::Status::CheckerError: return TestReport::Status::CheckerError;
-        case CheckerOutputReport::Status::WrongAnswer: return TestReport::Status::WrongAnswer;
-        case CheckerOutputReport::Status::OK: return TestReport::Status::OK;
-        }
-        __builtin_unreachable();
-    }();
-    report.comment = std::move(checker_output_report.comment);
-    report.score = checker_output_report.score;
+    set_checker_verdict(
+        report,
+        get_checker_output_report(std::move(checker_output_fd), args.checker.max_comment_len)
+    );
     return report;
 }
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace sim::judge {
+
+// Maps @p name to a valid file name, different names are mapped to different file names. Produced
+// file names contain no newlines and never start with '.', so the caches may use such file names
+// for themselves.
+inline std::string to_cached_path(std::string_view name) {
+    std::string res;
+    if (name.empty() || name.front() == '.') {
+        res += '\\';
+    }
+    for (auto c : name) {
+        if (c == '\\') {
+            res += "\\\\";
+        } else if (c == ',') {
+            res += "\\,";
+        } else if (c == '/') {
+            res += ',';
+        } else if (c == '\n') {
+            res += "\\n";
+        } else {
+            res += c;
+        }
+    }
+    return res;
+}
+
+} // namespace sim::judge
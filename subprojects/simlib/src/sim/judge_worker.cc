@@ -1,18 +1,21 @@
-#include "default_checker_dump.h"
-
 #include <cmath>
 #include <cstdio>
+#include <deque>
 #include <fcntl.h>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <simlib/concat.hh>
 #include <simlib/concat_tostr.hh>
+#include <simlib/concurrent/bounded_queue.hh>
 #include <simlib/enum_val.hh>
 #include <simlib/file_contents.hh>
 #include <simlib/file_info.hh>
 #include <simlib/libzip.hh>
-#include <simlib/noexcept_concat.hh>
 #include <simlib/sim/judge/language_suite/c_gcc.hh>
 #include <simlib/sim/judge/language_suite/cpp_gcc.hh>
+#include <simlib/sim/judge/language_suite/fully_compiled_language.hh>
 #include <simlib/sim/judge/language_suite/pascal.hh>
 #include <simlib/sim/judge/language_suite/python.hh>
 #include <simlib/sim/judge/language_suite/rust.hh>
@@ -69,14 +72,37 @@ class ZipPackageLoader : public PackageLoader {
     TemporaryDirectory& tmp_dir_; // NOLINT
     ZipFile zip_;
     std::string pkg_main_dir_;
+    timespec pkg_mtime_;
+    std::optional<judge::PackageFilesCache::Lease> cache_lease_;
 
     auto as_pkg_path(FilePath path) { return concat(pkg_main_dir_, path); }
 
+    void extract(FilePath path, FilePath dest) {
+        zip_.extract_to_file(zip_.get_index(as_pkg_path(path)), dest, S_0600);
+        // The extracted file is as old as the package to allow caching e.g. the checker compilation
+        timespec times[] = {{.tv_sec = 0, .tv_nsec = UTIME_OMIT}, pkg_mtime_};
+        if (utimensat(AT_FDCWD, dest, times, 0)) {
+            THROW("utimensat()", errmsg());
+        }
+    }
+
 public:
-    ZipPackageLoader(TemporaryDirectory& tmp_dir, FilePath pkg_path)
+    ZipPackageLoader(
+        TemporaryDirectory& tmp_dir,
+        FilePath pkg_path,
+        std::optional<judge::PackageFilesCache::Lease> cache_lease
+    )
     : tmp_dir_(tmp_dir)
     , zip_(pkg_path, ZIP_RDONLY)
-    , pkg_main_dir_(sim::zip_package_main_dir(zip_)) {}
+    , pkg_main_dir_(sim::zip_package_main_dir(zip_))
+    , pkg_mtime_{[&] {
+        struct stat64 st = {};
+        if (stat64(pkg_path, &st)) {
+            THROW("stat64()", errmsg());
+        }
+        return st.st_mtim;
+    }()}
+    , cache_lease_{std::move(cache_lease)} {}
 
     std::string load_into_dest_file(FilePath path, FilePath dest) override {
         zip_.extract_to_file(zip_.get_index(as_pkg_path(path)), dest, S_0600);
@@ -84,8 +110,11 @@ public:
     }
 
     std::string load_as_file(FilePath path, FilePath hint_name) override {
+        if (cache_lease_) {
+            return cache_lease_->get_file(path, [&](FilePath dest) { extract(path, dest); });
+        }
         auto dest = concat_tostr(tmp_dir_.path(), "from_zip_pgk:", hint_name);
-        zip_.extract_to_file(zip_.get_index(as_pkg_path(path)), dest, S_0600);
+        extract(path, dest);
         return dest;
     }
 
@@ -94,7 +123,10 @@ public:
     }
 };
 
-std::unique_ptr<judge::language_suite::Suite> lang_to_suite(SolutionLanguage lang) {
+std::unique_ptr<judge::language_suite::Suite> lang_to_suite(
+    SolutionLanguage lang,
+    const std::optional<judge::language_suite::Cpp_GCC::PrecompiledHeaders>& cpp_precompiled_headers
+) {
     switch (lang) {
     case SolutionLanguage::UNKNOWN: {
         THROW("unknown programming language");
@@ -111,27 +143,27 @@ std::unique_ptr<judge::language_suite::Suite> lang_to_suite(SolutionLanguage lan
     } break;
     case SolutionLanguage::CPP11: {
         return std::make_unique<judge::language_suite::Cpp_GCC>(
-            judge::language_suite::Cpp_GCC::Standard::Cpp11
+            judge::language_suite::Cpp_GCC::Standard::Cpp11, cpp_precompiled_headers
         );
     } break;
     case SolutionLanguage::CPP14: {
         return std::make_unique<judge::language_suite::Cpp_GCC>(
-            judge::language_suite::Cpp_GCC::Standard::Cpp14
+            judge::language_suite::Cpp_GCC::Standard::Cpp14, cpp_precompiled_headers
         );
     } break;
     case SolutionLanguage::CPP17: {
         return std::make_unique<judge::language_suite::Cpp_GCC>(
-            judge::language_suite::Cpp_GCC::Standard::Cpp17
+            judge::language_suite::Cpp_GCC::Standard::Cpp17, cpp_precompiled_headers
         );
     } break;
     case SolutionLanguage::CPP20: {
         return std::make_unique<judge::language_suite::Cpp_GCC>(
-            judge::language_suite::Cpp_GCC::Standard::Cpp20
+            judge::language_suite::Cpp_GCC::Standard::Cpp20, cpp_precompiled_headers
         );
     } break;
     case SolutionLanguage::CPP23: {
         return std::make_unique<judge::language_suite::Cpp_GCC>(
-            judge::language_suite::Cpp_GCC::Standard::Cpp23
+            judge::language_suite::Cpp_GCC::Standard::Cpp23, cpp_precompiled_headers
         );
     } break;
     case SolutionLanguage::PASCAL: {
@@ -149,14 +181,53 @@ std::unique_ptr<judge::language_suite::Suite> lang_to_suite(SolutionLanguage lan
     __builtin_unreachable();
 }
 
+size_t JudgeWorker::max_concurrent_runs() const noexcept {
+    return max_concurrently_judged_tests * (judge_initial_and_final_concurrently ? 2 : 1);
+}
+
 JudgeWorker::JudgeWorker(JudgeWorkerOptions options)
 : max_executable_size_in_bytes{options.max_executable_size_in_bytes}
 , checker_time_limit{options.checker_time_limit}
 , checker_memory_limit_in_bytes{options.checker_memory_limit_in_bytes}
-, score_cut_lambda{options.score_cut_lambda} {
+, score_cut_lambda{options.score_cut_lambda}
+, max_concurrently_judged_tests{options.max_concurrently_judged_tests}
+, supervisor_pool{options.supervisor_pool}
+, abort_on_wrong_answer{options.abort_on_wrong_answer}
+, judge_initial_and_final_concurrently{options.judge_initial_and_final_concurrently}
+, tracee_cpus{std::move(options.tracee_cpus)}
+, cpp_precompiled_headers{std::move(options.cpp_precompiled_headers)} {
     if (score_cut_lambda < 0 or score_cut_lambda > 1) {
         THROW("score_cut_lambda has to be from [0, 1]");
     }
+    if (max_concurrently_judged_tests == 0) {
+        THROW("max_concurrently_judged_tests has to be greater than 0");
+    }
+}
+
+void JudgeWorker::set_tracee_cpus(const std::optional<std::string>& cpus) {
+    tracee_cpus = cpus;
+    for (auto* suite : {checker_suite.get(), solution_suite.get()}) {
+        if (suite) {
+            suite->set_tracee_cpus(cpus);
+        }
+    }
+}
+
+void JudgeWorker::release_supervisors() {
+    for (auto* suite : {checker_suite.get(), solution_suite.get()}) {
+        if (suite) {
+            suite->release_supervisors();
+        }
+    }
+}
+
+void JudgeWorker::obtain_supervisors_for_concurrent_runs() const {
+    // Supervisors already in use are reused
+    for (auto* suite : {checker_suite.get(), solution_suite.get()}) {
+        if (suite) {
+            suite->set_max_concurrent_runs(max_concurrent_runs());
+        }
+    }
 }
 
 int JudgeWorker::compile_checker(
@@ -172,44 +243,25 @@ int JudgeWorker::compile_checker(
         THROW("cached_name is required if cache is provided");
     }
 
-    auto [source_path, lang] = [&]() -> std::pair<std::string, SolutionLanguage> {
-        if (sf.checker.has_value()) {
-            return {
-                [](auto path) {
-                    if (has_prefix(path, "/")) {
-                        return path;
-                    }
-                    return concat_tostr(get_cwd(), path);
-                }(package_loader->load_as_file(sf.checker.value(), "checker")),
-                filename_to_lang(sf.checker.value())
-            };
-        }
+    if (!sf.checker) {
+        checker_suite = nullptr; // the default checker is run in-process, see test_on_test()
+        return 0;
+    }
 
-        auto path = concat_tostr(tmp_dir.path(), "default_checker.c");
-        put_file_contents(
-            path, reinterpret_cast<const char*>(default_checker_c), default_checker_c_len
-        );
-        // Change the modification time to the compilation time to allow caching the default checker
-        static timespec compilation_datetime = [] {
-            constexpr auto compilation_datetime_str = noexcept_concat(__DATE__, ' ', __TIME__);
-            struct tm t = {};
-            throw_assert(
-                strptime(compilation_datetime_str.c_str(), "%b %d %Y %H:%M:%S", &t) != nullptr
-            );
-            t.tm_isdst =
-                -1; // use timezone information to check if daylight saving time is in effect
-            time_t compilation_datetime = mktime(&t);
-            throw_assert(compilation_datetime != static_cast<time_t>(-1));
-            return timespec{.tv_sec = compilation_datetime, .tv_nsec = 0};
-        }();
-        timespec times[] = {{.tv_sec = 0, .tv_nsec = UTIME_OMIT}, compilation_datetime};
-        if (utimensat(AT_FDCWD, path.c_str(), times, 0)) {
-            THROW("utimensat()");
+    auto source_path = [](auto path) {
+        if (has_prefix(path, "/")) {
+            return path;
         }
-        return {path, SolutionLanguage::C};
-    }();
+        return concat_tostr(get_cwd(), path);
+    }(package_loader->load_as_file(sf.checker.value(), "checker"));
+    auto lang = filename_to_lang(sf.checker.value());
 
-    checker_suite = lang_to_suite(lang);
+    checker_suite = lang_to_suite(lang, cpp_precompiled_headers);
+    if (supervisor_pool) {
+        checker_suite->set_supervisor_pool(*supervisor_pool);
+    }
+    checker_suite->set_max_concurrent_runs(max_concurrent_runs());
+    checker_suite->set_tracee_cpus(tracee_cpus);
     auto res = checker_suite->compile(
         source_path,
         {
@@ -234,6 +286,37 @@ int JudgeWorker::compile_checker(
     return 0;
 }
 
+std::future<int> JudgeWorker::async_compile_checker(
+    std::chrono::nanoseconds time_limit,
+    uint64_t compiler_memory_limit_in_bytes,
+    std::string* c_errors,
+    size_t c_errors_max_len,
+    judge::CompilationCache* cache,
+    std::optional<std::string> cached_name
+) {
+    // The checker and the solution have separate suites (and supervisors), so the compilations do
+    // not interfere
+    return std::async(
+        std::launch::async,
+        [this,
+         time_limit,
+         compiler_memory_limit_in_bytes,
+         c_errors,
+         c_errors_max_len,
+         cache,
+         cached_name = std::move(cached_name)]() mutable {
+            return compile_checker(
+                time_limit,
+                compiler_memory_limit_in_bytes,
+                c_errors,
+                c_errors_max_len,
+                cache,
+                std::move(cached_name)
+            );
+        }
+    );
+}
+
 int JudgeWorker::compile_solution(
     FilePath source,
     SolutionLanguage lang,
@@ -242,12 +325,18 @@ int JudgeWorker::compile_solution(
     std::string* c_errors,
     size_t c_errors_max_len,
     judge::CompilationCache* cache,
-    std::optional<std::string> cached_name
+    std::optional<std::string> cached_name,
+    bool content_addressed_cache
 ) {
     if (cache && !cached_name) {
         THROW("cached_name is required if cache is provided");
     }
-    solution_suite = lang_to_suite(lang);
+    solution_suite = lang_to_suite(lang, cpp_precompiled_headers);
+    if (supervisor_pool) {
+        solution_suite->set_supervisor_pool(*supervisor_pool);
+    }
+    solution_suite->set_max_concurrent_runs(max_concurrent_runs());
+    solution_suite->set_tracee_cpus(tracee_cpus);
     auto res = solution_suite->compile(
         has_prefix(StringView{source}, "/") ? concat_tostr(source)
                                             : concat_tostr(get_cwd(), source),
@@ -259,6 +348,7 @@ int JudgeWorker::compile_solution(
             .cache = cache ? std::optional{sim::judge::language_suite::Suite::CompileOptions::Cache{
                                  .compilation_cache = *cache,
                                  .cached_name = *cached_name, // NOLINT
+                                 .content_addressed = content_addressed_cache,
                              }}
                            : std::nullopt,
         }
@@ -273,13 +363,31 @@ int JudgeWorker::compile_solution(
     return 0;
 }
 
-void JudgeWorker::load_package(FilePath package_path, std::optional<string> simfile) {
+std::string JudgeWorker::solution_compiler_identity() const {
+    auto* suite =
+        dynamic_cast<const judge::language_suite::FullyCompiledLanguage*>(solution_suite.get());
+    return suite ? suite->compiler_identity() : "";
+}
+
+void JudgeWorker::load_package(
+    FilePath package_path,
+    std::optional<string> simfile,
+    judge::PackageFilesCache* cache,
+    std::optional<std::string> cached_name
+) {
     STACK_UNWINDING_MARK;
+    if (cache && !cached_name) {
+        THROW("cached_name is required if cache is provided");
+    }
 
     if (is_directory(package_path)) {
         package_loader = std::make_unique<DirPackageLoader>(package_path);
     } else {
-        package_loader = std::make_unique<ZipPackageLoader>(tmp_dir, package_path);
+        package_loader = std::make_unique<ZipPackageLoader>(
+            tmp_dir,
+            package_path,
+            cache ? std::optional{cache->lease(*cached_name)} : std::nullopt // NOLINT
+        );
     }
 
     if (simfile.has_value()) {
@@ -350,6 +458,62 @@ struct CheckerStatus {
     std::string message;
 };
 
+// Runs up to lanes_num judgings at the same time, each one on a different lane (lanes are
+// numbered from first_lane). Results are collected in the order the judgings were added. With one
+// lane judgings are run lazily in the calling thread.
+template <class Result>
+class ConcurrentJudgings {
+    size_t lanes_num;
+    std::vector<size_t> idle_lanes;
+    std::deque<std::pair<std::optional<size_t>, std::future<Result>>> queue;
+
+public:
+    explicit ConcurrentJudgings(size_t lanes_num, size_t first_lane = 0) : lanes_num{lanes_num} {
+        for (size_t lane = first_lane + lanes_num; lane-- > first_lane;) {
+            idle_lanes.emplace_back(lane);
+        }
+    }
+
+    [[nodiscard]] bool has_idle_lane() const noexcept { return !idle_lanes.empty(); }
+
+    // Func is called as judge_on_lane(size_t lane) and has to return Result
+    template <class Func>
+    void add(Func&& judge_on_lane) {
+        throw_assert(has_idle_lane());
+        auto lane = idle_lanes.back();
+        idle_lanes.pop_back();
+        queue.emplace_back(
+            lane,
+            std::async(
+                lanes_num == 1 ? std::launch::deferred : std::launch::async,
+                [lane, judge_on_lane = std::forward<Func>(judge_on_lane)]() mutable {
+                    return judge_on_lane(lane);
+                }
+            )
+        );
+    }
+
+    // Adds the already known result
+    void add_ready(Result result) {
+        std::promise<Result> promise;
+        promise.set_value(std::move(result));
+        queue.emplace_back(std::nullopt, promise.get_future());
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return queue.empty(); }
+
+    // Waits for the earliest added judging
+    Result collect() {
+        throw_assert(!queue.empty());
+        auto [lane, future] = std::move(queue.front());
+        queue.pop_front();
+        if (lane) {
+            idle_lanes.emplace_back(*lane);
+        }
+        return future.get();
+    }
+};
+
 } // namespace
 
 template <class Func>
@@ -364,10 +528,22 @@ JudgeReport JudgeWorker::process_tests(
     JudgeReport report;
     judge_log.begin(final);
 
+    // Initial and final tests may be judged at the same time (see judge_initial_and_final()), so
+    // they use different lanes
+    ConcurrentJudgings<TestResult> judgings{
+        max_concurrently_judged_tests, final ? max_concurrently_judged_tests : 0
+    };
+    auto log_test = [&](const Simfile::Test& test, const TestResult& res) {
+        judge_log.test(test.name, res.report, res.judge_report, checker_memory_limit_in_bytes);
+    };
+
     // First round - judge as little as possible to compute total score
     bool test_were_skipped = false;
     uint64_t total_score = 0;
     uint64_t max_score = 0;
+    // Tests that were judged concurrently with the test after which the rest of the group is
+    // skipped; they are reported in the second round: [report group idx][test idx] -> result
+    std::vector<std::vector<std::optional<TestResult>>> judged_skipped_tests;
     for (const auto& group : sf.tgroups) {
         // Group "0" goes to the initial report, others groups to final
         auto p = Simfile::TestNameComparator::split(group.tests[0].name);
@@ -377,14 +553,26 @@ JudgeReport JudgeWorker::process_tests(
 
         report.groups.emplace_back();
         auto& report_group = report.groups.back();
+        auto& judged_skipped_group_tests = judged_skipped_tests.emplace_back();
 
         double group_score_ratio = 1.0;
         auto calc_group_score = [&] {
             return static_cast<int64_t>(round(group.score * group_score_ratio));
         };
 
+        size_t added_tests_num = 0;
+        auto add_judgings = [&] {
+            while (added_tests_num < group.tests.size() && judgings.has_idle_lane()) {
+                judgings.add([&judge_on_test, &test = group.tests[added_tests_num]](size_t lane) {
+                    return judge_on_test(test, lane);
+                });
+                ++added_tests_num;
+            }
+        };
+
         bool skip_tests = false;
-        for (const auto& test : group.tests) {
+        for (size_t ti = 0; ti < group.tests.size(); ++ti) {
+            const auto& test = group.tests[ti];
             if (skip_tests) {
                 test_were_skipped = true;
                 report_group.tests.emplace_back(
@@ -396,8 +584,16 @@ JudgeReport JudgeWorker::process_tests(
                     test.memory_limit,
                     string{}
                 );
+                if (ti < added_tests_num) {
+                    judged_skipped_group_tests.resize(group.tests.size());
+                    judged_skipped_group_tests[ti] = judgings.collect();
+                }
             } else {
-                report_group.tests.emplace_back(judge_on_test(test, group_score_ratio));
+                add_judgings();
+                auto res = judgings.collect();
+                group_score_ratio = std::min(group_score_ratio, res.judge_report.score);
+                log_test(test, res);
+                report_group.tests.emplace_back(std::move(res.report));
 
                 // Update group_score_ratio
                 if (score_cut_lambda < 1) { // Only then the scaling occurs
@@ -438,6 +634,13 @@ JudgeReport JudgeWorker::process_tests(
         partial_report_callback.value()(report);
 
         // Second round - judge remaining tests
+        struct RemainingTest {
+            const Simfile::Test& test;
+            JudgeReport::Test& report;
+            std::optional<TestResult>& judged;
+        };
+
+        std::vector<RemainingTest> remaining_tests;
         for (size_t gi = 0, rgi = 0; gi < sf.tgroups.size(); ++gi) {
             const auto& group = sf.tgroups[gi];
 
@@ -447,17 +650,42 @@ JudgeReport JudgeWorker::process_tests(
                 continue;
             }
 
-            auto& report_group = report.groups[rgi++];
-
-            double group_score_ratio = 0; // Remaining tests have ratio == 0
+            auto& report_group = report.groups[rgi];
+            auto& judged_skipped_group_tests = judged_skipped_tests[rgi];
+            ++rgi;
+            judged_skipped_group_tests.resize(group.tests.size());
             for (size_t ti = 0; ti < group.tests.size(); ++ti) {
-                const auto& test = group.tests[ti];
                 auto& test_report = report_group.tests[ti];
                 if (test_report.status == JudgeReport::Test::SKIPPED) {
-                    test_report = judge_on_test(test, group_score_ratio);
+                    remaining_tests.push_back({
+                        .test = group.tests[ti],
+                        .report = test_report,
+                        .judged = judged_skipped_group_tests[ti],
+                    });
                 }
             }
         }
+
+        size_t added_tests_num = 0;
+        for (auto& remaining_test : remaining_tests) {
+            while (added_tests_num < remaining_tests.size()) {
+                auto& rt = remaining_tests[added_tests_num];
+                if (rt.judged) {
+                    judgings.add_ready(std::move(*rt.judged));
+                } else if (judgings.has_idle_lane()) {
+                    judgings.add([&judge_on_test, &test = rt.test](size_t lane) {
+                        return judge_on_test(test, lane);
+                    });
+                } else {
+                    break;
+                }
+                ++added_tests_num;
+            }
+
+            auto res = judgings.collect();
+            log_test(remaining_test.test, res);
+            remaining_test.report = std::move(res.report);
+        }
     }
 
     judge_log.end();
@@ -471,14 +699,46 @@ JudgeReport JudgeWorker::judge(
     const std::optional<std::function<void(const JudgeReport&)>>& partial_report_callback
 ) const {
     STACK_UNWINDING_MARK;
-    auto judge_on_test = [&](const sim::Simfile::Test& test, double& group_score_ratio) {
+    std::mutex package_loader_mutex;
+    std::atomic<bool> cancelled = false;
+    obtain_supervisors_for_concurrent_runs();
+    return judge(final, judge_log, partial_report_callback, package_loader_mutex, cancelled);
+}
+
+JudgeReport JudgeWorker::judge(
+    bool final,
+    JudgeLogger& judge_log,
+    const std::optional<std::function<void(const JudgeReport&)>>& partial_report_callback,
+    std::mutex& package_loader_mutex,
+    const std::atomic<bool>& cancelled
+) const {
+    STACK_UNWINDING_MARK;
+    auto judge_on_test = [&](const sim::Simfile::Test& test, size_t lane) {
         STACK_UNWINDING_MARK;
+        if (cancelled) {
+            THROW("judging cancelled");
+        }
+        if (auto it = judged_tests.find(test.name); it != judged_tests.end()) {
+            return it->second;
+        }
+
+        // Every lane needs its own files
+        auto [test_input, expected_output] = [&] {
+            std::lock_guard lock{package_loader_mutex};
+            return std::pair{
+                package_loader->load_as_file(test.in, concat_tostr("test.in.", lane)),
+                sf.interactive ? string{}
+                               : package_loader->load_as_file(
+                                     test.out.value(), concat_tostr("test.out.", lane)
+                                 ),
+            };
+        }();
 
         auto tr = sf.interactive
             ? judge::test_on_interactive_test({
                   .compiled_program = *solution_suite,
                   .compiled_checker = *checker_suite,
-                  .test_input = package_loader->load_as_file(test.in, "test.in"),
+                  .test_input = test_input,
                   .program =
                       {
                           .time_limit = cpu_time_limit_to_real_time_limit(test.time_limit),
@@ -495,9 +755,9 @@ JudgeReport JudgeWorker::judge(
               })
             : judge::test_on_test({
                   .compiled_program = *solution_suite,
-                  .compiled_checker = *checker_suite,
-                  .test_input = package_loader->load_as_file(test.in, "test.in"),
-                  .expected_output = package_loader->load_as_file(test.out.value(), "test.out"),
+                  .compiled_checker = checker_suite.get(),
+                  .test_input = test_input,
+                  .expected_output = expected_output,
                   .program =
                       {
                           .time_limit = cpu_time_limit_to_real_time_limit(test.time_limit),
@@ -512,6 +772,7 @@ JudgeReport JudgeWorker::judge(
                           .memory_limit_in_bytes = checker_memory_limit_in_bytes,
                           .max_comment_len = 256,
                       },
+                  .abort_on_wrong_answer = abort_on_wrong_answer,
               });
 
         JudgeReport::Test test_report(
@@ -524,7 +785,6 @@ JudgeReport JudgeWorker::judge(
             string{}
         );
 
-        group_score_ratio = std::min(group_score_ratio, tr.score);
         test_report.comment = tr.comment;
 
         switch (tr.status) {
@@ -555,13 +815,95 @@ JudgeReport JudgeWorker::judge(
         } break;
         }
 
-        // Logging
-        judge_log.test(test.name, test_report, tr, checker_memory_limit_in_bytes);
-
-        return test_report;
+        auto res = TestResult{
+            .report = std::move(test_report),
+            .judge_report = std::move(tr),
+        };
+        if (test_judged_callback) {
+            test_judged_callback(res);
+        }
+        return res;
     };
 
     return process_tests(final, judge_log, partial_report_callback, judge_on_test);
 }
 
+std::pair<JudgeReport, JudgeReport> JudgeWorker::judge_initial_and_final(
+    JudgeLogger& initial_judge_log,
+    JudgeLogger& final_judge_log,
+    const std::function<void(const JudgeReport&, bool final, bool partial)>& report_callback
+) const {
+    STACK_UNWINDING_MARK;
+    std::mutex package_loader_mutex;
+    std::atomic<bool> cancelled = false;
+    obtain_supervisors_for_concurrent_runs();
+    auto judge_phase = [&](bool final, JudgeLogger& judge_log, auto&& partial_report_callback) {
+        return judge(
+            final,
+            judge_log,
+            std::function<void(const JudgeReport&)>{partial_report_callback},
+            package_loader_mutex,
+            cancelled
+        );
+    };
+    auto judge_initial = [&] {
+        auto report =
+            judge_phase(false, initial_judge_log, [&](const JudgeReport& partial_report) {
+                report_callback(partial_report, false, true);
+            });
+        report_callback(report, false, false);
+        return report;
+    };
+
+    if (!judge_initial_and_final_concurrently) {
+        auto initial_report = judge_initial();
+        auto final_report =
+            judge_phase(true, final_judge_log, [&](const JudgeReport& partial_report) {
+                report_callback(partial_report, true, true);
+            });
+        report_callback(final_report, true, false);
+        return {std::move(initial_report), std::move(final_report)};
+    }
+
+    // Reports of the final tests are passed to the calling thread, so that all the initial reports
+    // are passed to report_callback() first: (report, is partial)
+    concurrent::BoundedQueue<std::pair<JudgeReport, bool>> final_reports;
+    auto final_judging = std::async(std::launch::async, [&] {
+        try {
+            auto report =
+                judge_phase(true, final_judge_log, [&](const JudgeReport& partial_report) {
+                    final_reports.push({partial_report, true});
+                });
+            final_reports.push({std::move(report), false});
+        } catch (...) {
+            final_reports.signal_no_more_elems();
+            throw;
+        }
+    });
+
+    try {
+        auto initial_report = judge_initial();
+        for (;;) {
+            auto elem = final_reports.pop_opt();
+            if (!elem) {
+                final_judging.get(); // rethrows the exception thrown while judging the final tests
+                THROW("BUG: final tests were judged without a report");
+            }
+            auto& [report, partial] = *elem;
+            report_callback(report, true, partial);
+            if (!partial) {
+                final_judging.get();
+                return {std::move(initial_report), std::move(report)};
+            }
+        }
+    } catch (...) {
+        // Do not wait for all the remaining final tests to be judged, only for the ones in progress
+        cancelled = true;
+        if (final_judging.valid()) {
+            final_judging.wait();
+        }
+        throw;
+    }
+}
+
 } // namespace sim
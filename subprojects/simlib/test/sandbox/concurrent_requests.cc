@@ -0,0 +1,67 @@
+#include "assert_result.hh"
+
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <simlib/pipe.hh>
+#include <simlib/sandbox/sandbox.hh>
+#include <simlib/throw_assert.hh>
+#include <stdexcept>
+#include <vector>
+
+using std::vector;
+
+// NOLINTNEXTLINE
+TEST(sandbox, concurrent_requests_run_in_parallel) {
+    auto sc = sandbox::spawn_supervisor({.max_concurrent_requests = 2});
+    auto pipe = pipe2(O_CLOEXEC);
+    throw_assert(pipe);
+    // The reader would be killed by the time limit if the writer started only after it finished
+    auto reader_rh = sc.send_request(
+        {{"/bin/sh", "-c", "read -r line && [ \"$line\" = hello ]"}},
+        {
+            .stdin_fd = pipe->readable,
+            .time_limit = std::chrono::seconds{10},
+        }
+    );
+    auto writer_rh = sc.send_request({{"/bin/echo", "hello"}}, {.stdout_fd = pipe->writable});
+    ASSERT_EQ(pipe->readable.close(), 0);
+    ASSERT_EQ(pipe->writable.close(), 0);
+    ASSERT_RESULT_OK(sc.await_result(std::move(writer_rh)), CLD_EXITED, 0);
+    ASSERT_RESULT_OK(sc.await_result(std::move(reader_rh)), CLD_EXITED, 0);
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox, more_requests_than_max_concurrent_requests) {
+    auto sc = sandbox::spawn_supervisor({.max_concurrent_requests = 3});
+    vector<sandbox::SupervisorConnection::RequestHandle> rhs;
+    rhs.reserve(10);
+    for (int i = 0; i < 10; ++i) {
+        rhs.emplace_back(sc.send_request({{i % 2 == 0 ? "/bin/true" : "/bin/false"}}));
+    }
+    for (int i = 9; i >= 0; --i) {
+        ASSERT_RESULT_OK(sc.await_result(std::move(rhs[i])), CLD_EXITED, i % 2);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox, killing_and_cancelling_concurrent_requests) {
+    auto sc = sandbox::spawn_supervisor({.max_concurrent_requests = 3});
+    auto killed_rh = sc.send_request({{"/bin/sleep", "10"}});
+    sc.send_request({{"/bin/sleep", "infinity"}}).cancel();
+    auto rh = sc.send_request({{"/bin/true"}});
+    killed_rh.get_kill_handle().kill();
+    ASSERT_RESULT_OK(sc.await_result(std::move(rh)), CLD_EXITED, 0);
+    ASSERT_RESULT_OK(sc.await_result(std::move(killed_rh)), CLD_KILLED, SIGKILL);
+    ASSERT_RESULT_OK(sc.await_result(sc.send_request({{"/bin/false"}})), CLD_EXITED, 1);
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox, invalid_max_concurrent_requests) {
+    ASSERT_THAT(
+        [&] { (void)sandbox::spawn_supervisor({.max_concurrent_requests = 0}); },
+        testing::ThrowsMessage<std::runtime_error>(
+            testing::StartsWith("max_concurrent_requests has to be in range [1, 1024]")
+        )
+    );
+}
@@ -121,3 +121,12 @@ TEST(sandbox, negative_stderr_file_descriptor) {
         )
     );
 }
+
+// NOLINTNEXTLINE
+TEST(sandbox, invalid_cpuset_cpus) {
+    auto sc = sandbox::spawn_supervisor();
+    ASSERT_THAT(
+        [&] { (void)sc.send_request({{"/bin/true"}}, {.cgroup = {.cpuset_cpus = "0;1"}}); },
+        testing::ThrowsMessage<std::runtime_error>(testing::StartsWith("invalid cpuset_cpus: 0;1"))
+    );
+}
@@ -0,0 +1,56 @@
+#include <cerrno>
+#include <gtest/gtest.h>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sandbox/seccomp/prebuilt_bpf.hh>
+#include <simlib/string_view.hh>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+FileDescriptor memfd_with(StringView contents) {
+    auto fd = FileDescriptor{memfd_create("test bpf", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+    if (!fd.is_open()) {
+        THROW("memfd_create()", errmsg());
+    }
+    write_all_throw(fd, contents);
+    return fd;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(sandbox_seccomp, prebuilt_bpf_fd_builds_every_policy_once) {
+    int builds_num = 0;
+    auto build_a = [&] {
+        ++builds_num;
+        return memfd_with("aaaaaaaa");
+    };
+    int fd = sandbox::seccomp::prebuilt_bpf_fd("test_policy_a", build_a);
+    EXPECT_EQ(sandbox::seccomp::prebuilt_bpf_fd("test_policy_a", build_a), fd);
+    EXPECT_EQ(builds_num, 1);
+
+    int other_fd = sandbox::seccomp::prebuilt_bpf_fd("test_policy_b", [&] {
+        ++builds_num;
+        return memfd_with("bbbbbbbb");
+    });
+    EXPECT_NE(other_fd, fd);
+    EXPECT_EQ(builds_num, 2);
+    EXPECT_EQ(get_file_contents(fd, 0, -1), "aaaaaaaa");
+    EXPECT_EQ(get_file_contents(other_fd, 0, -1), "bbbbbbbb");
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox_seccomp, prebuilt_bpf_fd_is_immutable) {
+    int fd = sandbox::seccomp::prebuilt_bpf_fd("test_policy_immutable", [] {
+        return memfd_with("aaaaaaaa");
+    });
+    EXPECT_EQ(pwrite(fd, "b", 1, 0), -1);
+    EXPECT_EQ(errno, EPERM);
+    EXPECT_EQ(ftruncate(fd, 0), -1);
+    EXPECT_EQ(errno, EPERM);
+    EXPECT_EQ(get_file_contents(fd, 0, -1), "aaaaaaaa");
+}
@@ -0,0 +1,103 @@
+#include "assert_result.hh"
+
+#include <gtest/gtest.h>
+#include <simlib/sandbox/sandbox.hh>
+#include <simlib/sandbox/supervisor_pool.hh>
+#include <stdexcept>
+
+// NOLINTNEXTLINE
+TEST(sandbox_SupervisorPool, reuses_returned_supervisors) {
+    auto pool = sandbox::SupervisorPool{{
+        .max_idle_supervisors = 1,
+        .max_requests_per_supervisor = 0,
+    }};
+    {
+        auto sc = pool.lease();
+        ASSERT_RESULT_OK(sc->await_result(sc->send_request({{"/bin/true"}})), CLD_EXITED, 0);
+    }
+    auto sc = pool.lease();
+    EXPECT_EQ(sc->sent_requests_num(), 1);
+    ASSERT_RESULT_OK(sc->await_result(sc->send_request({{"/bin/false"}})), CLD_EXITED, 1);
+    // The only idle supervisor is leased
+    EXPECT_EQ(pool.lease()->sent_requests_num(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox_SupervisorPool, recycles_supervisors) {
+    auto pool = sandbox::SupervisorPool{{
+        .max_idle_supervisors = 1,
+        .max_requests_per_supervisor = 2,
+    }};
+    for (int i = 0; i < 5; ++i) {
+        auto sc = pool.lease();
+        EXPECT_EQ(sc->sent_requests_num(), i % 2);
+        ASSERT_RESULT_OK(sc->await_result(sc->send_request({{"/bin/true"}})), CLD_EXITED, 0);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox_SupervisorPool, does_not_keep_more_idle_supervisors_than_allowed) {
+    auto pool = sandbox::SupervisorPool{{
+        .max_idle_supervisors = 1,
+        .max_requests_per_supervisor = 0,
+    }};
+    {
+        auto sc1 = pool.lease();
+        auto sc2 = pool.lease();
+        ASSERT_RESULT_OK(sc1->await_result(sc1->send_request({{"/bin/true"}})), CLD_EXITED, 0);
+        ASSERT_RESULT_OK(sc2->await_result(sc2->send_request({{"/bin/true"}})), CLD_EXITED, 0);
+    }
+    EXPECT_EQ(pool.lease()->sent_requests_num(), 1);
+    EXPECT_EQ(pool.lease()->sent_requests_num(), 1); // the same supervisor
+    {
+        auto sc1 = pool.lease();
+        auto sc2 = pool.lease();
+        EXPECT_EQ(sc1->sent_requests_num() + sc2->sent_requests_num(), 1);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox_SupervisorPool, does_not_reuse_supervisors_released_during_stack_unwinding) {
+    auto pool = sandbox::SupervisorPool{{
+        .max_idle_supervisors = 1,
+        .max_requests_per_supervisor = 0,
+    }};
+    try {
+        auto sc = pool.lease();
+        ASSERT_RESULT_OK(sc->await_result(sc->send_request({{"/bin/true"}})), CLD_EXITED, 0);
+        throw std::runtime_error{"test"};
+    } catch (const std::runtime_error&) {
+    }
+    EXPECT_EQ(pool.lease()->sent_requests_num(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox_SupervisorPool, warm_up) {
+    auto pool = sandbox::SupervisorPool{{
+        .max_idle_supervisors = 2,
+        .max_requests_per_supervisor = 0,
+    }};
+    pool.warm_up(3);
+    auto sc1 = pool.lease();
+    auto sc2 = pool.lease();
+    EXPECT_TRUE(sc1->is_healthy());
+    EXPECT_TRUE(sc2->is_healthy());
+}
+
+// NOLINTNEXTLINE
+TEST(sandbox_SupervisorPool, counts_leases_and_spawned_supervisors) {
+    auto pool = sandbox::SupervisorPool{{
+        .max_idle_supervisors = 1,
+        .max_requests_per_supervisor = 0,
+    }};
+    pool.warm_up(1);
+    EXPECT_EQ(pool.leases_num(), 0);
+    EXPECT_EQ(pool.spawned_supervisors_num(), 1);
+    {
+        auto sc1 = pool.lease();
+        auto sc2 = pool.lease();
+    }
+    (void)pool.lease();
+    EXPECT_EQ(pool.leases_num(), 3);
+    EXPECT_EQ(pool.spawned_supervisors_num(), 2);
+}
@@ -0,0 +1,135 @@
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <simlib/concat_tostr.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/sim/judge/default_checker.hh>
+#include <simlib/temporary_file.hh>
+#include <string>
+#include <string_view>
+
+using sim::judge::run_default_checker;
+using sim::judge::StreamingDefaultChecker;
+
+namespace {
+
+std::string check(std::string_view expected_output, std::string_view program_output) {
+    auto expected_output_file = TemporaryFile{"/tmp/sim_judge_default_checker_out.XXXXXX"};
+    put_file_contents(expected_output_file.path(), expected_output);
+    auto program_output_file = TemporaryFile{"/tmp/sim_judge_default_checker_ans.XXXXXX"};
+    put_file_contents(program_output_file.path(), program_output);
+    return run_default_checker(expected_output_file.path(), program_output_file.path());
+}
+
+std::string check_streaming(
+    std::string_view expected_output, std::initializer_list<std::string_view> program_output_chunks
+) {
+    auto expected_output_file = TemporaryFile{"/tmp/sim_judge_default_checker_out.XXXXXX"};
+    put_file_contents(expected_output_file.path(), expected_output);
+    auto checker = StreamingDefaultChecker{expected_output_file.path()};
+    size_t fed_chunks = 0;
+    for (auto chunk : program_output_chunks) {
+        ++fed_chunks;
+        if (!checker.feed(chunk)) {
+            return concat_tostr("wrong after chunk ", fed_chunks);
+        }
+    }
+    return checker.accepts_fed_output() ? "accepted" : "not accepted";
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, ok) {
+    EXPECT_EQ(check("", ""), "OK\n");
+    EXPECT_EQ(check("1 2\n3\n", "1 2\n3\n"), "OK\n");
+    EXPECT_EQ(check("1 2\n3\n", "1 2   \n3"), "OK\n");
+    EXPECT_EQ(check("1 2   \n3", "1 2\n3\n"), "OK\n");
+    EXPECT_EQ(check("", "\n \n"), "OK\n");
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, difference_inside_line) {
+    EXPECT_EQ(
+        check("1 2 3\n", "1 2 4\n"), "WRONG\n0\nLine 1 column 5: read '4', expected '3'\n"
+    );
+    EXPECT_EQ(
+        check("abc 12345 x\n", "abc 12395 x\n"),
+        "WRONG\n0\nLine 1 column 5: read '12395 x', expected '12345 x'\n"
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, unexpected_end_of_line) {
+    EXPECT_EQ(
+        check("1 2\n3\n", "1 2 5\n3\n"), "WRONG\n0\nLine 1 column 5: read '5', expected ''\n"
+    );
+    EXPECT_EQ(
+        check("1 2 5\n3\n", "1 2\n3\n"), "WRONG\n0\nLine 1 column 4: read '', expected '5'\n"
+    );
+    EXPECT_EQ(
+        check("abc\n\ndef\n", "abc\ndef\n"),
+        "WRONG\n0\nLine 2 column 1: read 'def', expected ''\n"
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, unexpected_end_of_file) {
+    EXPECT_EQ(
+        check("1 2\n3\n", "1 2\n"),
+        "WRONG\n0\nLine 2 column 1: read end of file, expected '3'\n"
+    );
+    EXPECT_EQ(
+        check("1\n", "1\n2\n"), "WRONG\n0\nLine 2 column 1: read '2', expected end of file\n"
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, long_context_is_shortened) {
+    auto expected_output =
+        concat_tostr("x\n", std::string(100, 'a'), 'b', std::string(100, 'c'), '\n');
+    auto program_output =
+        concat_tostr("x\n", std::string(100, 'a'), 'd', std::string(100, 'c'), '\n');
+    EXPECT_EQ(
+        check(expected_output, program_output),
+        concat_tostr(
+            "WRONG\n0\nLine 2 column 80: read '...",
+            std::string(21, 'a'),
+            'd',
+            std::string(61, 'c'),
+            "...', expected '...",
+            std::string(21, 'a'),
+            'b',
+            std::string(61, 'c'),
+            "...'\n"
+        )
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, streaming_ok) {
+    EXPECT_EQ(check_streaming("", {}), "accepted");
+    EXPECT_EQ(check_streaming("1 2\n3\n", {"1 ", "2\n3", "\n"}), "accepted");
+    EXPECT_EQ(check_streaming("1 2\n3\n", {"1 2 ", "  \n", "3"}), "accepted");
+    EXPECT_EQ(check_streaming("1 2   \n3", {"1 2\n", "3\n", "\n \n"}), "accepted");
+    EXPECT_EQ(check_streaming("", {"\n \n"}), "accepted");
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, streaming_wrong_answer_is_detected_early) {
+    EXPECT_EQ(check_streaming("1 2 3\n", {"1 2", " 4", "\n"}), "wrong after chunk 2");
+    EXPECT_EQ(check_streaming("1 2\n3\n", {"1 2 ", "5", "\n3\n"}), "wrong after chunk 2");
+    EXPECT_EQ(check_streaming("abc\n\ndef\n", {"abc\n", "def", "\n"}), "wrong after chunk 2");
+    EXPECT_EQ(check_streaming("1\n", {"1\n", "\n", "2"}), "wrong after chunk 3");
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_default_checker, streaming_whitespace_is_not_a_certain_difference) {
+    // Whitespace may turn out to be trailing
+    EXPECT_EQ(check_streaming("1 2\n", {"1 2", "  ", "\n"}), "accepted");
+    EXPECT_EQ(check_streaming("1\n", {"1", "\n\n  \n"}), "accepted");
+    EXPECT_EQ(check_streaming("1 2\n", {"1 2", "  "}), "accepted");
+    // The output may still be continued
+    EXPECT_EQ(check_streaming("1 2\n3\n", {"1 2\n"}), "not accepted");
+    EXPECT_EQ(check_streaming("1 2\n3\n", {"1 2\n", " "}), "not accepted");
+}
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <simlib/concat_tostr.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/sim/judge/disk_compilation_cache.hh>
+#include <simlib/string_view.hh>
+#include <simlib/temporary_directory.hh>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+using sim::judge::DiskCompilationCache;
+
+namespace {
+
+constexpr auto long_ago = std::chrono::system_clock::time_point::min();
+
+struct CacheTest {
+    TemporaryDirectory tmp_dir{"/tmp/sim-judge-disk-compilation-cache-test.XXXXXX"};
+    std::string cache_dir = concat_tostr(tmp_dir.path(), "cache/");
+    std::string src = concat_tostr(tmp_dir.path(), "src");
+    std::string dest = concat_tostr(tmp_dir.path(), "dest");
+
+    void save(DiskCompilationCache& cache, std::string_view name, StringView contents) {
+        put_file_contents(src, contents);
+        cache.save_or_override(name, src);
+    }
+
+    bool copy(DiskCompilationCache& cache, std::string_view name) {
+        return cache.copy_from_cache_if_newer_than(name, dest, long_ago);
+    }
+};
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, copies_saved_files) {
+    CacheTest t;
+    DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 1 << 20, 100};
+    EXPECT_FALSE(t.copy(cache, "a"));
+    t.save(cache, "a", "aaaa");
+    EXPECT_TRUE(t.copy(cache, "a"));
+    EXPECT_EQ(get_file_contents(t.dest), "aaaa");
+    EXPECT_FALSE(cache.copy_from_cache_if_newer_than(
+        "a", t.dest, std::chrono::system_clock::now() + std::chrono::hours{1}
+    ));
+    EXPECT_EQ(cache.hits_num(), 1);
+    EXPECT_EQ(cache.misses_num(), 2);
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, evicts_least_recently_used_files) {
+    CacheTest t;
+    DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 10, 100};
+    t.save(cache, "a", "aaaa");
+    t.save(cache, "b", "bbbb");
+    EXPECT_TRUE(t.copy(cache, "a")); // a becomes more recently used than b
+    t.save(cache, "c", "cccc");
+    EXPECT_TRUE(t.copy(cache, "a"));
+    EXPECT_FALSE(t.copy(cache, "b"));
+    EXPECT_TRUE(t.copy(cache, "c"));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, respects_entries_num_budget) {
+    CacheTest t;
+    DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 1 << 20, 2};
+    t.save(cache, "a", "a");
+    t.save(cache, "b", "b");
+    t.save(cache, "c", "c");
+    EXPECT_FALSE(t.copy(cache, "a"));
+    EXPECT_TRUE(t.copy(cache, "b"));
+    EXPECT_TRUE(t.copy(cache, "c"));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, is_shared_between_instances) {
+    CacheTest t;
+    DiskCompilationCache cache1{t.cache_dir, std::chrono::hours{1}, 10, 100};
+    DiskCompilationCache cache2{t.cache_dir, std::chrono::hours{1}, 10, 100};
+    t.save(cache1, "a", "aaaa");
+    t.save(cache2, "b", "bbbb");
+    EXPECT_TRUE(t.copy(cache2, "a")); // a becomes more recently used than b
+    t.save(cache1, "c", "cccc");
+    EXPECT_TRUE(t.copy(cache1, "a"));
+    EXPECT_FALSE(t.copy(cache2, "b"));
+    EXPECT_TRUE(t.copy(cache2, "c"));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, restores_state_from_journal) {
+    CacheTest t;
+    {
+        DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 10, 100};
+        t.save(cache, "a", "aaaa");
+        t.save(cache, "b", "bbbb");
+        EXPECT_TRUE(t.copy(cache, "a")); // a becomes more recently used than b
+    }
+    // Simulate a crash in the middle of appending a record
+    auto fd = FileDescriptor{concat_tostr(t.cache_dir, ".journal"), O_WRONLY | O_APPEND};
+    ASSERT_TRUE(fd.is_open());
+    write_all_throw(fd, StringView{"U "});
+
+    DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 10, 100};
+    t.save(cache, "c", "cccc");
+    EXPECT_TRUE(t.copy(cache, "a"));
+    EXPECT_FALSE(t.copy(cache, "b"));
+    EXPECT_TRUE(t.copy(cache, "c"));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, takes_files_cached_without_journal_into_account) {
+    CacheTest t;
+    {
+        DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 1 << 20, 100};
+    }
+    put_file_contents(concat_tostr(t.cache_dir, "a"), "aaaa");
+    unlink(concat_tostr(t.cache_dir, ".journal").c_str());
+
+    DiskCompilationCache cache{t.cache_dir, std::chrono::hours{1}, 1 << 20, 100};
+    EXPECT_TRUE(t.copy(cache, "a"));
+    EXPECT_EQ(get_file_contents(t.dest), "aaaa");
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_DiskCompilationCache, survives_journal_compaction) {
+    CacheTest t;
+    DiskCompilationCache cache1{t.cache_dir, std::chrono::hours{1}, 10, 100};
+    DiskCompilationCache cache2{t.cache_dir, std::chrono::hours{1}, 10, 100};
+    t.save(cache1, "a", "aaaa");
+    t.save(cache1, "b", "bbbb");
+    for (int i = 0; i < 10'000; ++i) {
+        ASSERT_TRUE(t.copy(cache1, "a"));
+    }
+    t.save(cache2, "c", "cccc");
+    EXPECT_TRUE(t.copy(cache2, "a"));
+    EXPECT_FALSE(t.copy(cache2, "b"));
+    EXPECT_LT(get_file_contents(concat_tostr(t.cache_dir, ".journal")).size(), 10'000 * 4);
+}
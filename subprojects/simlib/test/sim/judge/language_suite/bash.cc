@@ -1,9 +1,12 @@
 #include "run_in_fully_interpreted_language_suite.hh"
 
 #include <gtest/gtest.h>
+#include <simlib/file_contents.hh>
 #include <simlib/file_info.hh>
 #include <simlib/sandbox/si.hh>
 #include <simlib/sim/judge/language_suite/bash.hh>
+#include <simlib/temporary_file.hh>
+#include <stdexcept>
 
 constexpr auto test_prog = "exit $1";
 
@@ -15,3 +18,49 @@ TEST(sim_judge_language_suite, bash) {
     auto res = run_in_fully_intepreted_language_suite(suite, test_prog, {{"42"}});
     ASSERT_EQ(res.si, (sandbox::Si{.code = CLD_EXITED, .status = 42}));
 }
+
+// NOLINTNEXTLINE
+TEST(sim_judge_language_suite, bash_concurrent_runs) {
+    auto suite = sim::judge::language_suite::Bash{};
+    ASSERT_TRUE(suite.is_supported());
+    auto tmp_file = TemporaryFile{"/tmp/sim_judge_language_suite_bash_test.XXXXXX"};
+    put_file_contents(tmp_file.path(), test_prog);
+    suite.compile(
+        tmp_file.path(),
+        {
+            .time_limit = std::chrono::seconds{0},
+            .cpu_time_limit = std::chrono::seconds{0},
+            .memory_limit_in_bytes = 0,
+            .max_file_size_in_bytes = 0,
+        }
+    );
+
+    suite.set_max_concurrent_runs(2);
+    auto async_run = [&](std::string_view exit_code) {
+        return suite.async_run(
+            {{exit_code}},
+            {
+                .stdin_fd = std::nullopt,
+                .stdout_fd = std::nullopt,
+                .stderr_fd = std::nullopt,
+                .time_limit = std::chrono::seconds{60}, // Under load it may take time.
+                .cpu_time_limit = std::chrono::seconds{1},
+                .memory_limit_in_bytes = 32 << 20,
+                .max_stack_size_in_bytes = 32 << 20,
+                .max_file_size_in_bytes = 0,
+            },
+            {}
+        );
+    };
+    for (int iter = 0; iter < 2; ++iter) {
+        auto rh1 = async_run("7");
+        auto rh2 = async_run("13");
+        ASSERT_THROW((void)async_run("42"), std::runtime_error);
+        ASSERT_EQ(
+            suite.await_result(std::move(rh2)).si, (sandbox::Si{.code = CLD_EXITED, .status = 13})
+        );
+        ASSERT_EQ(
+            suite.await_result(std::move(rh1)).si, (sandbox::Si{.code = CLD_EXITED, .status = 7})
+        );
+    }
+}
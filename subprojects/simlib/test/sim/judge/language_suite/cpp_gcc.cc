@@ -1,8 +1,15 @@
 #include "test_compiled_language_suite.hh"
 
+#include <chrono>
 #include <gtest/gtest.h>
+#include <simlib/concat_tostr.hh>
+#include <simlib/directory.hh>
+#include <simlib/file_contents.hh>
 #include <simlib/file_info.hh>
+#include <simlib/sim/judge/disk_compilation_cache.hh>
 #include <simlib/sim/judge/language_suite/cpp_gcc.hh>
+#include <simlib/temporary_directory.hh>
+#include <simlib/temporary_file.hh>
 
 using sim::judge::language_suite::Cpp_GCC;
 
@@ -14,6 +21,14 @@ int main() {
 }
 )";
 
+constexpr auto test_prog_ok_using_precompiled_header = R"(
+#include <bits/stdc++.h>
+
+int main() {
+    std::cout << 42 << std::endl;
+}
+)";
+
 constexpr auto test_prog_invalid = R"(
 int main() {
     p;
@@ -41,3 +56,75 @@ TEST(sim_judge_compiler, cpp_gcc_cpp23) {
         );
     }
 }
+
+// NOLINTNEXTLINE
+TEST(sim_judge_compiler, cpp_gcc_content_addressed_cache) {
+    auto suite = Cpp_GCC{Cpp_GCC::Standard::Cpp20};
+    if (!suite.is_supported()) {
+        GTEST_SKIP();
+    }
+    auto cache_dir = TemporaryDirectory{"/tmp/sim_judge_compilation_cache_test.XXXXXX"};
+    auto cache =
+        sim::judge::DiskCompilationCache{cache_dir.path(), std::chrono::hours{1}, 1 << 30, 1000};
+    auto compile = [&](StringView source) {
+        // Every source gets a new file, so only the contents can identify it
+        auto source_file = TemporaryFile{"/tmp/sim_judge_compiled_language_suite_test.XXXXXX"};
+        put_file_contents(source_file.path(), source);
+        auto cres = suite.compile(
+            source_file.path(),
+            {
+                .time_limit = std::chrono::seconds{60}, // Under load it may take time.
+                .cpu_time_limit = std::chrono::seconds{20},
+                .memory_limit_in_bytes = 1 << 30,
+                .max_file_size_in_bytes = 20 << 20,
+                .cache =
+                    sim::judge::language_suite::Suite::CompileOptions::Cache{
+                        .compilation_cache = cache,
+                        .cached_name = "solution:",
+                        .content_addressed = true,
+                    },
+            }
+        );
+        ASSERT_TRUE(cres.is_ok());
+    };
+
+    compile(test_prog_ok);
+    ASSERT_EQ(cache.hits_num(), 0);
+    compile(test_prog_ok);
+    ASSERT_EQ(cache.hits_num(), 1);
+    auto different_source = concat_tostr(test_prog_ok, "// different source\n");
+    compile(different_source);
+    ASSERT_EQ(cache.hits_num(), 1);
+    ASSERT_EQ(cache.misses_num(), 2);
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_compiler, cpp_gcc_precompiled_headers) {
+    auto pch_dir = TemporaryDirectory{"/tmp/sim_judge_precompiled_headers_test.XXXXXX"};
+    auto suite = Cpp_GCC{
+        Cpp_GCC::Standard::Cpp20,
+        Cpp_GCC::PrecompiledHeaders{
+            .dir = pch_dir.path(),
+            .headers = {"bits/stdc++.h", "nonexistent_header.h"},
+        },
+    };
+    if (!suite.is_supported()) {
+        GTEST_SKIP();
+    }
+    test_compiled_language_suite(
+        suite,
+        test_prog_ok_using_precompiled_header,
+        test_prog_invalid,
+        "error: 'p' was not declared in this scope"
+    );
+
+    // Headers are precompiled once and the ones that fail to precompile are omitted
+    size_t generated_dirs_num = 0;
+    for_each_dir_component(pch_dir.path(), [&](dirent* file) {
+        ++generated_dirs_num;
+        auto path = concat_tostr(pch_dir.path(), file->d_name, '/');
+        EXPECT_TRUE(path_exists(concat_tostr(path, "bits/stdc++.h.gch")));
+        EXPECT_FALSE(path_exists(concat_tostr(path, "nonexistent_header.h.gch")));
+    });
+    EXPECT_EQ(generated_dirs_num, 1);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <simlib/concat_tostr.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_info.hh>
+#include <simlib/path.hh>
+#include <simlib/sim/judge/package_files_cache.hh>
+#include <simlib/temporary_directory.hh>
+#include <string>
+
+using sim::judge::PackageFilesCache;
+
+namespace {
+
+auto extract_str(std::string str, size_t* extractions_num = nullptr) {
+    return [str = std::move(str), extractions_num](FilePath dest) {
+        put_file_contents(dest, str);
+        if (extractions_num) {
+            ++*extractions_num;
+        }
+    };
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(sim_judge_PackageFilesCache, extracts_only_once) {
+    TemporaryDirectory tmp_dir("/tmp/sim-judge-package-files-cache-test.XXXXXX");
+    PackageFilesCache cache{tmp_dir.path(), 1 << 20};
+    size_t extractions_num = 0;
+    auto lease = cache.lease("pkg");
+    auto path = lease.get_file("tests/1a.in", extract_str("abc", &extractions_num));
+    EXPECT_EQ(get_file_contents(path), "abc");
+    EXPECT_EQ(lease.get_file("tests/1a.in", extract_str("xyz", &extractions_num)), path);
+    EXPECT_EQ(get_file_contents(path), "abc");
+    EXPECT_EQ(extractions_num, 1);
+
+    auto other_path = lease.get_file("tests/1a.out", extract_str("xyz", &extractions_num));
+    EXPECT_NE(other_path, path);
+    EXPECT_EQ(get_file_contents(other_path), "xyz");
+    EXPECT_EQ(extractions_num, 2);
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_PackageFilesCache, evicts_least_recently_used_packages) {
+    TemporaryDirectory tmp_dir("/tmp/sim-judge-package-files-cache-test.XXXXXX");
+    PackageFilesCache cache{tmp_dir.path(), 10};
+    auto path_a = cache.lease("a").get_file("x", extract_str("aaaa"));
+    auto path_b = cache.lease("b").get_file("x", extract_str("bbbb"));
+    EXPECT_TRUE(path_exists(path_a));
+    EXPECT_TRUE(path_exists(path_b));
+
+    (void)cache.lease("a"); // a becomes more recently used than b
+    auto path_c = cache.lease("c").get_file("x", extract_str("cccc"));
+    EXPECT_TRUE(path_exists(path_a));
+    EXPECT_FALSE(path_exists(path_b));
+    EXPECT_TRUE(path_exists(path_c));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_PackageFilesCache, does_not_evict_leased_packages) {
+    TemporaryDirectory tmp_dir("/tmp/sim-judge-package-files-cache-test.XXXXXX");
+    PackageFilesCache cache{tmp_dir.path(), 4};
+    auto lease_a = cache.lease("a");
+    auto path_a = lease_a.get_file("x", extract_str("aaaa"));
+    {
+        auto lease_b = cache.lease("b");
+        auto path_b = lease_b.get_file("x", extract_str("bbbb"));
+        EXPECT_TRUE(path_exists(path_a));
+        EXPECT_TRUE(path_exists(path_b));
+    }
+    EXPECT_TRUE(path_exists(path_a));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_PackageFilesCache, takes_existing_files_into_account) {
+    TemporaryDirectory tmp_dir("/tmp/sim-judge-package-files-cache-test.XXXXXX");
+    std::string path_a;
+    {
+        PackageFilesCache cache{tmp_dir.path(), 8};
+        path_a = cache.lease("a").get_file("x", extract_str("aaaa"));
+    }
+    PackageFilesCache cache{tmp_dir.path(), 8};
+    EXPECT_EQ(cache.lease("a").get_file("x", extract_str("zzzz")), path_a);
+    EXPECT_EQ(get_file_contents(path_a), "aaaa");
+    auto path_b = cache.lease("b").get_file("x", extract_str("bbbbb"));
+    EXPECT_FALSE(path_exists(path_a));
+    EXPECT_TRUE(path_exists(path_b));
+}
+
+// NOLINTNEXTLINE
+TEST(sim_judge_PackageFilesCache, removes_leftovers_of_interrupted_extractions) {
+    TemporaryDirectory tmp_dir("/tmp/sim-judge-package-files-cache-test.XXXXXX");
+    std::string path_a;
+    {
+        PackageFilesCache cache{tmp_dir.path(), 8};
+        path_a = cache.lease("a").get_file("x", extract_str("aaaa"));
+    }
+    // Simulate a crash in the middle of an extraction
+    auto leftover_path = concat_tostr(path_dirpath(path_a), ".extracted.AbCdEf");
+    put_file_contents(leftover_path, "yyyyyyyy");
+
+    PackageFilesCache cache{tmp_dir.path(), 8};
+    EXPECT_FALSE(path_exists(leftover_path));
+    EXPECT_TRUE(path_exists(path_a)); // the leftover is not counted into the cache size
+}
@@ -6,6 +6,7 @@
 #include <optional>
 #include <simlib/file_contents.hh>
 #include <simlib/file_path.hh>
+#include <simlib/file_perms.hh>
 #include <simlib/overloaded.hh>
 #include <simlib/sim/judge/language_suite/bash.hh>
 #include <simlib/sim/judge/language_suite/c_clang.hh>
@@ -13,8 +14,11 @@
 #include <simlib/sim/judge/language_suite/python.hh>
 #include <simlib/sim/judge/test_on_test.hh>
 #include <simlib/string_view.hh>
+#include <simlib/temporary_directory.hh>
 #include <simlib/temporary_file.hh>
 #include <simlib/utilities.hh>
+#include <sys/stat.h>
+#include <thread>
 #include <variant>
 
 using sim::judge::TestReport;
@@ -41,10 +45,13 @@ struct TestOnTestOptions {
     std::chrono::nanoseconds program_cpu_time_limit = std::chrono::milliseconds{100};
     uint64_t output_size_limit = 0;
     std::chrono::nanoseconds checker_cpu_time_limit = std::chrono::milliseconds{100};
+    bool abort_on_wrong_answer = false;
 };
 
-static TestReport
-test_test_on_test(Source prog, Source checker, const TestOnTestOptions& options = {}) {
+// std::nullopt @p checker means the default checker
+static TestReport test_test_on_test(
+    Source prog, std::optional<Source> checker, const TestOnTestOptions& options = {}
+) {
     using sim::judge::language_suite::C_Clang;
     using sim::judge::language_suite::C_GCC;
     static constexpr auto make_c_suite = []() -> std::variant<C_GCC, C_Clang> {
@@ -78,8 +85,11 @@ test_test_on_test(Source prog, Source checker, const TestOnTestOptions& options
             compile(suite, source);
             return suite;
         }(),
-        .compiled_checker = [&]() -> Suite& {
-            StringView source = std::visit([](auto x) { return x.source; }, checker);
+        .compiled_checker = [&]() -> Suite* {
+            if (!checker) {
+                return nullptr;
+            }
+            StringView source = std::visit([](auto x) { return x.source; }, *checker);
             auto& suite = std::visit(
                 overloaded{
                     [&](const Python& /**/) -> Suite& { return checker_python; },
@@ -88,10 +98,10 @@ test_test_on_test(Source prog, Source checker, const TestOnTestOptions& options
                         return std::visit([&](Suite& impl) -> Suite& { return impl; }, checker_c);
                     },
                 },
-                checker
+                *checker
             );
             compile(suite, source);
-            return suite;
+            return &suite;
         }(),
         .test_input = options.test_input.value_or(empty_file.path()),
         .expected_output = options.expected_output.value_or(empty_file.path()),
@@ -109,6 +119,7 @@ test_test_on_test(Source prog, Source checker, const TestOnTestOptions& options
                 .memory_limit_in_bytes = 16 << 20,
                 .max_comment_len = 512,
             },
+        .abort_on_wrong_answer = options.abort_on_wrong_answer,
     });
 }
 
@@ -327,19 +338,20 @@ TEST(test_on_test, io_simple) {
     EXPECT_EQ(report.score, 1);
 }
 
-constexpr auto prog_io_is_not_seekable = Python{R"(
+// A regular test input file is passed directly as stdin, so only stdout is not seekable
+constexpr auto prog_stdin_is_seekable_stdout_is_not = Python{R"(
 import sys
-assert not(sys.stdin.seekable())
+assert sys.stdin.seekable()
 assert not(sys.stdout.seekable())
 # stderr is /dev/null so we don't care about it being seekable
 )"};
 
 // NOLINTNEXTLINE
-TEST(test_on_test, io_is_not_seekable) {
+TEST(test_on_test, stdin_is_seekable_stdout_is_not) {
     auto test_inout = TemporaryFile{"/tmp/sim_judge_test_on_test_inout.XXXXXX"};
 
     auto report = test_test_on_test(
-        prog_io_is_not_seekable,
+        prog_stdin_is_seekable_stdout_is_not,
         checker_ok_no_comment,
         {
             .test_input = test_inout.path(),
@@ -351,6 +363,32 @@ TEST(test_on_test, io_is_not_seekable) {
     EXPECT_EQ(report.score, 1);
 }
 
+// NOLINTNEXTLINE
+TEST(test_on_test, io_input_from_fifo) {
+    auto tmp_dir = TemporaryDirectory{"/tmp/sim_judge_test_on_test_fifo.XXXXXX"};
+    auto test_input_path = concat_tostr(tmp_dir.path(), "in");
+    ASSERT_EQ(mkfifo(test_input_path.c_str(), S_0600), 0);
+    // Opening a FIFO for reading blocks until there is a writer
+    auto writer = std::thread{[&] { put_file_contents(test_input_path, "42"); }};
+
+    auto test_output = TemporaryFile{"/tmp/sim_judge_test_on_test_output.XXXXXX"};
+    put_file_contents(test_output.path(), "84\n");
+
+    auto report = test_test_on_test(
+        prog_io_simple,
+        std::nullopt,
+        {
+            .test_input = test_input_path,
+            .expected_output = test_output.path(),
+            .output_size_limit = 3,
+        }
+    );
+    writer.join();
+    EXPECT_EQ(report.status, Status::OK);
+    EXPECT_EQ(report.comment, "");
+    EXPECT_EQ(report.score, 1);
+}
+
 // Python is faster than bash here
 constexpr auto prog_io_closes_partially_read_stdin_before_writing_to_stdout = Python{R"(
 import sys, os
@@ -461,3 +499,139 @@ TEST(test_on_test, problematic_writev) {
         EXPECT_EQ(report.score, 1);
     }
 }
+
+// NOLINTNEXTLINE
+TEST(test_on_test, default_checker_ok) {
+    auto test_input = TemporaryFile{"/tmp/sim_judge_test_on_test_input.XXXXXX"};
+    put_file_contents(test_input.path(), "42");
+
+    auto test_output = TemporaryFile{"/tmp/sim_judge_test_on_test_output.XXXXXX"};
+    put_file_contents(test_output.path(), "84  \n\n");
+
+    auto report = test_test_on_test(
+        prog_io_simple,
+        std::nullopt,
+        {
+            .test_input = test_input.path(),
+            .expected_output = test_output.path(),
+            .output_size_limit = 3,
+        }
+    );
+    EXPECT_EQ(report.status, Status::OK);
+    EXPECT_EQ(report.comment, "");
+    EXPECT_EQ(report.score, 1);
+    EXPECT_FALSE(report.checker.has_value());
+}
+
+// NOLINTNEXTLINE
+TEST(test_on_test, default_checker_wrong) {
+    auto test_input = TemporaryFile{"/tmp/sim_judge_test_on_test_input.XXXXXX"};
+    put_file_contents(test_input.path(), "42");
+
+    auto test_output = TemporaryFile{"/tmp/sim_judge_test_on_test_output.XXXXXX"};
+    put_file_contents(test_output.path(), "85\n");
+
+    auto report = test_test_on_test(
+        prog_io_simple,
+        std::nullopt,
+        {
+            .test_input = test_input.path(),
+            .expected_output = test_output.path(),
+            .output_size_limit = 3,
+        }
+    );
+    EXPECT_EQ(report.status, Status::WrongAnswer);
+    EXPECT_EQ(report.comment, "Line 1 column 1: read '84', expected '85'");
+    EXPECT_EQ(report.score, 0);
+}
+
+constexpr auto prog_wrong_answer_and_tle = Bash{"echo 85; while :; do :; done"};
+
+// NOLINTNEXTLINE
+TEST(test_on_test, abort_on_wrong_answer) {
+    auto test_input = TemporaryFile{"/tmp/sim_judge_test_on_test_input.XXXXXX"};
+    put_file_contents(test_input.path(), "42");
+
+    auto test_output = TemporaryFile{"/tmp/sim_judge_test_on_test_output.XXXXXX"};
+    put_file_contents(test_output.path(), "84\n");
+
+    auto report = test_test_on_test(
+        prog_wrong_answer_and_tle,
+        std::nullopt,
+        {
+            .test_input = test_input.path(),
+            .expected_output = test_output.path(),
+            .program_cpu_time_limit = std::chrono::seconds{5},
+            .output_size_limit = 3,
+            .abort_on_wrong_answer = true,
+        }
+    );
+    EXPECT_EQ(report.status, Status::WrongAnswer);
+    EXPECT_EQ(report.comment, "Line 1 column 1: read '85', expected '84'");
+    EXPECT_EQ(report.score, 0);
+    EXPECT_LT(report.program.cpu_time, std::chrono::seconds{5});
+
+    report = test_test_on_test(
+        prog_io_simple,
+        std::nullopt,
+        {
+            .test_input = test_input.path(),
+            .expected_output = test_output.path(),
+            .output_size_limit = 3,
+            .abort_on_wrong_answer = true,
+        }
+    );
+    EXPECT_EQ(report.status, Status::OK);
+    EXPECT_EQ(report.comment, "");
+    EXPECT_EQ(report.score, 1);
+}
+
+constexpr auto prog_wrong_answer_and_rte = Bash{"echo 85; exit 1"};
+
+// NOLINTNEXTLINE
+TEST(test_on_test, abort_on_wrong_answer_does_not_hide_rte) {
+    auto test_input = TemporaryFile{"/tmp/sim_judge_test_on_test_input.XXXXXX"};
+    auto test_output = TemporaryFile{"/tmp/sim_judge_test_on_test_output.XXXXXX"};
+    put_file_contents(test_output.path(), "84\n");
+
+    for (bool abort_on_wrong_answer : {false, true}) {
+        auto report = test_test_on_test(
+            prog_wrong_answer_and_rte,
+            std::nullopt,
+            {
+                .test_input = test_input.path(),
+                .expected_output = test_output.path(),
+                .output_size_limit = 3,
+                .abort_on_wrong_answer = abort_on_wrong_answer,
+            }
+        );
+        EXPECT_EQ(report.status, Status::RuntimeError) << abort_on_wrong_answer;
+        EXPECT_EQ(report.comment, "Runtime error: exited with 1") << abort_on_wrong_answer;
+        EXPECT_EQ(report.score, 0);
+    }
+}
+
+constexpr auto prog_wrong_answer_and_output_size_limit_exceeded = Bash{"echo 8500"};
+
+// NOLINTNEXTLINE
+TEST(test_on_test, abort_on_wrong_answer_does_not_hide_output_size_limit_exceeded) {
+    auto test_input = TemporaryFile{"/tmp/sim_judge_test_on_test_input.XXXXXX"};
+    auto test_output = TemporaryFile{"/tmp/sim_judge_test_on_test_output.XXXXXX"};
+    put_file_contents(test_output.path(), "84\n");
+
+    for (bool abort_on_wrong_answer : {false, true}) {
+        auto report = test_test_on_test(
+            prog_wrong_answer_and_output_size_limit_exceeded,
+            std::nullopt,
+            {
+                .test_input = test_input.path(),
+                .expected_output = test_output.path(),
+                .output_size_limit = 3,
+                .abort_on_wrong_answer = abort_on_wrong_answer,
+            }
+        );
+        EXPECT_EQ(report.status, Status::OutputSizeLimitExceeded) << abort_on_wrong_answer;
+        EXPECT_EQ(report.comment, "") << abort_on_wrong_answer;
+        EXPECT_EQ(report.score, 0);
+    }
+}
@@ -0,0 +1,197 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <simlib/concat_tostr.hh>
+#include <simlib/errmsg.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/macros/throw.hh>
+#include <simlib/sandbox/supervisor_pool.hh>
+#include <simlib/sim/judge_worker.hh>
+#include <simlib/string_view.hh>
+#include <simlib/temporary_directory.hh>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using sim::JudgeReport;
+using sim::JudgeWorker;
+using std::string;
+
+namespace {
+
+// Solution sleeps for the number of seconds read from stdin and prints "ok"
+constexpr StringView solution_sleeping = R"(
+import time
+time.sleep(float(input()))
+print('ok')
+)";
+
+struct PackageTest {
+    string name;
+    StringView input;
+    StringView expected_output = "ok\n";
+};
+
+// Tests of group 0 are initial tests, other ones are final tests
+struct Package {
+    TemporaryDirectory dir{"/tmp/sim-judge-worker-test.XXXXXX"};
+
+    explicit Package(const std::vector<PackageTest>& tests) {
+        string limits;
+        string tests_files;
+        for (const auto& test : tests) {
+            back_insert(limits, '\t', test.name, " 5\n");
+            back_insert(
+                tests_files,
+                '\t',
+                test.name,
+                " tests/",
+                test.name,
+                ".in tests/",
+                test.name,
+                ".out\n"
+            );
+        }
+        auto simfile = concat_tostr(
+            "name: Test\nmemory_limit: 64\nlimits: [\n",
+            limits,
+            "]\ntests_files: [\n",
+            tests_files,
+            "]\n"
+        );
+        put_file_contents(concat_tostr(dir.path(), "Simfile"), simfile);
+        put_file_contents(concat_tostr(dir.path(), "sol.py"), solution_sleeping);
+        if (mkdir(concat_tostr(dir.path(), "tests"))) {
+            THROW("mkdir()", errmsg());
+        }
+        for (const auto& test : tests) {
+            put_file_contents(concat_tostr(dir.path(), "tests/", test.name, ".in"), test.input);
+            put_file_contents(
+                concat_tostr(dir.path(), "tests/", test.name, ".out"), test.expected_output
+            );
+        }
+    }
+};
+
+JudgeWorker
+prepare_judge_worker(const Package& package, sandbox::SupervisorPool* supervisor_pool = nullptr) {
+    auto jworker = JudgeWorker{{
+        .checker_memory_limit_in_bytes = 64 << 20,
+        .supervisor_pool = supervisor_pool,
+        .judge_initial_and_final_concurrently = true,
+    }};
+    jworker.load_package(package.dir.path(), std::nullopt);
+    string compilation_errors;
+    EXPECT_EQ(
+        jworker.compile_checker(std::chrono::seconds{10}, 1 << 30, &compilation_errors, 4096), 0
+    ) << compilation_errors;
+    EXPECT_EQ(
+        jworker.compile_solution(
+            concat_tostr(package.dir.path(), "sol.py"),
+            sim::SolutionLanguage::PYTHON,
+            std::chrono::seconds{10},
+            1 << 30,
+            &compilation_errors,
+            4096
+        ),
+        0
+    ) << compilation_errors;
+    return jworker;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(sim_JudgeWorker, judge_initial_and_final_reports_initial_reports_first) {
+    // The final tests are judged faster than the initial ones, the WA on test 1a makes test 1b
+    // skipped in the first round, so there is a partial final report
+    auto package = Package{{
+        {.name = "0a", .input = "1"},
+        {.name = "1a", .input = "0", .expected_output = "wrong\n"},
+        {.name = "1b", .input = "0"},
+    }};
+    auto jworker = prepare_judge_worker(package);
+
+    sim::VerboseJudgeLogger initial_judge_log;
+    sim::VerboseJudgeLogger final_judge_log;
+    std::vector<std::pair<bool, bool>> callbacks; // (final, partial)
+    auto [initial_report, final_report] = jworker.judge_initial_and_final(
+        initial_judge_log,
+        final_judge_log,
+        [&](const JudgeReport& /**/, bool final, bool partial) {
+            callbacks.emplace_back(final, partial);
+        }
+    );
+    EXPECT_EQ(
+        callbacks,
+        (std::vector<std::pair<bool, bool>>{{false, false}, {true, true}, {true, false}})
+    );
+
+    ASSERT_EQ(initial_report.groups.size(), 1);
+    ASSERT_EQ(initial_report.groups[0].tests.size(), 1);
+    EXPECT_EQ(initial_report.groups[0].tests[0].status, JudgeReport::Test::OK);
+
+    ASSERT_EQ(final_report.groups.size(), 1);
+    ASSERT_EQ(final_report.groups[0].tests.size(), 2);
+    EXPECT_EQ(final_report.groups[0].tests[0].status, JudgeReport::Test::WA);
+    EXPECT_EQ(final_report.groups[0].tests[1].status, JudgeReport::Test::OK);
+    EXPECT_EQ(final_report.groups[0].score, 0);
+}
+
+// NOLINTNEXTLINE
+TEST(sim_JudgeWorker, judge_initial_and_final_does_not_judge_final_tests_after_failure) {
+    std::vector<PackageTest> tests = {{.name = "0a", .input = "0.5"}};
+    for (int i = 1; i <= 10; ++i) {
+        tests.push_back({.name = concat_tostr(i, 'a'), .input = "1"});
+    }
+    auto package = Package{tests};
+    auto jworker = prepare_judge_worker(package);
+
+    sim::VerboseJudgeLogger initial_judge_log;
+    sim::VerboseJudgeLogger final_judge_log;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(
+        (void)jworker.judge_initial_and_final(
+            initial_judge_log,
+            final_judge_log,
+            [&](const JudgeReport& /**/, bool final, bool /**/) {
+                if (!final) {
+                    throw std::runtime_error{"report callback failure"};
+                }
+            }
+        ),
+        std::runtime_error
+    );
+    // Only the final test in progress is waited for, not all the 10 seconds of them
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{5});
+}
+
+// NOLINTNEXTLINE
+TEST(sim_JudgeWorker, release_supervisors_returns_them_to_the_pool) {
+    auto package = Package{{
+        {.name = "0a", .input = "0"},
+        {.name = "1a", .input = "0"},
+    }};
+    sandbox::SupervisorPool pool{{.max_idle_supervisors = 16, .max_requests_per_supervisor = 0}};
+    auto jworker = prepare_judge_worker(package, &pool);
+    EXPECT_EQ(jworker.judge(false).groups.at(0).tests.at(0).status, JudgeReport::Test::OK);
+    auto spawned_supervisors_num = pool.spawned_supervisors_num();
+
+    jworker.release_supervisors();
+    // Another JudgeWorker reuses the released supervisors
+    auto other_jworker = prepare_judge_worker(package, &pool);
+    EXPECT_EQ(other_jworker.judge(true).groups.at(0).tests.at(0).status, JudgeReport::Test::OK);
+    EXPECT_EQ(pool.spawned_supervisors_num(), spawned_supervisors_num);
+    other_jworker.release_supervisors();
+
+    // The released JudgeWorker obtains the supervisors again
+    sim::VerboseJudgeLogger initial_judge_log;
+    sim::VerboseJudgeLogger final_judge_log;
+    auto [initial_report, final_report] = jworker.judge_initial_and_final(
+        initial_judge_log, final_judge_log, [](const JudgeReport& /**/, bool /**/, bool /**/) {}
+    );
+    EXPECT_EQ(initial_report.groups.at(0).tests.at(0).status, JudgeReport::Test::OK);
+    EXPECT_EQ(final_report.groups.at(0).tests.at(0).status, JudgeReport::Test::OK);
+    EXPECT_EQ(pool.spawned_supervisors_num(), spawned_supervisors_num);
+}
@@ -15,7 +15,12 @@ namespace compilation_cache {
 
 sim::judge::DiskCompilationCache get_cache() {
     (void)mkdir("utils/", S_0755);
-    return sim::judge::DiskCompilationCache{"utils/cache/", std::chrono::hours{7 * 24}};
+    return sim::judge::DiskCompilationCache{
+        "utils/cache/",
+        std::chrono::hours{7 * 24},
+        COMPILATION_CACHE_MAX_SIZE,
+        COMPILATION_CACHE_MAX_ENTRIES_NUM,
+    };
 }
 
 void clear() {
@@ -26,4 +26,7 @@ constexpr auto GENERATOR_TIME_LIMIT = std::chrono::seconds{100};
 constexpr uint64_t GENERATOR_MEMORY_LIMIT = 4ULL << 30;
 constexpr uint64_t GENERATED_INPUT_FILE_SIZE_LIMIT = 1 << 30;
 
+constexpr uint64_t COMPILATION_CACHE_MAX_SIZE = 1 << 30;
+constexpr uint64_t COMPILATION_CACHE_MAX_ENTRIES_NUM = 1000;
+
 constexpr auto LATEX_COMPILATION_TIME_LIMIT = std::chrono::seconds{100};